@@ -0,0 +1,247 @@
+#include <algorithm>        // max(), min()
+#include <chrono>           // nanoseconds
+#include <cstddef>          // size_t
+#include <iostream>         // standard i/o streams cout, clog
+#include <map>              // Binary search tree associative container with no duplicates
+#include <memory>           // unique_ptr, make_unique()
+#include <string>           // Unbounded strings, to_string()
+#include <vector>           // Unbounded vector
+
+#include "../Book.hpp"
+#include "../BookList.hpp"
+#include "Timer.hpp"
+
+
+
+
+
+
+
+/*********************************************************************************************************************************
+**  Private type declarations, function declarations, and object definitions
+*********************************************************************************************************************************/
+namespace    // unnamed, anonymous namespace
+{
+  /*********************************************************************************************************************************
+  **  Type Definitions
+  *********************************************************************************************************************************/
+  // Create a matrix indexed by list size, data structure, and operation that holds the time measured to perform the operation.  This
+  // is the same shape as the Final Project's TimeMatrix so the two tab-separated tables can be graphed side by side.
+  using OperationName     = std::string;
+  using DataStructureName = std::string;
+  using SnapshotInterval  = std::size_t;
+  using ElapsedTime       = std::size_t;
+
+  // A 3 dimensional collection of elapsed time measurements indexed by list size, data structure, and operation
+  using TimeMatrix = std::map<SnapshotInterval, std::map<DataStructureName, std::map<OperationName, ElapsedTime>>>;
+
+  // Book list operations complete in well under a microsecond at the smaller sizes, so measure in nanoseconds
+  char nanoseconds[] = "nanoseconds";
+  using TimerNS      = Utilities::TimerType<std::chrono::nanoseconds, nanoseconds>;
+
+
+
+  /*********************************************************************************************************************************
+  **  Function Declarations
+  *********************************************************************************************************************************/
+  std::ostream & operator<<( std::ostream & stream, const TimeMatrix & matrix );
+
+  template<class Operation, class Postamble>
+  void measure( std::size_t         size,                                     // number of books in the list under test
+                const std::string & operationDescription,                     // free text name of the operation of the list being measured
+                Operation           operation,                                // operation to be measured, expressed as a Functiod
+                Postamble           postamble,                                // restores the list's size and content after the operation, not measured
+                std::size_t         repetitions );                            // number of times to perform the operation, the average is recorded
+
+  void collect_BookList_measurements( std::size_t size );
+
+
+
+  /*********************************************************************************************************************************
+  **  Object Definitions
+  *********************************************************************************************************************************/
+  constexpr std::size_t EXTRA_BOOKS = 10;                                      // books not in the list under test, used to insert and concatenate
+
+  std::vector<Book> sampleData;                                                // collection of data samples
+  TimeMatrix        runTimes;                                                  // collection of operation time measurements
+}    // unnamed, anonymous namespace
+
+
+
+
+
+
+
+
+
+
+
+int main()
+{
+  // List sizes grow in a 1-2-5 progression from 10 to 1,000,000.  Lists this large require the book list's fixed array capacity be
+  // raised (see BOOKLIST_CAPACITY) so the benchmark is compiled separately from the homework's regression tests.
+  std::vector<std::size_t> sizes;
+  for( std::size_t decade = 10; decade <= 1'000'000; decade *= 10 )  for( std::size_t step : {1, 2, 5} )
+  {
+    if( decade * step <= 1'000'000 ) sizes.push_back( decade * step );
+  }
+
+  // Synthesize a set of unique books large enough to fill the largest list plus a few more to insert
+  for( std::size_t i = 0; i < sizes.back() + EXTRA_BOOKS; ++i )
+  {
+    auto id = std::to_string( i );
+    sampleData.emplace_back( "Title " + id, "Author " + id, std::string( 10 - std::min<std::size_t>( id.size(), 10 ), '0' ) + id, i % 100 + 0.99 );
+  }
+
+  Utilities::Timer totalElapsedTime( "total elapsed time is ", std::clog );
+
+  for( auto size : sizes )
+  {
+    std::clog << "Starting to collect Book List measurements with " << size << " books\n";
+    Utilities::Timer( "Book List measurements completed in ", std::clog ), collect_BookList_measurements( size );
+  }
+
+  //  Report measurements
+  std::cout << runTimes << '\n';
+
+  std::clog << '\n' << std::string( 80, '-' ) << '\n';
+}
+
+
+
+
+
+
+
+
+
+
+
+
+
+/*********************************************************************************************************************************
+**  Private definitions
+*********************************************************************************************************************************/
+namespace    // unnamed, anonymous namespace
+{
+  /*********************************************************************************************************************************
+  **  Collect Book List Measurements
+  *********************************************************************************************************************************/
+  void collect_BookList_measurements( std::size_t size )
+  {
+    // The benchmark's fixed capacity array makes every list hundreds of megabytes, so keep them off the stack
+    auto bookList = std::make_unique<BookList>( std::vector<Book>( sampleData.cbegin(), sampleData.cbegin() + size ) );
+    auto other    = std::make_unique<BookList>( *bookList );
+
+    const Book & newBook    = sampleData[size];                                // not in the list
+    const Book & middleBook = sampleData[size / 2];
+    const Book & lastBook   = sampleData[size - 1];
+    const Book   missing( "non-existent" );
+
+    auto extraBooks = std::make_unique<BookList>( std::vector<Book>( sampleData.cbegin() + size, sampleData.cbegin() + size + EXTRA_BOOKS ) );
+
+    // Every book list operation verifies the consistency of all four containers, so even the cheapest operation is linear.  Repeat
+    // operations on small lists often enough to rise above the clock's resolution, but only a few times on the largest lists.
+    // Copying and swapping touch the fixed capacity array in its entirety regardless of how many books are in the list, so those
+    // cost the same at every size and are repeated only a few times.
+    const std::size_t repetitions             = std::max<std::size_t>( 3, 10'000 / size );
+    const std::size_t fullCapacityRepetitions = 3;
+
+
+    measure( size, "Insert at the top",    [&] { bookList->insert( newBook, BookList::Position::TOP    ); },
+                                           [&] { bookList->remove( 0 );                                    }, repetitions );
+
+    measure( size, "Insert at the bottom", [&] { bookList->insert( newBook, BookList::Position::BOTTOM ); },
+                                           [&] { bookList->remove( size );                                 }, repetitions );
+
+    measure( size, "Insert in the middle", [&] { bookList->insert( newBook, size / 2 );                   },
+                                           [&] { bookList->remove( size / 2 );                             }, repetitions );
+
+    measure( size, "Remove",               [&] { bookList->remove( middleBook );                          },
+                                           [&] { bookList->insert( middleBook, size / 2 );                 }, repetitions );
+
+    measure( size, "Search",               [&] { return bookList->find( missing );                        },
+                                           [ ] {                                                           }, repetitions );
+
+    measure( size, "Move to top",          [&] { bookList->moveToTop( lastBook );                         },
+                                           [&] { bookList->remove( 0 );
+                                                 bookList->insert( lastBook, BookList::Position::BOTTOM ); }, repetitions );
+
+    measure( size, "Concatenate",          [&] { *bookList += *extraBooks;                                },
+                                           [&] { for( auto i = size + EXTRA_BOOKS; i != size; --i )
+                                                   bookList->remove( i - 1 );                              }, repetitions );
+
+    std::unique_ptr<BookList> copy;
+    measure( size, "Copy",                 [&] { copy = std::make_unique<BookList>( *bookList );          },
+                                           [&] { copy.reset();                                             }, fullCapacityRepetitions );
+
+    measure( size, "Swap",                 [&] { bookList->swap( *other );                                },
+                                           [ ] {                                                           }, fullCapacityRepetitions );
+
+    measure( size, "Compare",              [&] { return *bookList == *other;                              },
+                                           [ ] {                                                           }, repetitions );
+  }
+
+
+
+
+
+
+
+
+  /*********************************************************************************************************************************
+  **  Other Function Definitions
+  *********************************************************************************************************************************/
+  // Template function to measure the average elapsed time consumed to perform a book list operation at a given list size
+  template<class Operation, class Postamble>
+  void measure( std::size_t         size,                                     // number of books in the list under test
+                const std::string & operationDescription,                     // free text name of the operation of the list being measured
+                Operation           operation,                                // operation to be measured, expressed as a Functiod
+                Postamble           postamble,                                // restores the list's size and content after the operation, not measured
+                std::size_t         repetitions )                             // number of times to perform the operation, the average is recorded
+  {
+    TimerNS     timer;                                                        // measures wall clock time in nanoseconds
+    std::size_t accumulatedTime = 0;
+    for( std::size_t i = 0; i < repetitions; ++i )
+    {
+      timer.reset();                                                          // start the timer
+      operation();                                                            // perform the operation and measure the elapsed wall clock time, subject to the OS's task scheduling
+      accumulatedTime += timer;                                               // stop the timer
+
+      postamble();                                                            // undo the operation's effect, but don't include this in the measured time
+    }
+
+    runTimes[size]["BookList"][operationDescription] = accumulatedTime / repetitions;
+  }
+
+
+
+  std::ostream & operator<<( std::ostream & stream, const TimeMatrix & matrix)
+  {
+    // dump the data collected in a tab-separated values (tsv) table, for example:
+    //   Size  BookList/Copy  BookList/Insert at the top  BookList/Remove
+    //   10    1843           402                         388
+    //   20    2375           712                         690
+
+    // Display the table header
+    stream << "Size";
+    for( const auto & [structure, operations] : matrix.begin()->second ) for( const auto & [operation, accumulatedTime] : operations )
+    {
+        stream << '\t' << structure << '/' << operation;
+    }
+    stream << '\n';
+
+    // Display the table data
+    for( const auto & [size, structures] : matrix )
+    {
+      stream << size;
+      for( const auto & [structure, operations] : structures )  for( const auto & [operation, accumulatedTime] : operations )
+      {
+          stream << '\t' << accumulatedTime;
+      }
+      stream << '\n';
+    }
+
+    return stream;
+  }
+}    // namespace
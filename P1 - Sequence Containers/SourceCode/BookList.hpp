@@ -12,6 +12,13 @@
 #include "Book.hpp"
 
 
+// The array's fixed capacity is intentionally small for the homework, but benchmark builds need lists far larger than that.  Those
+// builds raise the limit on the command line, e.g. -DBOOKLIST_CAPACITY=1050000
+#ifndef BOOKLIST_CAPACITY
+  #define BOOKLIST_CAPACITY 11
+#endif
+
+
 class BookList
 {
   // Insertion and Extraction Operators
@@ -41,6 +48,8 @@ class BookList
     BookList & operator=( BookList && rhs );                                                  
                                                                                               
     BookList             ( const std::initializer_list<Book> & initList );                    // constructs a book list from a braced list of books
+    explicit BookList    ( const std::vector<Book>           & books    );                    // constructs a book list from a collection of books in one pass,
+                                                                                              // discarding duplicates as insert() does
     BookList & operator+=( const std::initializer_list<Book> & rhs      );                    // concatenates a braced list of books to this list
     BookList & operator+=( const BookList                    & rhs      );                    // concatenates the rhs list to the end of this list
 
@@ -72,10 +81,10 @@ class BookList
     // Instance Attributes
     std::size_t _books_array_size   = 0;                                                      // std::array's size is constant so manage that attributes ourself
 
-    std::array       <Book, 11>  _books_array;
-    std::vector      <Book    >  _books_vector;
-    std::list        <Book    >  _books_dl_list;
-    std::forward_list<Book    >  _books_sl_list;
+    std::array       <Book, BOOKLIST_CAPACITY>  _books_array;
+    std::vector      <Book                   >  _books_vector;
+    std::list        <Book                   >  _books_dl_list;
+    std::forward_list<Book                   >  _books_sl_list;
 };
 
 // Relational Operators
@@ -2,6 +2,7 @@
 #include <iomanip>     // setprecision()
 #include <iostream>    // boolalpha(), showpoint(), fixed()
 #include <string>      // to_string()
+#include <vector>
 
 #include "CheckResults.hpp"
 #include "BookList.hpp"
@@ -49,6 +50,15 @@ namespace    // anonymous
       affirm.is_equal( "Initializer list constructor:  content", expected, list        );
     }
 
+    {
+      BookList list( std::vector<Book>{book_2, book_3, book_2, book_1, book_3} );
+
+      BookList expected = {book_2, book_3, book_1};
+
+      affirm.is_equal( "Collection constructor:  Size",                 3U,       list.size() );
+      affirm.is_equal( "Collection constructor:  duplicates discarded", expected, list        );
+    }
+
     {
       BookList list1 = {book_2, book_3, book_1, book_4};
       list1 += {book_3, book_1, book_2, book_5};
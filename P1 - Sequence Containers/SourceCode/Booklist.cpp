@@ -1,10 +1,13 @@
 #include <algorithm>    // find(), move(), move_backward(), equal(), swap(), lexicographical_compare()
 #include <cstddef>      // size_t
+#include <functional>   // less, reference_wrapper
 #include <initializer_list>
 #include <iomanip>      // setw()
 #include <iterator>     // distance(), next()
+#include <set>
 #include <stdexcept>    // logic_error
 #include <string>
+#include <vector>
 
 #include "Book.hpp"
 #include "BookList.hpp"
@@ -114,6 +117,24 @@ BookList::BookList( const std::initializer_list<Book> & initList )
 
 
 
+BookList::BookList( const std::vector<Book> & books )
+{
+  // Building a large list by repeated insertion is quadratic (each insertion searches for duplicates and verifies consistency), so
+  // populate all four containers in a single pass just like the initializer list constructor above.  Duplicates are discarded,
+  // keeping the first, as insert() does, but found by remembering the books seen in order rather than by searching the list.  Unlike
+  // the initializer list constructor, a collection too large for the array is an error rather than silently truncated.
+  std::set<std::reference_wrapper<const Book>, std::less<Book>> seen;
+  for( const auto & book : books )  if( seen.insert( book ).second ) _books_vector.push_back( book );
+
+  if( _books_vector.size() > _books_array.size() ) throw CapacityExceeded_Ex( "Insufficient capacity to hold the collection of books" exception_location );
+
+  _books_dl_list.assign( _books_vector.begin(), _books_vector.end() );
+  _books_sl_list.assign( _books_vector.begin(), _books_vector.end() );
+  for( const auto & book : _books_vector )  _books_array[_books_array_size++] = book;
+}
+
+
+
 BookList & BookList::operator+=( const std::initializer_list<Book> & rhs )
 {
   ///////////////////////// TO-DO (2) //////////////////////////////
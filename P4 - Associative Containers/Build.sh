@@ -9,7 +9,7 @@ executableFileName="${1:-project}"
 # temporarily ignore spaces when globing words into file names
 temp=$IFS
   IFS=$'\n'
-  sourceFiles=( $(find ./ -name "*.cpp") ) # create array of source files
+  sourceFiles=( $(find ./ -name "*.cpp" -not -path "*/Tools/*" -not -path "*/Benchmarks/*") ) # create array of source files, tools and benchmarks are separate programs
 IFS=$temp
 
 echo "compiling ..."
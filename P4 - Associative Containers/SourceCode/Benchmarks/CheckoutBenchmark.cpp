@@ -0,0 +1,333 @@
+#include <algorithm>        // sort(), min(), unique()
+#include <atomic>           // atomic
+#include <chrono>           // nanoseconds
+#include <cstddef>          // size_t
+#include <cstdint>          // uint64_t
+#include <cstdlib>          // malloc(), free(), stoul()
+#include <iomanip>          // setprecision()
+#include <iostream>         // standard i/o streams cout, clog
+#include <map>              // Binary search tree associative container with no duplicates
+#include <new>              // bad_alloc
+#include <streambuf>        // streambuf
+#include <string>           // Unbounded strings, stoul()
+#include <thread>           // hardware_concurrency()
+#include <vector>           // Unbounded vector
+
+#include "../BookDatabase.hpp"
+#include "../Bookstore.hpp"
+#include "../CartGenerator.hpp"
+#include "../FlatCart.hpp"
+#include "Timer.hpp"
+
+
+
+
+
+
+
+/*********************************************************************************************************************************
+**  Private type declarations, function declarations, and object definitions
+*********************************************************************************************************************************/
+namespace    // unnamed, anonymous namespace
+{
+  /*********************************************************************************************************************************
+  **  Type Definitions
+  *********************************************************************************************************************************/
+  // Create a matrix indexed by checkout thread count, database backend, and measurement.  This is the same shape as the Final
+  // Project's TimeMatrix so the tab-separated tables can be graphed side by side.
+  using MeasurementName = std::string;
+  using BackendName     = std::string;
+  using ThreadCount     = std::size_t;
+  using Measurement     = double;
+
+  // A 3 dimensional collection of measurements indexed by thread count, database backend, and measurement
+  using ResultMatrix = std::map<ThreadCount, std::map<BackendName, std::map<MeasurementName, Measurement>>>;
+
+  // A whole batch of carts takes well under a minute, so measure in nanoseconds
+  char nanoseconds[] = "nanoseconds";
+  using TimerNS      = Utilities::TimerType<std::chrono::nanoseconds, nanoseconds>;
+
+  // The ways BookDatabase can be told to hold the catalog, each measured in turn
+  struct Backend
+  {
+    BackendName            name;
+    BookDatabase::Options  options;
+  };
+
+  // Receipts and re-order notices are written to std::cout, where the results go, so they're written here instead.  Formatting
+  // them is still part of what's measured.
+  class NullBuffer : public std::streambuf
+  {
+    protected:
+      int_type        overflow( int_type ch )                         override { return ch;    }
+      std::streamsize xsputn  ( const char *, std::streamsize count ) override { return count; }
+  };
+
+  // Points std::cout at another buffer until destroyed, so it's put back however the scope is left, even by an exception
+  class Redirect
+  {
+    public:
+      explicit Redirect( std::streambuf * buffer ) : _original( std::cout.rdbuf( buffer ) ) {}
+     ~Redirect()                                     { std::cout.rdbuf( _original ); }
+
+      Redirect            ( const Redirect & ) = delete;
+      Redirect & operator=( const Redirect & ) = delete;
+
+    private:
+      std::streambuf * _original;
+  };
+
+
+
+  /*********************************************************************************************************************************
+  **  Function Declarations
+  *********************************************************************************************************************************/
+  std::ostream & operator<<( std::ostream & stream, const ResultMatrix & matrix );
+
+  std::vector<Backend> backends();
+
+  void collect_checkout_measurements( const Backend & backend, const std::vector<ThreadCount> & threadCounts );
+
+  void measure( const BackendName & backend,                                  // free text name of the database backend under test
+                ThreadCount         threads,                                  // number of carts checked out at once
+                bool                pipelined = false );                      // checked out through the staged pipeline instead
+
+
+
+  /*********************************************************************************************************************************
+  **  Object Definitions
+  *********************************************************************************************************************************/
+  CartBatch                shoppingCarts;                                     // the same carts are checked out every run
+  std::size_t              itemsInCarts = 0;                                  // copies of books in all the carts
+  ResultMatrix             results;                                           // collection of measurements
+  std::atomic<std::size_t> allocations{ 0 };                                  // calls to operator new since last reset
+}    // unnamed, anonymous namespace
+
+
+
+
+// Every allocation the program makes is counted, so allocations per item checked out can be reported.  The array forms of operator
+// new and delete fall back on these.
+void * operator new( std::size_t size )
+{
+  allocations.fetch_add( 1, std::memory_order_relaxed );
+  if( auto memory = std::malloc( size == 0 ? 1 : size ) ) return memory;
+  throw std::bad_alloc();
+}
+
+void operator delete( void * memory ) noexcept
+{
+  std::free( memory );
+}
+
+void operator delete( void * memory, std::size_t ) noexcept
+{
+  std::free( memory );
+}
+
+
+
+
+
+
+
+
+
+// Usage:  checkout_benchmark [carts [threads ...]]
+//   Checks out the given number of generated carts (100,000 by default, about a million items, and at least one) against each
+//   database backend, on each of the given numbers of checkout threads (1, 2, 4 and one per core by default, where 0 means one per
+//   core).
+int main( int argc, char * argv[] )
+{
+  std::size_t              carts = argc > 1 ? std::stoul( argv[1] ) : 100'000;
+  std::vector<ThreadCount> threadCounts;
+  for( int arg = 2; arg < argc; ++arg ) threadCounts.push_back( std::stoul( argv[arg] ) );
+  if( threadCounts.empty() ) threadCounts = { 1, 2, 4, std::thread::hardware_concurrency() };
+
+  for( auto & threads : threadCounts ) if( threads == 0 ) threads = std::max( 1U, std::thread::hardware_concurrency() );
+  std::sort( threadCounts.begin(), threadCounts.end() );
+  threadCounts.erase( std::unique( threadCounts.begin(), threadCounts.end() ), threadCounts.end() );
+
+  // With no carts there are no latencies to take percentiles of, and no items to divide the time by
+  if( carts == 0 )
+  {
+    std::clog << "Usage:  " << ( argc > 0 ? argv[0] : "checkout_benchmark" ) << " [carts [threads ...]], with at least one cart\n";
+    return 2;
+  }
+
+  Utilities::Timer totalElapsedTime( "total elapsed time is ", std::clog );
+
+  // Carts are drawn from the catalog as loaded by default, and the same carts are checked out against every backend
+  {
+    std::clog << "Generating " << carts << " shopping carts\n";
+    Utilities::Timer timer( "Shopping carts generated in ", std::clog );
+    shoppingCarts = CartGenerator( CartGenerator::Options() ).generate( carts );
+    for( auto cart : shoppingCarts ) for( auto & item : cart ) itemsInCarts += item.quantity();
+  }
+
+  for( const auto & backend : backends() )
+  {
+    std::clog << "Starting to collect checkout measurements with the " << backend.name << " backend\n";
+    Utilities::Timer( "Checkout measurements completed in ", std::clog ), collect_checkout_measurements( backend, threadCounts );
+  }
+
+  //  Report measurements
+  std::cout << results << '\n';
+
+  std::clog << '\n' << std::string( 80, '-' ) << '\n';
+}
+
+
+
+
+
+
+
+
+
+
+
+
+
+/*********************************************************************************************************************************
+**  Private definitions
+*********************************************************************************************************************************/
+namespace    // unnamed, anonymous namespace
+{
+  /*********************************************************************************************************************************
+  **  Collect Checkout Measurements
+  *********************************************************************************************************************************/
+  std::vector<Backend> backends()
+  {
+    std::vector<Backend> list( 5 );
+    list[0].name = "HashTable";
+    list[1].name = "PerfectHash";       list[1].options.perfectHashIndex = true;
+    list[2].name = "Compressed";        list[2].options.compressStrings  = true;
+    list[3].name = "Lazy";              list[3].options.loadLazily       = true;
+    list[4].name = "DiskResident";      list[4].options.diskResident     = true;
+    return list;
+  }
+
+
+
+  void collect_checkout_measurements( const Backend & backend, const std::vector<ThreadCount> & threadCounts )
+  {
+    BookDatabase::configure( backend.options );
+    BookDatabase::instance().reload();
+
+    // Lazy and compressed backends build each book the first time it's looked up, so check out once unmeasured to measure them as a
+    // store open all day would run, not as one just opened
+    {
+      NullBuffer nowhere;
+      Redirect   toNowhere( &nowhere );
+      Bookstore  store;
+      store.checkoutThreads( 0 );
+      store.processCustomerShoppingCarts( shoppingCarts );
+    }
+
+    for( auto threads : threadCounts ) measure( backend.name, threads );
+
+    // The pipeline runs its own four stages whatever the number of checkout threads, so it's measured once and shown alike in every row
+    measure( backend.name + " pipelined", threadCounts.front(), true );
+    for( auto threads : threadCounts ) results[threads][backend.name + " pipelined"] = results[threadCounts.front()][backend.name + " pipelined"];
+  }
+
+
+
+
+
+
+
+
+  /*********************************************************************************************************************************
+  **  Other Function Definitions
+  *********************************************************************************************************************************/
+  // Checks out every cart against a freshly opened store, then re-orders what sold below the threshold, and records:
+  //   o) items checked out per second, wall clock, receipts printed included
+  //   o) the 50th, 99th and 99.9th percentile of the time taken to ring up one cart, receipts printed excluded
+  //   o) calls to operator new per item checked out
+  //   o) the time taken by reorderItems()
+  // and, pipelined, how full the queue into each stage was kept
+  void measure( const BackendName & backend, ThreadCount threads, bool pipelined )
+  {
+    Bookstore store;
+    store.checkoutThreads( threads );
+    store.timeCheckouts  ( true    );
+    store.pipelineCheckouts( pipelined );
+
+    double checkoutTime, allocated, reorderTime;
+    {
+      NullBuffer nowhere;
+      Redirect   toNowhere( &nowhere );
+
+      allocations = 0;
+      TimerNS checkoutTimer;
+      auto    sales = store.processCustomerShoppingCarts( shoppingCarts );
+      checkoutTime  = static_cast<double>( checkoutTimer );
+      allocated     = static_cast<double>( allocations.load() );
+
+      TimerNS reorderTimer;
+      store.reorderItems( sales );
+      reorderTime   = static_cast<double>( reorderTimer );
+    }
+
+    auto latencies = store.checkoutLatencies();
+    std::sort( latencies.begin(), latencies.end() );
+    auto percentile = [&]( double fraction ) { return static_cast<Measurement>( latencies[std::min( latencies.size() - 1, static_cast<std::size_t>( fraction * static_cast<double>( latencies.size() ) ) )] ); };
+
+    auto & row = results[threads][backend];
+    row["Items/sec"  ] = static_cast<double>( itemsInCarts ) * 1e9 / checkoutTime;
+    row["p50 ns"     ] = percentile( 0.50  );
+    row["p99 ns"     ] = percentile( 0.99  );
+    row["p999 ns"    ] = percentile( 0.999 );
+    row["Allocs/item"] = allocated / static_cast<double>( itemsInCarts );
+    row["Reorder ns" ] = reorderTime;
+
+    if( !pipelined )
+    {
+      std::clog << "  " << threads << " thread(s):  " << static_cast<std::size_t>( row["Items/sec"] ) << " items per second\n";
+      return;
+    }
+
+    std::clog << "  pipelined:  " << static_cast<std::size_t>( row["Items/sec"] ) << " items per second, carts waiting to be";
+    const char * stages[] = { "priced", "taken from stock", "printed" };
+    for( std::size_t stage = 0; stage < store.pipelineStatistics().size(); ++stage )
+    {
+      const auto & queue = store.pipelineStatistics()[stage];
+      std::clog << ( stage == 0 ? " " : ", " ) << stages[stage] << ' ' << queue.meanOccupancy() << " of " << queue.capacity;
+    }
+    std::clog << " on average\n";
+  }
+
+
+
+  std::ostream & operator<<( std::ostream & stream, const ResultMatrix & matrix )
+  {
+    // dump the data collected in a tab-separated values (tsv) table, for example:
+    //   Threads  HashTable/Allocs/item  HashTable/Items/sec  HashTable/Reorder ns  HashTable/p50 ns  ...
+    //   1        2.41                   1534276.12           81273.00              512.00            ...
+    //   2        2.41                   2788190.52           79881.00              540.00            ...
+    stream << std::fixed << std::setprecision( 2 );
+
+    // Display the table header
+    stream << "Threads";
+    for( const auto & [backend, measurements] : matrix.begin()->second ) for( const auto & [measurement, value] : measurements )
+    {
+        stream << '\t' << backend << '/' << measurement;
+    }
+    stream << '\n';
+
+    // Display the table data
+    for( const auto & [threads, backends] : matrix )
+    {
+      stream << threads;
+      for( const auto & [backend, measurements] : backends )  for( const auto & [measurement, value] : measurements )
+      {
+          stream << '\t' << value;
+      }
+      stream << '\n';
+    }
+
+    return stream;
+  }
+}    // namespace
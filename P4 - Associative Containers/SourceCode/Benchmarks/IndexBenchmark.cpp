@@ -0,0 +1,302 @@
+#include <algorithm>        // shuffle()
+#include <chrono>           // nanoseconds
+#include <cstddef>          // size_t, ptrdiff_t
+#include <functional>       // hash
+#include <iostream>         // standard i/o streams cout, clog
+#include <map>              // Binary search tree associative container with no duplicates
+#include <memory>           // unique_ptr, make_unique()
+#include <random>           // mt19937
+#include <string>           // Unbounded strings, to_string()
+#include <string_view>
+#include <unordered_map>    // Hash table associative container with no duplicates
+#include <vector>           // Unbounded vector
+
+#include "../Book.hpp"
+#include "../PerfectHashIndex.hpp"
+#include "Timer.hpp"
+
+
+
+
+
+
+
+/*********************************************************************************************************************************
+**  Private type declarations, function declarations, and object definitions
+*********************************************************************************************************************************/
+namespace    // unnamed, anonymous namespace
+{
+  /*********************************************************************************************************************************
+  **  Type Definitions
+  *********************************************************************************************************************************/
+  // Create a matrix indexed by catalog size, data structure, and operation that holds the time measured to perform the operation.
+  // This is the same shape as the Final Project's TimeMatrix so the tab-separated tables can be graphed side by side.
+  using OperationName     = std::string;
+  using DataStructureName = std::string;
+  using SnapshotInterval  = std::size_t;
+  using ElapsedTime       = std::size_t;
+
+  // A 3 dimensional collection of elapsed time measurements indexed by catalog size, data structure, and operation
+  using TimeMatrix = std::map<SnapshotInterval, std::map<DataStructureName, std::map<OperationName, ElapsedTime>>>;
+
+  // Lookups complete in well under a microsecond, so measure in nanoseconds
+  char nanoseconds[] = "nanoseconds";
+  using TimerNS      = Utilities::TimerType<std::chrono::nanoseconds, nanoseconds>;
+
+  // A table laid out by a perfect hash, as BookDatabase lays out its index when Options::perfectHashIndex is set
+  struct PerfectHashTable
+  {
+    struct Slot
+    {
+      std::size_t  hash = 0;                                                  // the fingerprint that rejects ISBNs not in the table
+      const Book * book = nullptr;
+    };
+
+    PerfectHashTable( const std::vector<Book> & books, unsigned threads );
+
+    const Book * find( const std::string & isbn ) const;
+
+    PerfectHashIndex  index;
+    std::vector<Slot> slots;
+  };
+
+
+
+  /*********************************************************************************************************************************
+  **  Function Declarations
+  *********************************************************************************************************************************/
+  std::ostream & operator<<( std::ostream & stream, const TimeMatrix & matrix );
+
+  template<class Lookup>
+  void measure( std::size_t                      size,                        // number of books in the catalog under test
+                const std::string              & structure,                   // free text name of the data structure being measured
+                const std::string              & operationDescription,        // free text name of the operation being measured
+                const std::vector<std::string> & isbns,                       // ISBNs to look up, in the order to look them up
+                Lookup                           lookup );                    // looks up one ISBN, returns the book found or nullptr
+
+  template<class Build>
+  void measureBuild( std::size_t         size,
+                     const std::string & structure,
+                     const std::string & operationDescription,
+                     Build               build );                             // builds the structure, measured once
+
+  void collect_index_measurements( std::size_t size );
+
+
+
+  /*********************************************************************************************************************************
+  **  Object Definitions
+  *********************************************************************************************************************************/
+  std::vector<Book>    sampleData;                                             // collection of data samples
+  TimeMatrix           runTimes;                                               // collection of operation time measurements
+  volatile std::size_t sink = 0;                                               // keeps the optimizer from discarding lookups
+}    // unnamed, anonymous namespace
+
+
+
+
+
+
+
+
+
+
+
+int main()
+{
+  // Catalog sizes grow in a 1-2-5 progression from 1,000 to 1,000,000
+  std::vector<std::size_t> sizes;
+  for( std::size_t decade = 1'000; decade <= 1'000'000; decade *= 10 )  for( std::size_t step : {1, 2, 5} )
+  {
+    if( decade * step <= 1'000'000 ) sizes.push_back( decade * step );
+  }
+
+  // Synthesize ISBN-like keys spread the way real ISBNs are, so hashing and comparing them costs what it would in the database
+  for( std::size_t i = 0; i < sizes.back(); ++i )
+  {
+    auto isbn = std::to_string( 1'000'000'007ULL + i * 7'919ULL % 8'999'999'999ULL );
+    sampleData.emplace_back( "Title " + isbn, "Author " + isbn, isbn, i % 100 + 0.99 );
+  }
+
+  Utilities::Timer totalElapsedTime( "total elapsed time is ", std::clog );
+
+  for( auto size : sizes )
+  {
+    std::clog << "Starting to collect index measurements with " << size << " books\n";
+    Utilities::Timer( "Index measurements completed in ", std::clog ), collect_index_measurements( size );
+  }
+
+  //  Report measurements
+  std::cout << runTimes << '\n';
+
+  std::clog << '\n' << std::string( 80, '-' ) << '\n';
+}
+
+
+
+
+
+
+
+
+
+
+
+
+
+/*********************************************************************************************************************************
+**  Private definitions
+*********************************************************************************************************************************/
+namespace    // unnamed, anonymous namespace
+{
+  /*********************************************************************************************************************************
+  **  Collect Index Measurements
+  *********************************************************************************************************************************/
+  void collect_index_measurements( std::size_t size )
+  {
+    const std::vector<Book> books( sampleData.cbegin(), sampleData.cbegin() + static_cast<std::ptrdiff_t>( size ) );
+
+    // Look up every book once in a random order, so successive lookups don't share cache lines, and as many ISBNs that aren't there
+    std::vector<std::string> hits, misses;
+    for( const auto & book : books )
+    {
+      hits  .push_back( book.isbn() );
+      misses.push_back( book.isbn() + 'X' );
+    }
+
+    std::mt19937 random( 131 );
+    std::shuffle( hits  .begin(), hits  .end(), random );
+    std::shuffle( misses.begin(), misses.end(), random );
+
+
+    std::map<std::string, Book> tree;
+    measureBuild( size, "std::map", "Build", [&] { for( const auto & book : books ) tree.emplace( book.isbn(), book ); } );
+
+    auto findInTree = [&]( const std::string & isbn ) -> const Book * { auto it = tree.find( isbn );  return it == tree.end() ? nullptr : &it->second; };
+    measure( size, "std::map", "Find", hits,   findInTree );
+    measure( size, "std::map", "Miss", misses, findInTree );
+
+
+    std::unordered_map<std::string, Book> hashTable;
+    measureBuild( size, "std::unordered_map", "Build", [&] { hashTable.reserve( size );  for( const auto & book : books ) hashTable.emplace( book.isbn(), book ); } );
+
+    auto findInHashTable = [&]( const std::string & isbn ) -> const Book * { auto it = hashTable.find( isbn );  return it == hashTable.end() ? nullptr : &it->second; };
+    measure( size, "std::unordered_map", "Find", hits,   findInHashTable );
+    measure( size, "std::unordered_map", "Miss", misses, findInHashTable );
+
+
+    // The perfect hash table refers to the books rather than holding copies of them, as BookDatabase's index refers to its records
+    measureBuild( size, "PerfectHashIndex", "Build (1 thread)", [&] { PerfectHashTable( books, 1 ); } );
+
+    std::unique_ptr<PerfectHashTable> perfect;
+    measureBuild( size, "PerfectHashIndex", "Build", [&] { perfect = std::make_unique<PerfectHashTable>( books, 0 ); } );
+
+    auto findInPerfect = [&]( const std::string & isbn ) { return perfect->find( isbn ); };
+    measure( size, "PerfectHashIndex", "Find", hits,   findInPerfect );
+    measure( size, "PerfectHashIndex", "Miss", misses, findInPerfect );
+
+    std::clog << "  Perfect hash index:  " << perfect->index.sizeInBytes() * 8.0 / size << " bits per key, "
+              << ( perfect->index.sizeInBytes() + perfect->slots.size() * sizeof( PerfectHashTable::Slot ) ) * 8.0 / size << " with the table\n";
+  }
+
+
+
+
+
+
+
+
+  /*********************************************************************************************************************************
+  **  Perfect Hash Table
+  *********************************************************************************************************************************/
+  PerfectHashTable::PerfectHashTable( const std::vector<Book> & books, unsigned threads )
+  {
+    std::vector<std::size_t> hashes;
+    hashes.reserve( books.size() );
+    for( const auto & book : books ) hashes.push_back( std::hash<std::string_view>{}( book.isbn() ) );
+
+    index = PerfectHashIndex( hashes, threads );
+    slots.resize( books.size() );
+    for( std::size_t i = 0; i < books.size(); ++i ) slots[index.slot( hashes[i] )] = { hashes[i], &books[i] };
+  }
+
+
+
+  const Book * PerfectHashTable::find( const std::string & isbn ) const
+  {
+    const auto   hash = std::hash<std::string_view>{}( isbn );
+    const auto & slot = slots[index.slot( hash )];
+
+    return slot.hash == hash && slot.book->isbn() == isbn ? slot.book : nullptr;
+  }
+
+
+
+
+
+
+
+
+  /*********************************************************************************************************************************
+  **  Other Function Definitions
+  *********************************************************************************************************************************/
+  // Template function to measure the average elapsed time consumed to look up each of the ISBNs given
+  template<class Lookup>
+  void measure( std::size_t                      size,                        // number of books in the catalog under test
+                const std::string              & structure,                   // free text name of the data structure being measured
+                const std::string              & operationDescription,        // free text name of the operation being measured
+                const std::vector<std::string> & isbns,                       // ISBNs to look up, in the order to look them up
+                Lookup                           lookup )                     // looks up one ISBN, returns the book found or nullptr
+  {
+    TimerNS timer;                                                            // measures wall clock time in nanoseconds
+    for( const auto & isbn : isbns ) sink += lookup( isbn ) != nullptr;
+
+    runTimes[size][structure][operationDescription] = timer / isbns.size();
+  }
+
+
+
+  // Template function to measure the average elapsed time per book consumed to build a structure once
+  template<class Build>
+  void measureBuild( std::size_t         size,
+                     const std::string & structure,
+                     const std::string & operationDescription,
+                     Build               build )
+  {
+    TimerNS timer;
+    build();
+
+    runTimes[size][structure][operationDescription] = timer / size;
+  }
+
+
+
+  std::ostream & operator<<( std::ostream & stream, const TimeMatrix & matrix)
+  {
+    // dump the data collected in a tab-separated values (tsv) table, for example:
+    //   Size  PerfectHashIndex/Build  PerfectHashIndex/Find  std::map/Find
+    //   1000  187                     21                     96
+    //   2000  190                     22                     113
+
+    // Display the table header
+    stream << "Size";
+    for( const auto & [structure, operations] : matrix.begin()->second ) for( const auto & [operation, accumulatedTime] : operations )
+    {
+        stream << '\t' << structure << '/' << operation;
+    }
+    stream << '\n';
+
+    // Display the table data
+    for( const auto & [size, structures] : matrix )
+    {
+      stream << size;
+      for( const auto & [structure, operations] : structures )  for( const auto & [operation, accumulatedTime] : operations )
+      {
+          stream << '\t' << accumulatedTime;
+      }
+      stream << '\n';
+    }
+
+    return stream;
+  }
+}    // namespace
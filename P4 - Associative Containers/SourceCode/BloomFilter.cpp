@@ -0,0 +1,77 @@
+#include <algorithm>    // clamp(), max()
+#include <cmath>        // ceil(), log(), lround()
+#include <cstddef>      // size_t
+#include <cstdint>      // uint32_t, uint64_t
+#include <functional>   // hash
+#include <string_view>
+
+#include "BloomFilter.hpp"
+
+
+
+BloomFilter::BloomFilter( std::size_t expectedKeys, double falsePositiveRate )
+{
+  // The classic sizing is m/n = -ln(p) / ln(2)^2 bits per key with k = (m/n) ln(2) hash functions.  Confining every key's bits to a
+  // single block makes some blocks more crowded than others, so provision a little more space than the classic formula calls for.
+  constexpr double BLOCKING_OVERHEAD = 1.2;
+  const     double ln2               = std::log( 2.0 );
+
+  falsePositiveRate = std::clamp( falsePositiveRate, 1e-6, 0.5 );
+  const double bitsPerKey = -std::log( falsePositiveRate ) / ( ln2 * ln2 ) * BLOCKING_OVERHEAD;
+
+  _bitsPerKey = static_cast<unsigned>( std::clamp( std::lround( bitsPerKey / BLOCKING_OVERHEAD * ln2 ), 1L, 16L ) );
+
+  const auto totalBits = static_cast<std::size_t>( std::ceil( bitsPerKey * static_cast<double>( std::max<std::size_t>( expectedKeys, 1 ) ) ) );
+  _blocks.resize( ( totalBits + BITS_PER_BLOCK - 1 ) / BITS_PER_BLOCK );
+}
+
+
+
+std::size_t BloomFilter::blockIndex( std::size_t hash ) const
+{
+  // Scramble the hash (Fibonacci hashing) and use the high half of the product to pick a block, leaving the low half of the hash to
+  // pick bits within the block.  A multiply and shift maps the block number into range without a division.
+  const std::uint64_t high = ( std::uint64_t{ hash } * 0x9E37'79B9'7F4A'7C15ULL ) >> 32;
+  return ( high * _blocks.size() ) >> 32;
+}
+
+
+
+bool BloomFilter::mayContain( std::size_t hash ) const
+{
+  const Block & candidate = _blocks[blockIndex( hash )];
+
+  // Derive the key's bit positions from two halves of the low word of the hash (double hashing)
+  const auto h1 = static_cast<std::uint32_t>( hash );
+  const auto h2 = ( h1 >> 16 ) | ( h1 << 16 ) | 1U;
+
+  for( unsigned i = 0; i < _bitsPerKey; ++i )
+  {
+    const std::uint32_t bit = ( h1 + i * h2 ) % BITS_PER_BLOCK;
+    if( ( candidate.words[bit / 64] & ( std::uint64_t{ 1 } << ( bit % 64 ) ) ) == 0 ) return false;
+  }
+  return true;
+}
+
+
+
+void BloomFilter::insert( std::size_t hash )
+{
+  Block & candidate = _blocks[blockIndex( hash )];
+
+  const auto h1 = static_cast<std::uint32_t>( hash );
+  const auto h2 = ( h1 >> 16 ) | ( h1 << 16 ) | 1U;
+
+  for( unsigned i = 0; i < _bitsPerKey; ++i )
+  {
+    const std::uint32_t bit = ( h1 + i * h2 ) % BITS_PER_BLOCK;
+    candidate.words[bit / 64] |= std::uint64_t{ 1 } << ( bit % 64 );
+  }
+}
+
+
+
+bool         BloomFilter::mayContain ( std::string_view key  ) const { return mayContain( std::hash<std::string_view>{}( key ) ); }
+void         BloomFilter::insert     ( std::string_view key  )       { insert( std::hash<std::string_view>{}( key ) );            }
+const void * BloomFilter::blockFor   ( std::size_t      hash ) const { return &_blocks[blockIndex( hash )];                       }
+std::size_t  BloomFilter::sizeInBytes()                        const { return _blocks.size() * sizeof( Block );                   }
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstddef>    // size_t
+#include <cstdint>    // uint64_t
+#include <string_view>
+#include <vector>
+
+
+
+// A blocked Bloom filter answers "definitely not present" or "possibly present" for a set of keys.  Every key maps to a single 64
+// byte block (one cache line) and all of the key's bits are set within that block, so a query costs exactly one cache line probe.
+// Keys are identified by their hash value so callers that already hashed a key don't pay to hash it again.
+class BloomFilter
+{
+  public:
+    // Constructors
+    BloomFilter( std::size_t expectedKeys = 0, double falsePositiveRate = 0.01 );  // sizes the filter to achieve approximately the
+                                                                                    // requested false positive rate once expectedKeys
+                                                                                    // have been inserted
+    // Queries
+    bool        mayContain ( std::size_t      hash ) const;                        // false means the key was never inserted
+    bool        mayContain ( std::string_view key  ) const;
+    const void * blockFor  ( std::size_t      hash ) const;                        // address of the block probed for this hash, used to
+                                                                                    // prefetch the block ahead of the query
+    std::size_t sizeInBytes()                        const;
+
+    // Mutators
+    void insert( std::size_t      hash );
+    void insert( std::string_view key  );
+
+  private:
+    static constexpr std::size_t BITS_PER_BLOCK = 512;                             // one 64 byte cache line
+
+    struct alignas( 64 ) Block
+    {
+      std::uint64_t words[BITS_PER_BLOCK / 64] = {};
+    };
+
+    std::size_t blockIndex( std::size_t hash ) const;
+
+    std::vector<Block> _blocks;
+    unsigned           _bitsPerKey = 1;                                            // number of bits set (and tested) per key
+};
@@ -0,0 +1,79 @@
+#include <cstddef>    // size_t
+#include <exception>
+#include <iomanip>    // setprecision()
+#include <iostream>   // boolalpha(), showpoint(), fixed()
+#include <string>     // to_string()
+
+#include "BloomFilter.hpp"
+#include "CheckResults.hpp"
+
+
+
+
+
+namespace  // anonymous
+{
+  class BloomFilterRegressionTest
+  {
+    public:
+      BloomFilterRegressionTest();
+
+    private:
+      void tests();
+
+      Regression::CheckResults affirm;
+  } run_bloomFilter_tests;
+
+
+
+
+  void BloomFilterRegressionTest::tests()
+  {
+    constexpr std::size_t KEY_COUNT           = 10'000;
+    constexpr double      FALSE_POSITIVE_RATE = 0.01;
+
+    BloomFilter filter( KEY_COUNT, FALSE_POSITIVE_RATE );
+    for( std::size_t i = 0; i < KEY_COUNT; ++i ) filter.insert( "inserted-" + std::to_string( i ) );
+
+    {
+      bool allFound = true;
+      for( std::size_t i = 0; i < KEY_COUNT; ++i ) allFound = allFound && filter.mayContain( "inserted-" + std::to_string( i ) );
+      affirm.is_true( "Bloom filter - no false negatives", allFound );
+    }
+
+    {
+      std::size_t falsePositives = 0;
+      for( std::size_t i = 0; i < KEY_COUNT; ++i ) if( filter.mayContain( "absent-" + std::to_string( i ) ) ) ++falsePositives;
+
+      // Allow some slack over the requested rate, but it should be nowhere near letting everything through
+      affirm.is_true( "Bloom filter - false positive rate near requested rate (" + std::to_string( falsePositives ) + " of " + std::to_string( KEY_COUNT ) + ")",
+                      falsePositives < 2 * FALSE_POSITIVE_RATE * KEY_COUNT );
+    }
+
+    {
+      BloomFilter empty;
+      affirm.is_true( "Bloom filter - empty filter contains nothing", !empty.mayContain( "anything" ) );
+    }
+  }
+
+
+
+  BloomFilterRegressionTest::BloomFilterRegressionTest()
+  {
+    std::clog << std::boolalpha << std::showpoint << std::fixed << std::setprecision( 2 );
+
+
+    try
+    {
+      std::clog << "\nBloom Filter Regression Test:\n";
+      tests();
+
+      std::clog << affirm << '\n';
+    }
+    catch( const std::exception & ex )
+    {
+      std::clog << "FAILURE:  Regression test for \"class BloomFilter\" failed with an unhandled exception. \n\n\n"
+                << ex.what() << std::endl;
+    }
+  }
+} // namespace
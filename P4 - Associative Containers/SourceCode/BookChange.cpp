@@ -0,0 +1,51 @@
+#include <iomanip>    // quoted()
+#include <iostream>
+#include <string>
+#include <utility>    // move()
+
+#include "Book.hpp"
+#include "BookChange.hpp"
+
+
+
+// Insertion and Extraction Operators
+std::ostream & operator<<( std::ostream & stream, const BookChange & change )
+{
+  stream << static_cast<char>( change.operation ) << ' ';
+
+  if( change.operation == BookChange::Operation::REMOVE ) stream << std::quoted( change.book.isbn() );
+  else                                                    stream << change.book;
+
+  return stream;
+}
+
+std::istream & operator>>( std::istream & stream, BookChange & change )
+{
+  char       tag = '\0';
+  BookChange temp;
+
+  if( !( stream >> tag ) ) return stream;
+
+  switch( static_cast<BookChange::Operation>( tag ) )
+  {
+    case BookChange::Operation::ADD:
+    case BookChange::Operation::UPDATE:
+      stream >> temp.book;
+      break;
+
+    case BookChange::Operation::REMOVE:
+    {
+      std::string isbn;
+      if( stream >> std::quoted( isbn ) ) temp.book.isbn( isbn );
+      break;
+    }
+
+    default:
+      stream.setstate( std::ios::failbit );                           // not a change this program understands
+      return stream;
+  }
+
+  temp.operation = static_cast<BookChange::Operation>( tag );
+  if( stream ) change = std::move( temp );
+  return stream;
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <iostream>
+
+#include "Book.hpp"
+
+
+
+// One entry of a catalog delta file.  Each entry is an operation tag followed by a book in the same quoted-field syntax as the
+// database files, except removals which give only the ISBN.
+//
+//  Example:
+//    + "0001062417", "Early aircraft", "Maurice F. Allward", 65.65          adds a book
+//    ~ "0000255406", "Shadow maker",   "Rosemary Sullivan",   9.99          updates a book already in the catalog
+//    - "0000385264"                                                         removes a book
+struct BookChange
+{
+  enum class Operation : char { ADD = '+', UPDATE = '~', REMOVE = '-' };
+
+  Operation operation = Operation::ADD;
+  Book      book;                                                     // only the ISBN is meaningful for removals
+};
+
+// Insertion and Extraction Operators
+std::ostream & operator<<( std::ostream & stream, const BookChange & change );
+std::istream & operator>>( std::istream & stream,       BookChange & change );
@@ -1,17 +1,260 @@
 ///////////////////////// TO-DO (1) //////////////////////////////
   /// Include necessary header files
   /// Hint:  Include what you use, use what you include
+#include <algorithm>     // count_if(), find(), inplace_merge(), sort(), stable_sort()
+#include <atomic>
+#include <cstddef>       // size_t, ptrdiff_t
+#include <cstdint>       // uint32_t
 #include <filesystem>
 #include <fstream>
+#include <functional>    // hash, less
+#include <future>        // async(), shared_future
+#include <map>
+#include <memory>        // shared_ptr, unique_ptr, make_shared(), make_unique()
+#include <mutex>         // call_once(), once_flag
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>       // move(), pair
+#include <vector>
 
+#include "BloomFilter.hpp"
 #include "Book.hpp"
+#include "BookChange.hpp"
 #include "BookDatabase.hpp"
+#include "BookFileIndex.hpp"
+#include "BookTree.hpp"
+#include "CompletionTrie.hpp"
+#include "EpochManager.hpp"
+#include "IsbnResolver.hpp"
+#include "PerfectHashIndex.hpp"
+#include "RecordCache.hpp"
+#include "SecondaryIndexes.hpp"
+#include "StringStore.hpp"
+#include "TitleIndex.hpp"
 /////////////////////// END-TO-DO (1) ////////////////////////////
 
 
 
+namespace  // anonymous
+{
+  // Hint to the processor the memory at this address will soon be needed.  Compilers without the intrinsic simply skip the hint.
+  inline void prefetch( [[maybe_unused]] const void * address )
+  {
+    #if defined( __GNUC__ )
+      __builtin_prefetch( address );
+    #endif
+  }
+}
+
+
+
+// An immutable set of books.  Once published, a catalog is never modified, so any number of readers may use it without
+// synchronizing with each other.
+//
+// The bulk of the books live in a base, either fully parsed and indexed up front or parsed lazily as they are looked up.  Applying a delta doesn't rebuild the base, it creates a new catalog sharing
+// the same base with the delta's changes layered over it.  Lookups consult the (small) overlay first, then the base.
+struct BookDatabase::Catalog
+{
+  using Records = std::map<std::string /*ISBN*/, Book>;
+  using Overlay = std::map<std::string /*ISBN*/, std::optional<Book>, std::less<>>;  // std::nullopt marks a removed book
+
+  struct Base                                                                   // The books a catalog starts with, before deltas
+  {
+    virtual ~Base() = default;
+
+    virtual Book *              find    ( const std::string                   & isbn,  FilterCounters & counters ) = 0;
+    virtual std::vector<Book *> findMany( const std::vector<std::string_view> & isbns, FilterCounters & counters ) = 0;
+    virtual bool                contains( const std::string                   & isbn                             ) const = 0;
+    virtual std::size_t         size    ()                                                                         const = 0;
+    virtual Records             records ()                                                                               = 0;  // Returns a copy of every book
+    virtual std::vector<std::string> isbns()                                                                       const = 0;  // Returns every ISBN, in order, building no book
+    virtual Book *              at      ( std::size_t id )                                                                       = 0;  // Ids are 0, 1, 2, ... in ISBN order
+
+    const SecondaryIndexes & secondaryIndexes();                                // Built on first use
+    const TitleIndex &       titleIndex();                                      // Built on first use
+    const CompletionTrie &   completionTrie();                                  // Built on first use
+    const IsbnResolver &     isbnResolver();                                    // Built on first use
+    std::vector<const Book *> books();                                          // Returns every book, indexed by id
+    Book *                    pin( const Book & book );                         // Returns a copy of a book held by the record cache,
+                                                                                // kept until the base is freed
+
+    std::once_flag                    _secondaryIndexesBuilt;
+    std::unique_ptr<SecondaryIndexes> _secondaryIndexes;
+    std::once_flag                    _titleIndexBuilt;
+    std::unique_ptr<TitleIndex>       _titleIndex;
+    std::once_flag                    _completionTrieBuilt;
+    std::unique_ptr<CompletionTrie>   _completionTrie;
+    std::once_flag                    _isbnResolverBuilt;
+    std::unique_ptr<IsbnResolver>     _isbnResolver;
+    std::unique_ptr<RecordCache>      _recordCache;                             // Lazy and disk resident bases only, if
+                                                                                // Options::recordCacheBytes is set
+    std::mutex                                             _pinnedMutex;
+    std::unordered_map<std::string, std::unique_ptr<Book>> _pinned;            // by ISBN, see pin()
+  };
+
+  struct EagerBase : Base                                                       // Every book parsed and indexed up front
+  {
+    struct IndexSlot                                                            // An open addressed hash table entry referring to a record
+    {
+      std::size_t           hash   = 0;
+      Records::value_type * record = nullptr;                                   // nullptr indicates an empty slot
+    };
+
+    EagerBase( const std::string & filename );
+    EagerBase( Records records );
+
+    Book *              find    ( const std::string                   & isbn,  FilterCounters & counters ) override;
+    std::vector<Book *> findMany( const std::vector<std::string_view> & isbns, FilterCounters & counters ) override;
+    bool                contains( const std::string                   & isbn                             ) const override;
+    std::size_t         size    ()                                                                         const override;
+    Records             records ()                                                                               override;
+    std::vector<std::string> isbns()                                                                       const override;
+    Book *              at      ( std::size_t id )                                                                       override;
+
+    void        buildIndexes();
+    std::size_t homeSlot( std::size_t hash ) const;                             // Where probing for a hash begins
+    std::size_t nextSlot( std::size_t slot ) const;                             // Where probing continues if slot isn't it
+
+    Records                             _data;
+    std::vector<Records::value_type *>  _byId;
+    std::vector<IndexSlot>              _index;                                 // Capacity is a power of two, at most half full.  Or
+    PerfectHashIndex                    _perfectHash;                           // if this isn't empty, one slot per record laid out
+                                                                                // by it, plus an empty slot at the end
+    BloomFilter                         _filter;                                // Screens out ISBNs not in the database before the
+  };                                                                            // index is searched
+
+  struct LazyBase : Base                                                        // Only record offsets indexed up front, books parsed
+  {                                                                             // the first time they're looked up
+    LazyBase( const std::string & filename, EpochManager & epochs );
+
+    Book *              find    ( const std::string                   & isbn,  FilterCounters & counters ) override;
+    std::vector<Book *> findMany( const std::vector<std::string_view> & isbns, FilterCounters & counters ) override;
+    bool                contains( const std::string                   & isbn                             ) const override;
+    std::size_t         size    ()                                                                         const override;
+    Records             records ()                                                                               override;  // parses every book not yet parsed
+    std::vector<std::string> isbns()                                                                       const override;
+    Book *              at      ( std::size_t id )                                                                       override;
+
+    Book * find( std::string_view isbn, FilterCounters & counters );
+
+    BookFileIndex _index;
+    BloomFilter   _filter;
+  };
+
+  struct CompactBase : Base                                                     // Titles and authors compressed, books built the
+  {                                                                             // first time they're looked up
+    CompactBase( const std::string & filename );
+    CompactBase( const Records & records );
+   ~CompactBase() override;
+
+    Book *              find    ( const std::string                   & isbn,  FilterCounters & counters ) override;
+    std::vector<Book *> findMany( const std::vector<std::string_view> & isbns, FilterCounters & counters ) override;
+    bool                contains( const std::string                   & isbn                             ) const override;
+    std::size_t         size    ()                                                                         const override;
+    Records             records ()                                                                               override;
+    std::vector<std::string> isbns()                                                                       const override;
+    Book *              at      ( std::size_t id )                                                                       override;
+
+    Book *           find( std::string_view isbn, FilterCounters & counters );
+    std::size_t      idOf( std::string_view isbn ) const;                       // size() if the ISBN isn't here
+    std::string_view isbn( std::size_t id        ) const;
+    Book             book( std::size_t id        ) const;                       // decompresses the book
+
+    static Records read( const std::string & filename );
+
+    std::string                      _isbns;                                    // every ISBN in ISBN order, back to back
+    std::vector<std::uint32_t>       _isbnOffsets;                              // id's ISBN is _isbns[_isbnOffsets[id], _isbnOffsets[id + 1])
+    StringStore                      _titles;                                   // indexed by id
+    StringStore                      _authors;                                  // indexed by id
+    std::vector<double>              _prices;                                   // indexed by id
+    PerfectHashIndex                 _perfectHash;                              // maps each ISBN to the slot in _ids holding its id.
+    std::vector<std::uint32_t>       _ids;                                      // Empty if two ISBNs' hashes collide, in which case
+                                                                                // ISBNs are binary searched
+    BloomFilter                      _filter;
+    std::vector<std::atomic<Book *>> _books;                                    // indexed by id, nullptr until first looked up
+  };
+
+  struct TreeBase : Base                                                        // Books looked up in a B+tree file through a bounded
+  {                                                                             // page cache, and kept the first time they're looked up
+    TreeBase( const std::string & filename, EpochManager & epochs );
+   ~TreeBase() override;
+
+    Book *              find    ( const std::string                   & isbn,  FilterCounters & counters ) override;
+    std::vector<Book *> findMany( const std::vector<std::string_view> & isbns, FilterCounters & counters ) override;
+    bool                contains( const std::string                   & isbn                             ) const override;
+    std::size_t         size    ()                                                                         const override;
+    Records             records ()                                                                               override;
+    std::vector<std::string> isbns()                                                                       const override;
+    Book *              at      ( std::size_t id )                                                                       override;
+
+    Book * find( std::string_view isbn, FilterCounters & counters );
+
+    static std::string prepared( const std::string & filename );               // Builds the tree file if it isn't current, and
+                                                                                // returns its name
+
+    BookTree                         _tree;
+    std::vector<std::atomic<Book *>> _books;                                    // indexed by id, nullptr until first looked up.
+  };                                                                            // Empty if there's a record cache.
+
+  Catalog( const std::string & filename, EpochManager & epochs );               // Loads all the books in a database file
+  Catalog( const Catalog & previous, const std::vector<BookChange> & changes );  // The previous catalog with changes applied
+
+  Book *              find    ( const std::string                   & isbn,  FilterCounters & counters );
+  std::vector<Book *> findMany( const std::vector<std::string_view> & isbns, FilterCounters & counters );
+
+  std::vector<Book *> findByAuthor    ( const std::string & author );
+  std::vector<Book *> findByPriceRange( double low, double high      );
+  std::vector<Book *> cheapest        ( std::size_t count            );
+  std::vector<Book *> mostExpensive   ( std::size_t count            );
+  std::vector<Book *> searchTitles    ( const std::string & query, std::size_t limit, TitleIndex::Match match );
+  std::vector<Book *> complete        ( const std::string & prefix, std::size_t limit );
+  Book *              resolveIsbn     ( const std::string & isbn, FilterCounters & counters );
+
+  bool contains( const std::string & isbn ) const;
+  void compact();                                                               // Folds the overlay into a new base
+
+  Book *              pinned ( Book * book );                                     // Returns a book looked up outside a Snapshot, pinned
+  std::vector<Book *> pinned ( std::vector<Book *> books );                       // if the record cache could otherwise evict it
+  Book *              visible( std::size_t id );                                 // Returns the base's book with this id, or nullptr
+                                                                                // if the overlay changes or removes it
+  std::vector<Book *> resolve( const std::vector<SecondaryIndexes::Id> & ids );  // Returns the visible books with these ids
+  std::vector<std::string> isbns() const;                                       // Returns every visible ISBN, in order
+  template<typename Predicate, typename Order>
+  void mergeOverlay( std::vector<Book *> & books, Predicate matches, Order before );  // Merges the overlay's books that match into
+                                                                                     // books already in order
+
+  std::shared_ptr<Base> _base;                                                  // Shared by catalogs derived from one another by deltas
+  Overlay               _overlay;                                               // Changes applied since the base was built
+  std::size_t           _size = 0;
+};
+
+
+
+
+// Options hold a std::function so aren't constant initialized.  A function local static is initialized on first use, so options
+// configured by code running during static initialization in other translation units (such as the regression tests) aren't lost.
+BookDatabase::Options & BookDatabase::options()
+{
+  static Options theOptions;
+  return theOptions;
+}
+
+
+
 // Return a reference to the one and only instance of the database
 BookDatabase & BookDatabase::instance()
+{
+  // Initialization of function local statics is thread safe, so the first of several threads to get here loads the database while
+  // the others wait
+  static BookDatabase theInstance( preferredFilename() );
+  return theInstance;
+}
+
+
+
+std::string BookDatabase::preferredFilename()
 {
   std::string filename;
   // Don't forget to #include <filesystem> to get visibility to the exists() function
@@ -23,9 +266,24 @@ BookDatabase & BookDatabase::instance()
   else if( std::filesystem::exists( "Open Library Database-Small.dat"  ) )filename = "Open Library Database-Small.dat";
   else if( std::filesystem::exists( "Sample_Book_Database.dat"         ) )filename = "Sample_Book_Database.dat";
 
+  return filename;
+}
 
-  static BookDatabase theInstance( filename );
-  return theInstance;
+
+
+std::shared_future<void> BookDatabase::loadInBackground()
+{
+  // Loading is nothing more than constructing the one and only instance.  Whoever else calls instance() meanwhile waits for the
+  // construction to finish, as C++ guarantees for function local statics.
+  static const std::shared_future<void> loaded = std::async( std::launch::async, [] { instance(); } ).share();
+  return loaded;
+}
+
+
+
+void BookDatabase::configure( const Options & options )
+{
+  BookDatabase::options() = options;
 }
 
 
@@ -33,6 +291,38 @@ BookDatabase & BookDatabase::instance()
 
 // Construction
 BookDatabase::BookDatabase( const std::string & filename )
+  : _catalog( new Catalog( filename, _epochs ) )
+{}
+
+
+
+BookDatabase::~BookDatabase()
+{
+  delete _catalog.load();
+}
+
+
+
+BookDatabase::Catalog::Catalog( const std::string & filename, EpochManager & epochs )
+{
+  if     ( options().loadLazily      ) _base = std::make_shared<LazyBase   >( filename, epochs );
+  else if( options().diskResident    ) _base = std::make_shared<TreeBase   >( filename, epochs );
+  else if( options().compressStrings ) _base = std::make_shared<CompactBase>( filename );
+  else                                 _base = std::make_shared<EagerBase  >( filename );
+
+  // Indexes are built from pointers to every book, which a record cache would otherwise be free to reclaim as it evicts them.
+  // Otherwise indexes are built on first use, from within a Snapshot's critical section.
+  auto guard = epochs.enter();
+  if( options().buildSecondaryIndexes ) _base->secondaryIndexes();
+  if( options().buildTitleIndex       ) _base->titleIndex();
+  if( options().buildCompletionTrie   ) _base->completionTrie();
+  if( options().buildIsbnResolver     ) _base->isbnResolver();
+  _size = _base->size();
+}
+
+
+
+BookDatabase::Catalog::EagerBase::EagerBase( const std::string & filename )
 {
   std::ifstream fin( filename, std::ios::binary );
 
@@ -63,31 +353,1124 @@ BookDatabase::BookDatabase( const std::string & filename )
 
   /////////////////////// END-TO-DO (2) ////////////////////////////
 
+  buildIndexes();
+
   // Note:  The file is intentionally not explicitly closed.  The file is closed when fin goes out of scope - for whatever
   //        reason.  More precisely, the object named "fin" is destroyed when it goes out of scope and the file is closed in the
   //        destructor. See RAII
 }
 
 
+
+
+void BookDatabase::reload()
+{
+  reload( preferredFilename() );
+}
+
+
+
+void BookDatabase::reload( const std::string & filename )
+{
+  std::lock_guard<std::mutex> lock( _reloadMutex );             // one writer at a time
+
+  // The expensive part, reading and indexing the file, happens before anything is published so readers are never held up by it
+  publish( std::make_unique<Catalog>( filename, _epochs ).release() );
+}
+
+
+
+void BookDatabase::applyDelta( const std::string & filename )
+{
+  std::ifstream           fin( filename, std::ios::binary );
+  std::vector<BookChange> changes;
+
+  BookChange change;
+  while( fin >> change ) changes.push_back( std::move( change ) );
+
+  // Reading stops at the end of the file, or at the first entry that isn't a valid change.  Apply nothing in the latter case.
+  if( !fin.eof() ) throw DeltaFormat_Ex( "Unable to read entry " + std::to_string( changes.size() + 1 ) + " of delta file \"" + filename + '"' );
+
+  applyDelta( changes );
+}
+
+
+
+void BookDatabase::applyDelta( const std::vector<BookChange> & changes )
+{
+  std::lock_guard<std::mutex> lock( _reloadMutex );             // one writer at a time, so the current catalog can't change under us
+
+  publish( std::make_unique<Catalog>( *_catalog.load(), changes ).release() );
+}
+
+
+
+void BookDatabase::publish( Catalog * catalog )
+{
+  // Readers that start from here on see the new catalog, but readers that started earlier may still be using the old one, so wait
+  // for them to finish before freeing it.
+  std::unique_ptr<Catalog> oldCatalog( _catalog.exchange( catalog ) );
+  _epochs.synchronize();
+}                                                               // old catalog freed as oldCatalog goes out of scope
+
+
+
+BookDatabase::Snapshot BookDatabase::snapshot()
+{
+  return Snapshot( *this );
+}
+
+
+
+BookDatabase::Snapshot::Snapshot( BookDatabase & database )
+  : _database( database ),
+    _guard   ( database._epochs.enter() ),
+    _catalog ( database._catalog.load() )
+{}
+
+
+
+BookDatabase::FilterCounters & BookDatabase::filterCounters()
+{
+  return _filterCounters[EpochManager::threadSlot()];
+}
+
+
 ///////////////////////// TO-DO (3) //////////////////////////////
   /// Implement the rest of the interface, including functions find and size
   ///
   /// In function find, don't walk the collection from beginning to end (an O(n) operation), find the item with a binary search (an
   /// O(log n) operation)
 
-Book * BookDatabase::find( const std::string & isbn )
+// Lookups made directly rather than through a Snapshot return once their critical section has ended, so books found through a record
+// cache are pinned (see Catalog::pinned()) for the caller to go on using
+Book *              BookDatabase::find    ( const std::string                   & isbn  ) { auto view = snapshot();  return view._catalog->pinned( view.find    ( isbn  ) ); }
+std::vector<Book *> BookDatabase::findMany( const std::vector<std::string_view> & isbns ) { auto view = snapshot();  return view._catalog->pinned( view.findMany( isbns ) ); }
+
+Book *              BookDatabase::Snapshot::find    ( const std::string                   & isbn  ) const { return _catalog->find    ( isbn,  _database.filterCounters() ); }
+std::vector<Book *> BookDatabase::Snapshot::findMany( const std::vector<std::string_view> & isbns ) const { return _catalog->findMany( isbns, _database.filterCounters() ); }
+std::size_t         BookDatabase::Snapshot::size    ()                                              const { return _catalog->_size;                                        }
+std::vector<std::string> BookDatabase::Snapshot::isbns()                                            const { return _catalog->isbns();                                      }
+
+std::vector<Book *> BookDatabase::findByAuthor    ( const std::string & author   ) { auto view = snapshot();  return view._catalog->pinned( view.findByAuthor    ( author    ) ); }
+std::vector<Book *> BookDatabase::findByPriceRange( double low, double high      ) { auto view = snapshot();  return view._catalog->pinned( view.findByPriceRange( low, high ) ); }
+std::vector<Book *> BookDatabase::cheapest        ( std::size_t count            ) { auto view = snapshot();  return view._catalog->pinned( view.cheapest        ( count     ) ); }
+std::vector<Book *> BookDatabase::mostExpensive   ( std::size_t count            ) { auto view = snapshot();  return view._catalog->pinned( view.mostExpensive   ( count     ) ); }
+
+std::vector<Book *> BookDatabase::Snapshot::findByAuthor    ( const std::string & author   ) const { return _catalog->findByAuthor    ( author    ); }
+std::vector<Book *> BookDatabase::Snapshot::findByPriceRange( double low, double high      ) const { return _catalog->findByPriceRange( low, high ); }
+std::vector<Book *> BookDatabase::Snapshot::cheapest        ( std::size_t count            ) const { return _catalog->cheapest        ( count     ); }
+std::vector<Book *> BookDatabase::Snapshot::mostExpensive   ( std::size_t count            ) const { return _catalog->mostExpensive   ( count     ); }
+
+std::vector<Book *> BookDatabase::searchTitles          ( const std::string & query, std::size_t limit, TitleIndex::Match match )       { auto view = snapshot();  return view._catalog->pinned( view.searchTitles( query, limit, match ) ); }
+std::vector<Book *> BookDatabase::Snapshot::searchTitles( const std::string & query, std::size_t limit, TitleIndex::Match match ) const { return _catalog->searchTitles ( query, limit, match ); }
+
+std::vector<Book *> BookDatabase::complete          ( const std::string & prefix, std::size_t limit )       { auto view = snapshot();  return view._catalog->pinned( view.complete( prefix, limit ) ); }
+std::vector<Book *> BookDatabase::Snapshot::complete( const std::string & prefix, std::size_t limit ) const { return _catalog->complete ( prefix, limit ); }
+
+Book * BookDatabase::resolveIsbn          ( const std::string & isbn )       { auto view = snapshot();  return view._catalog->pinned( view.resolveIsbn( isbn ) ); }
+Book * BookDatabase::Snapshot::resolveIsbn( const std::string & isbn ) const { return _catalog->resolveIsbn ( isbn, _database.filterCounters() ); }
+
+TitleIndex::Footprint BookDatabase::titleIndexFootprint()
+{
+  return snapshot()._catalog->_base->titleIndex().footprint();
+}
+
+
+
+Book * BookDatabase::Catalog::EagerBase::find( const std::string & isbn, FilterCounters & counters )
 {
-  auto it = _data.find( isbn );
+  // Most ISBNs not in the database are turned away after probing a single cache line
+  const auto hash = std::hash<std::string_view>{}( isbn );
+  if( !_filter.mayContain( hash ) )
+  {
+    counters.misses.fetch_add( 1, std::memory_order_relaxed );
+    return nullptr;
+  }
+  counters.hits.fetch_add( 1, std::memory_order_relaxed );
 
-  if( it == _data.end() ) return nullptr;
+  // The ISBN is probed for in the same index, and the same way, as findMany() does, so a single lookup doesn't descend the tree
+  // either.  Full hash values are compared first so records are touched only when they're very likely a match.  With a perfect hash,
+  // the one slot the ISBN maps to holds either its record or, if it's not in the database, some other record, so the probe ends there.
+  for( auto slot = homeSlot( hash ); _index[slot].record != nullptr; slot = nextSlot( slot ) )
+  {
+    if( _index[slot].hash == hash && _index[slot].record->first == isbn ) return &_index[slot].record->second;
+  }
 
-  auto * book_ptr = new Book( it->second );
-  return book_ptr;
+  counters.falsePositives.fetch_add( 1, std::memory_order_relaxed );
+  return nullptr;
 }
 
 std::size_t BookDatabase::size() const
 {
-  return _data.size();
+  auto guard = _epochs.enter();
+  return _catalog.load()->_size;
+}
+
+RecordCache::Statistics BookDatabase::recordCacheStatistics() const
+{
+  auto         guard = _epochs.enter();
+  const auto & cache = _catalog.load()->_base->_recordCache;
+  return cache ? cache->statistics() : RecordCache::Statistics{};
+}
+
+BookDatabase::FilterStatistics BookDatabase::filterStatistics() const
+{
+  FilterStatistics totals;
+  for( const auto & counters : _filterCounters )
+  {
+    totals.hits           += counters.hits          .load( std::memory_order_relaxed );
+    totals.misses         += counters.misses        .load( std::memory_order_relaxed );
+    totals.falsePositives += counters.falsePositives.load( std::memory_order_relaxed );
+  }
+  return totals;
 }
 
 /////////////////////// END-TO-DO (3) ////////////////////////////
+
+
+
+
+BookDatabase::Catalog::EagerBase::EagerBase( Records records )
+  : _data( std::move( records ) )
+{
+  buildIndexes();
+}
+
+
+
+bool                           BookDatabase::Catalog::EagerBase::contains( const std::string & isbn ) const { return _data.count( isbn ) != 0; }
+std::size_t                    BookDatabase::Catalog::EagerBase::size    ()                           const { return _data.size();             }
+BookDatabase::Catalog::Records BookDatabase::Catalog::EagerBase::records ()                                 { return _data;                    }
+Book *                         BookDatabase::Catalog::EagerBase::at      ( std::size_t id )                       { return &_byId[id]->second;       }
+
+
+
+std::vector<std::string> BookDatabase::Catalog::EagerBase::isbns() const
+{
+  std::vector<std::string> isbns;
+  isbns.reserve( _data.size() );
+  for( const auto & [isbn, book] : _data ) isbns.push_back( isbn );
+  return isbns;
+}
+
+
+
+// Build a hash index over the records so batches of lookups can be located, prefetched, and resolved in separate passes, and a
+// Bloom filter over their ISBNs so lookups for books not in the database can be rejected quickly
+void BookDatabase::Catalog::EagerBase::buildIndexes()
+{
+  _filter = BloomFilter( _data.size(), options().bloomFilterFalsePositiveRate );
+  _byId.clear();
+  _byId.reserve( _data.size() );
+
+  std::vector<std::size_t> hashes;
+  hashes.reserve( _data.size() );
+
+  for( auto & record : _data )
+  {
+    _byId  .push_back( &record );
+    hashes.push_back( std::hash<std::string_view>{}( record.first ) );
+    _filter.insert( hashes.back() );
+  }
+
+  // The perfect hash is built from every ISBN's hash value, so can't be built if two ISBNs share one.  That's vanishingly unlikely,
+  // but if it happens the hash table below copes.
+  _perfectHash = {};
+  if( options().perfectHashIndex ) try
+  {
+    _perfectHash = PerfectHashIndex( hashes );
+    _index.assign( _data.size() + 1, IndexSlot{} );
+
+    for( std::size_t id = 0; id < _byId.size(); ++id ) _index[_perfectHash.slot( hashes[id] )] = { hashes[id], _byId[id] };
+    return;
+  }
+  catch( const PerfectHashIndex::DuplicateKey_Ex & ) {}
+
+  std::size_t capacity = 16;
+  while( capacity < 2 * _data.size() ) capacity *= 2;
+
+  _index.assign( capacity, IndexSlot{} );
+  const std::size_t mask = capacity - 1;
+
+  for( std::size_t id = 0; id < _byId.size(); ++id )
+  {
+    auto slot = hashes[id] & mask;
+    while( _index[slot].record != nullptr ) slot = ( slot + 1 ) & mask;     // linear probing
+
+    _index[slot] = { hashes[id], _byId[id] };
+  }
+}
+
+
+
+// Probing a hash table moves on to the next slot, wrapping around, until an empty slot says the hash isn't there.  A perfect hash
+// has only the one slot to probe, so probing moves straight on to the empty slot at the end.
+std::size_t BookDatabase::Catalog::EagerBase::homeSlot( std::size_t hash ) const
+{
+  return _perfectHash.empty() ? hash & ( _index.size() - 1 ) : _perfectHash.slot( hash );
+}
+
+std::size_t BookDatabase::Catalog::EagerBase::nextSlot( std::size_t slot ) const
+{
+  return _perfectHash.empty() ? ( slot + 1 ) & ( _index.size() - 1 ) : _index.size() - 1;
+}
+
+
+
+std::vector<Book *> BookDatabase::Catalog::EagerBase::findMany( const std::vector<std::string_view> & isbns, FilterCounters & counters )
+{
+  std::vector<std::size_t> hashes( isbns.size() );
+  std::vector<std::size_t> slots ( isbns.size() );
+  std::vector<Book *>      results( isbns.size(), nullptr );
+
+  // Pass 1:  Hash every key and prefetch its Bloom filter block
+  for( std::size_t i = 0; i < isbns.size(); ++i )
+  {
+    hashes[i] = std::hash<std::string_view>{}( isbns[i] );
+    prefetch( _filter.blockFor( hashes[i] ) );
+  }
+
+  // Pass 2:  Screen out keys the Bloom filter rules out, and prefetch the home slot of the rest.  Screened out keys are marked with
+  //          an out of range slot so the remaining passes skip them.
+  const std::size_t screenedOut = _index.size();
+  for( std::size_t i = 0; i < isbns.size(); ++i )
+  {
+    if( !_filter.mayContain( hashes[i] ) )
+    {
+      counters.misses.fetch_add( 1, std::memory_order_relaxed );
+      slots[i] = screenedOut;
+      continue;
+    }
+
+    counters.hits.fetch_add( 1, std::memory_order_relaxed );
+    slots[i] = homeSlot( hashes[i] );
+    prefetch( &_index[slots[i]] );
+  }
+
+  // Pass 3:  Probe the (now hopefully cached) slots and prefetch the first candidate record.  Full hash values are compared first so
+  //          the records themselves are touched only when they are very likely a match.
+  for( std::size_t i = 0; i < isbns.size(); ++i )
+  {
+    if( slots[i] == screenedOut ) continue;
+
+    auto slot = slots[i];
+    while( _index[slot].record != nullptr && _index[slot].hash != hashes[i] ) slot = nextSlot( slot );
+
+    slots[i] = slot;
+    if( _index[slot].record != nullptr ) prefetch( _index[slot].record );
+  }
+
+  // Pass 4:  Confirm the candidates by comparing ISBNs, continuing to probe past any (rare) full hash collisions
+  for( std::size_t i = 0; i < isbns.size(); ++i )
+  {
+    if( slots[i] == screenedOut ) continue;
+
+    for( auto slot = slots[i]; _index[slot].record != nullptr; slot = nextSlot( slot ) )
+    {
+      if( _index[slot].hash == hashes[i] && _index[slot].record->first == isbns[i] )
+      {
+        results[i] = &_index[slot].record->second;
+        break;
+      }
+    }
+
+    if( results[i] == nullptr ) counters.falsePositives.fetch_add( 1, std::memory_order_relaxed );
+  }
+
+  return results;
+}
+
+
+
+
+
+
+
+BookDatabase::Catalog::Catalog( const Catalog & previous, const std::vector<BookChange> & changes )
+  : _base( previous._base ), _overlay( previous._overlay ), _size( previous._size )
+{
+  for( const auto & change : changes )
+  {
+    auto       isbn       = change.book.isbn();
+    const bool wasPresent = contains( isbn );
+
+    if( change.operation == BookChange::Operation::REMOVE )
+    {
+      if( !wasPresent ) continue;
+
+      --_size;
+      if( !_base->contains( isbn ) ) _overlay.erase( isbn );                // added by an earlier delta, nothing to hide
+      else                                  _overlay.insert_or_assign( std::move( isbn ), std::nullopt );
+    }
+    else
+    {
+      if( !wasPresent ) ++_size;
+      _overlay.insert_or_assign( std::move( isbn ), change.book );
+    }
+  }
+
+  // Every lookup pays to search the overlay, so once it grows large relative to the base it is cheaper to start over.  Doing so
+  // costs about as much as a full load, but happens only once every several deltas.  Neither a disk resident nor a lazily loaded base
+  // is ever compacted, since that would parse every book and bring it into memory, the very cost they're chosen to avoid.
+  if( dynamic_cast<TreeBase *>( _base.get() ) == nullptr
+   && dynamic_cast<LazyBase *>( _base.get() ) == nullptr
+   && _overlay.size() > options().deltaCompactionRatio * static_cast<double>( _base->size() ) ) compact();
+}
+
+
+
+bool BookDatabase::Catalog::contains( const std::string & isbn ) const
+{
+  if( auto it = _overlay.find( isbn ); it != _overlay.end() ) return it->second.has_value();
+  return _base->contains( isbn );
+}
+
+
+
+std::vector<std::string> BookDatabase::Catalog::isbns() const
+{
+  auto isbns = _base->isbns();
+  if( _overlay.empty() ) return isbns;
+
+  // Both are in ISBN order, so the overlay's changes are merged in:  books it adds are inserted, and books it removes left out
+  std::vector<std::string> visible;
+  visible.reserve( _size );
+  auto change = _overlay.cbegin();
+  for( auto & isbn : isbns )
+  {
+    for( ; change != _overlay.cend() && change->first < isbn; ++change ) if( change->second ) visible.push_back( change->first );
+
+    if( change == _overlay.cend() || change->first != isbn ) visible.push_back( std::move( isbn ) );
+    else
+    {
+      if( change->second ) visible.push_back( std::move( isbn ) );         // changed rather than removed
+      ++change;
+    }
+  }
+  for( ; change != _overlay.cend(); ++change ) if( change->second ) visible.push_back( change->first );
+
+  return visible;
+}
+
+
+
+void BookDatabase::Catalog::compact()
+{
+  Records data = _base->records();
+  for( auto & [isbn, book] : _overlay )
+  {
+    if( book ) data.insert_or_assign( isbn, *book );
+    else       data.erase( isbn );
+  }
+
+  if( options().compressStrings ) _base = std::make_shared<CompactBase>( data );
+  else                            _base = std::make_shared<EagerBase  >( std::move( data ) );
+  _overlay.clear();
+
+  if( options().buildSecondaryIndexes ) _base->secondaryIndexes();
+  if( options().buildTitleIndex       ) _base->titleIndex();
+  if( options().buildCompletionTrie   ) _base->completionTrie();
+  if( options().buildIsbnResolver     ) _base->isbnResolver();
+}
+
+
+
+Book * BookDatabase::Catalog::find( const std::string & isbn, FilterCounters & counters )
+{
+  if( !_overlay.empty() )
+  {
+    if( auto it = _overlay.find( isbn ); it != _overlay.end() ) return it->second ? &*it->second : nullptr;
+  }
+
+  return _base->find( isbn, counters );
+}
+
+
+
+Book * BookDatabase::Catalog::pinned( Book * book )
+{
+  // Books in the overlay, and those of a base without a record cache, are kept for as long as the catalog is.  Books held by a record
+  // cache are copied, as a base without one would have kept them, so the copy is as long lived.
+  if( book == nullptr || !_base->_recordCache || _overlay.find( book->isbn() ) != _overlay.end() ) return book;
+  return _base->pin( *book );
+}
+
+
+
+std::vector<Book *> BookDatabase::Catalog::pinned( std::vector<Book *> books )
+{
+  for( auto & book : books ) book = pinned( book );
+  return books;
+}
+
+
+
+Book * BookDatabase::Catalog::Base::pin( const Book & book )
+{
+  std::lock_guard lock( _pinnedMutex );
+
+  auto & pinned = _pinned[book.isbn()];
+  if( pinned == nullptr ) pinned = std::make_unique<Book>( book );
+  return pinned.get();
+}
+
+
+
+std::vector<Book *> BookDatabase::Catalog::findMany( const std::vector<std::string_view> & isbns, FilterCounters & counters )
+{
+  auto results = _base->findMany( isbns, counters );
+
+  if( !_overlay.empty() )
+  {
+    for( std::size_t i = 0; i < isbns.size(); ++i )
+    {
+      if( auto it = _overlay.find( isbns[i] ); it != _overlay.end() ) results[i] = it->second ? &*it->second : nullptr;
+    }
+  }
+
+  return results;
+}
+
+
+
+
+
+
+
+BookDatabase::Catalog::LazyBase::LazyBase( const std::string & filename, EpochManager & epochs )
+  : _index ( filename, options().saveLazyIndexFile ),
+    _filter( _index.size(), options().bloomFilterFalsePositiveRate )
+{
+  for( std::size_t i = 0; i < _index.size(); ++i ) _filter.insert( _index.isbn( i ) );
+
+  if( options().recordCacheBytes > 0 ) _recordCache = std::make_unique<RecordCache>( [this]( std::size_t id ) { return _index.read( id ); }, options().recordCacheBytes, epochs );
+}
+
+
+
+Book * BookDatabase::Catalog::LazyBase::find( const std::string & isbn, FilterCounters & counters )
+{
+  return find( std::string_view( isbn ), counters );
+}
+
+
+
+Book * BookDatabase::Catalog::LazyBase::find( std::string_view isbn, FilterCounters & counters )
+{
+  if( !_filter.mayContain( isbn ) )
+  {
+    counters.misses.fetch_add( 1, std::memory_order_relaxed );
+    return nullptr;
+  }
+  counters.hits.fetch_add( 1, std::memory_order_relaxed );
+
+  auto position = _index.indexOf( isbn );
+
+  if( position == _index.size() )
+  {
+    counters.falsePositives.fetch_add( 1, std::memory_order_relaxed );
+    return nullptr;
+  }
+
+  return at( position );
+}
+
+
+
+std::vector<Book *> BookDatabase::Catalog::LazyBase::findMany( const std::vector<std::string_view> & isbns, FilterCounters & counters )
+{
+  // Parsing a book on first access costs far more than the cache misses prefetching would hide, so simply look up each in turn
+  std::vector<Book *> results;
+  results.reserve( isbns.size() );
+  for( auto isbn : isbns ) results.push_back( find( isbn, counters ) );
+
+  return results;
+}
+
+
+
+bool        BookDatabase::Catalog::LazyBase::contains( const std::string & isbn ) const { return _index.indexOf( isbn ) != _index.size(); }
+std::size_t BookDatabase::Catalog::LazyBase::size    ()                           const { return _index.size();                           }
+Book *      BookDatabase::Catalog::LazyBase::at      ( std::size_t id )                 { return _recordCache ? _recordCache->find( id ) : _index.at( id ); }
+
+
+
+BookDatabase::Catalog::Records BookDatabase::Catalog::LazyBase::records()
+{
+  // With a record cache, books are parsed for the copy only, rather than churning the cache
+  Records data;
+  for( std::size_t i = 0; i < _index.size(); ++i )
+  {
+    if( _recordCache )
+    {
+      if( auto book = _index.read( i ) ) data.emplace_hint( data.end(), _index.isbn( i ), *book );
+    }
+    else if( auto book = _index.at( i ); book != nullptr ) data.emplace_hint( data.end(), _index.isbn( i ), *book );
+  }
+
+  return data;
+}
+
+
+
+std::vector<std::string> BookDatabase::Catalog::LazyBase::isbns() const
+{
+  std::vector<std::string> isbns;
+  isbns.reserve( _index.size() );
+  for( std::size_t i = 0; i < _index.size(); ++i ) isbns.emplace_back( _index.isbn( i ) );
+  return isbns;
+}
+
+
+
+
+
+
+
+BookDatabase::Catalog::CompactBase::CompactBase( const std::string & filename )
+  : CompactBase( read( filename ) )
+{}
+
+
+
+BookDatabase::Catalog::Records BookDatabase::Catalog::CompactBase::read( const std::string & filename )
+{
+  // Read exactly as EagerBase does.  The books are compressed once all are read, so they can be compressed with what's common to all.
+  std::ifstream fin( filename, std::ios::binary );
+
+  Records records;
+  Book    book;
+  while( fin >> book ) records[book.isbn()] = book;
+
+  return records;
+}
+
+
+
+BookDatabase::Catalog::CompactBase::CompactBase( const Records & records )
+  : _filter( records.size(), options().bloomFilterFalsePositiveRate ),
+    _books ( records.size() )
+{
+  std::vector<std::string> titles, authors;
+  std::vector<std::size_t> hashes;
+  titles .reserve( records.size() );
+  authors.reserve( records.size() );
+  hashes .reserve( records.size() );
+  _prices.reserve( records.size() );
+
+  _isbnOffsets.reserve( records.size() + 1 );
+  _isbnOffsets.push_back( 0 );
+
+  for( const auto & [isbn, book] : records )
+  {
+    _isbns += isbn;
+    _isbnOffsets.push_back( static_cast<std::uint32_t>( _isbns.size() ) );
+
+    titles .push_back( book.title()  );
+    authors.push_back( book.author() );
+    _prices.push_back( book.price()  );
+
+    hashes.push_back( std::hash<std::string_view>{}( isbn ) );
+    _filter.insert( hashes.back() );
+  }
+
+  _titles  = StringStore( { titles .begin(), titles .end() } );
+  _authors = StringStore( { authors.begin(), authors.end() } );
+
+  try
+  {
+    _perfectHash = PerfectHashIndex( hashes );
+    _ids.resize( hashes.size() );
+    for( std::size_t id = 0; id < hashes.size(); ++id ) _ids[_perfectHash.slot( hashes[id] )] = static_cast<std::uint32_t>( id );
+  }
+  catch( const PerfectHashIndex::DuplicateKey_Ex & )
+  {
+    _perfectHash = {};
+  }
+}
+
+
+
+BookDatabase::Catalog::CompactBase::~CompactBase()
+{
+  for( auto & book : _books ) delete book.load();
+}
+
+
+
+Book * BookDatabase::Catalog::CompactBase::find( const std::string & isbn, FilterCounters & counters )
+{
+  return find( std::string_view( isbn ), counters );
+}
+
+
+
+Book * BookDatabase::Catalog::CompactBase::find( std::string_view isbn, FilterCounters & counters )
+{
+  if( !_filter.mayContain( isbn ) )
+  {
+    counters.misses.fetch_add( 1, std::memory_order_relaxed );
+    return nullptr;
+  }
+  counters.hits.fetch_add( 1, std::memory_order_relaxed );
+
+  auto id = idOf( isbn );
+
+  if( id == size() )
+  {
+    counters.falsePositives.fetch_add( 1, std::memory_order_relaxed );
+    return nullptr;
+  }
+
+  return at( id );
+}
+
+
+
+std::vector<Book *> BookDatabase::Catalog::CompactBase::findMany( const std::vector<std::string_view> & isbns, FilterCounters & counters )
+{
+  std::vector<Book *> results;
+  results.reserve( isbns.size() );
+  for( auto isbn : isbns ) results.push_back( find( isbn, counters ) );
+
+  return results;
+}
+
+
+
+std::size_t BookDatabase::Catalog::CompactBase::idOf( std::string_view isbn ) const
+{
+  if( !_perfectHash.empty() )
+  {
+    const auto id = _ids[_perfectHash.slot( std::hash<std::string_view>{}( isbn ) )];
+    return this->isbn( id ) == isbn ? id : size();
+  }
+
+  // Ids are in ISBN order
+  std::size_t low = 0, high = size();
+  while( low < high )
+  {
+    const auto middle = low + ( high - low ) / 2;
+    if( this->isbn( middle ) < isbn ) low  = middle + 1;
+    else                              high = middle;
+  }
+
+  return low < size() && this->isbn( low ) == isbn ? low : size();
+}
+
+
+
+std::string_view BookDatabase::Catalog::CompactBase::isbn( std::size_t id ) const
+{
+  return std::string_view( _isbns ).substr( _isbnOffsets[id], _isbnOffsets[id + 1] - _isbnOffsets[id] );
+}
+
+
+
+// The buffers are reused from one book to the next, so decompressing allocates only for the book itself
+Book BookDatabase::Catalog::CompactBase::book( std::size_t id ) const
+{
+  thread_local std::string titleBuffer, authorBuffer;
+  return Book( _titles.decode( id, titleBuffer ), _authors.decode( id, authorBuffer ), isbn( id ), _prices[id] );
+}
+
+
+
+Book * BookDatabase::Catalog::CompactBase::at( std::size_t id )
+{
+  if( auto book = _books[id].load( std::memory_order_acquire ); book != nullptr ) return book;
+
+  // First access, decompress the book.  As in BookFileIndex::at(), racing threads all decompress it but only the first publishes.
+  auto   decompressed = new Book( book( id ) );
+  Book * expected     = nullptr;
+  if( _books[id].compare_exchange_strong( expected, decompressed, std::memory_order_acq_rel ) ) return decompressed;
+
+  delete decompressed;
+  return expected;
+}
+
+
+
+bool        BookDatabase::Catalog::CompactBase::contains( const std::string & isbn ) const { return idOf( isbn ) != size(); }
+std::size_t BookDatabase::Catalog::CompactBase::size    ()                           const { return _prices.size();       }
+
+
+
+BookDatabase::Catalog::Records BookDatabase::Catalog::CompactBase::records()
+{
+  // Books not yet looked up are decompressed for the copy only, rather than kept
+  Records data;
+  for( std::size_t id = 0; id < size(); ++id ) data.emplace_hint( data.end(), isbn( id ), book( id ) );
+
+  return data;
+}
+
+
+
+std::vector<std::string> BookDatabase::Catalog::CompactBase::isbns() const
+{
+  std::vector<std::string> isbns;
+  isbns.reserve( size() );
+  for( std::size_t id = 0; id < size(); ++id ) isbns.emplace_back( isbn( id ) );
+  return isbns;
+}
+
+
+
+
+
+
+
+BookDatabase::Catalog::TreeBase::TreeBase( const std::string & filename, EpochManager & epochs )
+  : _tree ( prepared( filename ), options().pageCachePages ),
+    _books( options().recordCacheBytes > 0 ? 0 : _tree.size() )
+{
+  if( options().recordCacheBytes > 0 ) _recordCache = std::make_unique<RecordCache>( [this]( std::size_t id ) { return _tree.at( id ); }, options().recordCacheBytes, epochs );
+}
+
+
+
+std::string BookDatabase::Catalog::TreeBase::prepared( const std::string & filename )
+{
+  if( !BookTree::isCurrent( filename ) ) BookTree::build( filename );
+  return BookTree::treeFilename( filename );
+}
+
+
+
+BookDatabase::Catalog::TreeBase::~TreeBase()
+{
+  for( auto & book : _books ) delete book.load();
+}
+
+
+
+Book * BookDatabase::Catalog::TreeBase::find( const std::string & isbn, FilterCounters & counters )
+{
+  return find( std::string_view( isbn ), counters );
+}
+
+
+
+Book * BookDatabase::Catalog::TreeBase::find( std::string_view isbn, FilterCounters & counters )
+{
+  // There's no Bloom filter to screen lookups, every one searches the tree
+  counters.hits.fetch_add( 1, std::memory_order_relaxed );
+
+  const auto id = _tree.idOf( isbn );
+  if( id == size() )
+  {
+    counters.falsePositives.fetch_add( 1, std::memory_order_relaxed );
+    return nullptr;
+  }
+
+  return at( id );
+}
+
+
+
+std::vector<Book *> BookDatabase::Catalog::TreeBase::findMany( const std::vector<std::string_view> & isbns, FilterCounters & counters )
+{
+  std::vector<Book *> results;
+  results.reserve( isbns.size() );
+  for( auto isbn : isbns ) results.push_back( find( isbn, counters ) );
+
+  return results;
+}
+
+
+
+Book * BookDatabase::Catalog::TreeBase::at( std::size_t id )
+{
+  if( _recordCache ) return _recordCache->find( id );
+
+  if( auto book = _books[id].load( std::memory_order_acquire ); book != nullptr ) return book;
+
+  // First access, read the book from the tree.  As in BookFileIndex::at(), racing threads all read it but only the first publishes.
+  auto   read     = new Book( _tree.at( id ).value() );
+  Book * expected = nullptr;
+  if( _books[id].compare_exchange_strong( expected, read, std::memory_order_acq_rel ) ) return read;
+
+  delete read;
+  return expected;
+}
+
+
+
+bool        BookDatabase::Catalog::TreeBase::contains( const std::string & isbn ) const { return _tree.idOf( isbn ) != size(); }
+std::size_t BookDatabase::Catalog::TreeBase::size    ()                           const { return _tree.size();                }
+
+
+
+BookDatabase::Catalog::Records BookDatabase::Catalog::TreeBase::records()
+{
+  // Books not yet looked up are read for the copy only, rather than kept
+  Records data;
+  for( std::size_t id = 0; id < size(); ++id )
+  {
+    if( auto book = id < _books.size() ? _books[id].load( std::memory_order_acquire ) : nullptr; book != nullptr ) data.emplace_hint( data.end(), book->isbn(), *book );
+    else if( auto read = _tree.at( id ) )                                             data.emplace_hint( data.end(), read->isbn(), *read );
+  }
+
+  return data;
+}
+
+
+
+std::vector<std::string> BookDatabase::Catalog::TreeBase::isbns() const
+{
+  return _tree.isbns();
+}
+
+
+
+
+
+
+
+// Secondary indexes.  With a lazy base, building them parses every book, with a compact base, decompresses every book, and with a
+// disk resident base, reads every book from the tree.
+const SecondaryIndexes & BookDatabase::Catalog::Base::secondaryIndexes()
+{
+  std::call_once( _secondaryIndexesBuilt, [this] { _secondaryIndexes = std::make_unique<SecondaryIndexes>( books() ); } );
+  return *_secondaryIndexes;
+}
+
+
+
+const TitleIndex & BookDatabase::Catalog::Base::titleIndex()
+{
+  std::call_once( _titleIndexBuilt, [this] { _titleIndex = std::make_unique<TitleIndex>( books() ); } );
+  return *_titleIndex;
+}
+
+
+
+const CompletionTrie & BookDatabase::Catalog::Base::completionTrie()
+{
+  std::call_once( _completionTrieBuilt, [this] { _completionTrie = std::make_unique<CompletionTrie>( books(), options().completionScore, options().completionsPerPrefix ); } );
+  return *_completionTrie;
+}
+
+
+
+const IsbnResolver & BookDatabase::Catalog::Base::isbnResolver()
+{
+  std::call_once( _isbnResolverBuilt, [this]
+  {
+    std::vector<std::string> isbns;
+    for( auto book : books() ) isbns.push_back( book->isbn() );
+    _isbnResolver = std::make_unique<IsbnResolver>( isbns );
+  } );
+  return *_isbnResolver;
+}
+
+
+
+std::vector<const Book *> BookDatabase::Catalog::Base::books()
+{
+  std::vector<const Book *> books( size() );
+  for( std::size_t id = 0; id < books.size(); ++id ) books[id] = at( id );
+
+  return books;
+}
+
+
+
+Book * BookDatabase::Catalog::visible( std::size_t id )
+{
+  auto book = _base->at( id );
+  if( book != nullptr && !_overlay.empty() && _overlay.find( book->isbn() ) != _overlay.end() ) return nullptr;   // superseded by a delta
+
+  return book;
+}
+
+
+
+std::vector<Book *> BookDatabase::Catalog::resolve( const std::vector<SecondaryIndexes::Id> & ids )
+{
+  std::vector<Book *> books;
+  books.reserve( ids.size() );
+
+  for( auto id : ids )
+  {
+    if( auto book = visible( id ); book != nullptr ) books.push_back( book );
+  }
+
+  return books;
+}
+
+
+
+template<typename Predicate, typename Order>
+void BookDatabase::Catalog::mergeOverlay( std::vector<Book *> & books, Predicate matches, Order before )
+{
+  const auto middle = books.size();
+  for( auto & [isbn, book] : _overlay )
+  {
+    if( book && matches( *book ) ) books.push_back( &*book );
+  }
+
+  std::stable_sort  ( books.begin() + static_cast<std::ptrdiff_t>( middle ), books.end(), before );
+  std::inplace_merge( books.begin(), books.begin() + static_cast<std::ptrdiff_t>( middle ), books.end(), before );
+}
+
+
+
+namespace  // anonymous
+{
+  bool byIsbn           ( const Book * lhs, const Book * rhs ) { return lhs->isbn()  < rhs->isbn();  }
+  bool byPrice          ( const Book * lhs, const Book * rhs ) { return lhs->price() < rhs->price(); }
+  bool byPriceDescending( const Book * lhs, const Book * rhs ) { return lhs->price() > rhs->price(); }
+}
+
+
+
+std::vector<Book *> BookDatabase::Catalog::findByAuthor( const std::string & author )
+{
+  auto books = resolve( _base->secondaryIndexes().byAuthor( author ) );
+  mergeOverlay( books, [&]( const Book & book ) { return book.author() == author; }, byIsbn );
+  return books;
+}
+
+
+
+std::vector<Book *> BookDatabase::Catalog::findByPriceRange( double low, double high )
+{
+  auto books = resolve( _base->secondaryIndexes().byPriceRange( low, high ) );
+  mergeOverlay( books, [&]( const Book & book ) { return low <= book.price() && book.price() <= high; }, byPrice );
+  return books;
+}
+
+
+
+// Each book in the overlay may hide one of the base's books, so ask the base for that many more than needed
+std::vector<Book *> BookDatabase::Catalog::cheapest( std::size_t count )
+{
+  auto books = resolve( _base->secondaryIndexes().cheapest( count + _overlay.size() ) );
+  mergeOverlay( books, []( const Book & ) { return true; }, byPrice );
+  if( books.size() > count ) books.resize( count );
+  return books;
+}
+
+
+
+std::vector<Book *> BookDatabase::Catalog::mostExpensive( std::size_t count )
+{
+  auto books = resolve( _base->secondaryIndexes().mostExpensive( count + _overlay.size() ) );
+  mergeOverlay( books, []( const Book & ) { return true; }, byPriceDescending );
+  if( books.size() > count ) books.resize( count );
+  return books;
+}
+
+
+
+std::vector<Book *> BookDatabase::Catalog::searchTitles( const std::string & query, std::size_t limit, TitleIndex::Match match )
+{
+  std::vector<std::pair<std::uint32_t /*score*/, Book *>> hits;
+  for( const auto & hit : _base->titleIndex().search( query, match, limit + _overlay.size() ) )
+  {
+    if( auto book = visible( hit.id ); book != nullptr ) hits.emplace_back( hit.score, book );
+  }
+
+  // Books changed or added by deltas aren't in the base's index, so match their titles directly and fit them in among the hits
+  if( !_overlay.empty() )
+  {
+    const auto terms = TitleIndex::tokenize( query );
+    for( auto & [isbn, book] : _overlay )
+    {
+      if( !book ) continue;
+
+      const auto tokens = TitleIndex::tokenize( book->title() );
+      const auto score  = static_cast<std::uint32_t>( std::count_if( terms.begin(), terms.end(), [&]( const std::string & term )
+                                                                     { return std::find( tokens.begin(), tokens.end(), term ) != tokens.end(); } ) );
+
+      if( match == TitleIndex::Match::ALL_TERMS ? score == terms.size() : score > 0 ) hits.emplace_back( score, &*book );
+    }
+
+    std::sort( hits.begin(), hits.end(), []( const auto & lhs, const auto & rhs )
+               { return lhs.first != rhs.first ? lhs.first > rhs.first : lhs.second->isbn() < rhs.second->isbn(); } );
+  }
+
+  std::vector<Book *> books;
+  for( std::size_t i = 0; i < hits.size() && i < limit; ++i ) books.push_back( hits[i].second );
+
+  return books;
+}
+
+
+
+std::vector<Book *> BookDatabase::Catalog::complete( const std::string & prefix, std::size_t limit )
+{
+  const auto & trie = _base->completionTrie();
+
+  std::vector<std::pair<double /*score*/, Book *>> hits;
+  for( auto id : trie.complete( prefix, limit + _overlay.size() ) )
+  {
+    if( auto book = visible( id ); book != nullptr ) hits.emplace_back( trie.score( id ), book );
+  }
+
+  // Books changed or added by deltas aren't in the base's trie, so check their titles and ISBNs directly and rank them among the hits
+  if( !_overlay.empty() )
+  {
+    for( auto & [isbn, book] : _overlay )
+    {
+      if( book && ( CompletionTrie::completes( prefix, book->title() ) || CompletionTrie::completes( prefix, isbn ) ) ) hits.emplace_back( trie.score( *book ), &*book );
+    }
+
+    std::sort( hits.begin(), hits.end(), []( const auto & lhs, const auto & rhs )
+               { return lhs.first > rhs.first || ( !( rhs.first > lhs.first ) && lhs.second->isbn() < rhs.second->isbn() ); } );
+  }
+
+  std::vector<Book *> books;
+  for( std::size_t i = 0; i < hits.size() && i < limit; ++i ) books.push_back( hits[i].second );
+
+  return books;
+}
+
+
+
+Book * BookDatabase::Catalog::resolveIsbn( const std::string & isbn, FilterCounters & counters )
+{
+  std::vector<Book *> found;
+  auto lookUp = [&]( const std::string & candidate )
+  {
+    if( auto book = find( candidate, counters ); book != nullptr && std::find( found.begin(), found.end(), book ) == found.end() ) found.push_back( book );
+  };
+
+  // The ISBN as written, tidied up, or in its other form
+  const auto key = IsbnResolver::normalize( isbn );
+  lookUp( key );
+  if( auto other = IsbnResolver::convert( key ) ) lookUp( *other );
+  if( !found.empty() ) return found.front();
+
+  // A mistyped or swapped digit, caught by the check digit
+  for( const auto & correction : IsbnResolver::corrections( key ) )
+  {
+    lookUp( correction );
+    if( auto other = IsbnResolver::convert( correction ) ) lookUp( *other );
+  }
+  if( !found.empty() ) return found.size() == 1 ? found.front() : nullptr;
+
+  // Anything else one edit away, including ISBNs without valid check digits.  Books changed by deltas aren't in the base's resolver,
+  // so compare with them directly.
+  auto nearest = _base->isbnResolver().nearest( key, 1, options().isbnResolutionBudget );
+  if( !nearest.complete ) return nullptr;
+
+  for( auto id : nearest.ids )
+  {
+    if( auto book = visible( id ); book != nullptr ) found.push_back( book );
+  }
+
+  for( auto & [overlayIsbn, book] : _overlay )
+  {
+    if( !book ) continue;
+
+    const auto distance = IsbnResolver::distance( key, overlayIsbn );
+    if( distance < nearest.distance ) { found.clear(); nearest.distance = distance; }
+    if( distance == nearest.distance ) found.push_back( &*book );
+  }
+
+  return found.size() == 1 ? found.front() : nullptr;
+}
@@ -1,31 +1,214 @@
 #pragma once
 
+#include <array>
+#include <atomic>
 #include <cstddef>   // size_t
+#include <future>    // shared_future
+#include <mutex>
+#include <stdexcept>
 #include <string>
-#include <map>
+#include <string_view>
+#include <vector>
 
 #include "Book.hpp"
+#include "BookChange.hpp"
+#include "BookTree.hpp"
+#include "CompletionTrie.hpp"
+#include "EpochManager.hpp"
+#include "IsbnResolver.hpp"
+#include "RecordCache.hpp"
+#include "TitleIndex.hpp"
 
 
 
 // Singleton Design Pattern
+//
+// Thread safety:  Any number of threads may look up books at the same time, including while another thread reloads the database
+// from a (possibly different) file or applying a delta to it.  A reload builds a complete new catalog off to the side while lookups continue against the
+// current one, then publishes the new catalog in a single atomic step.  The old catalog is freed once every reader that might still
+// be using it has finished.  Readers never take a lock.
+//
+// Pointers to books obtained through a Snapshot remain valid for the lifetime of that Snapshot.  Pointers obtained directly from
+// BookDatabase::find() and BookDatabase::findMany() remain valid only until the next reload, so code that may run concurrently with
+// a reload should look up books through a Snapshot.  If Options::recordCacheBytes is set, each book obtained directly is a copy of
+// the record cache's, kept until the next reload so other threads' lookups can't evict it out from under the caller.  Looking books
+// up through a Snapshot instead keeps memory use within the cache's budget.
 class BookDatabase
 {
+  struct Catalog;                                                               // An immutable, fully indexed set of books
+
   public:
+    // Types
+    struct DeltaFormat_Ex : std::runtime_error { using runtime_error::runtime_error; };  // Thrown if a delta file can't be read
+
+    struct Options                                                              // Tuning knobs applied each time the database is loaded
+    {
+      double bloomFilterFalsePositiveRate = 0.01;                               // Fraction of lookups for missing ISBNs that get past
+                                                                                // the Bloom filter to the index
+      double deltaCompactionRatio         = 0.125;                              // Once the changes applied by deltas number this
+                                                                                // fraction of the books loaded, they are folded into
+                                                                                // a freshly indexed catalog.  Ignored if loading
+                                                                                // lazily or disk resident.
+      bool   perfectHashIndex             = false;                              // Index ISBNs with a minimal perfect hash (see
+                                                                                // PerfectHashIndex.hpp) rather than a hash table.
+                                                                                // Slower to build, but smaller, and every lookup
+                                                                                // probes exactly one slot.  Ignored if loading lazily
+                                                                                // or disk resident.
+      bool   compressStrings              = false;                              // Hold titles and authors compressed (see
+                                                                                // StringStore.hpp), and build each book the first
+                                                                                // time it's looked up.  Several times smaller until
+                                                                                // most books have been looked up.  Ignored if loading
+                                                                                // lazily or disk resident.
+      bool   loadLazily                   = false;                              // Index only where each book's record is in the
+                                                                                // file, and parse each book the first time it's
+                                                                                // looked up.  Much faster to load and much smaller
+                                                                                // when only a few books are looked up.
+      bool   diskResident                 = false;                              // Look books up in a B+tree file built next to the
+                                                                                // database file (see BookTree.hpp), rebuilt only if
+                                                                                // the database file changes, holding at most
+                                                                                // pageCachePages pages of it in memory.  Ignored if
+                                                                                // loading lazily.
+      std::size_t            pageCachePages       = BookTree::DEFAULT_CACHE_PAGES;
+                                                                                // Pages of the B+tree file held in memory, each
+                                                                                // BookTree::PAGE_SIZE bytes, and no fewer than
+                                                                                // BookTree::CACHE_SHARDS
+      std::size_t            recordCacheBytes     = 0;                          // If loading lazily or disk resident, hold the books
+                                                                                // looked up in a cache of about this many bytes (see
+                                                                                // RecordCache.hpp), evicting the least recently used
+                                                                                // as needed.  If 0, every book looked up is kept.
+      bool   saveLazyIndexFile            = false;                              // Save the lazy index next to the database file
+                                                                                // (see BookFileIndex) so the next lazy load need
+                                                                                // not scan the file
+      bool   buildSecondaryIndexes        = false;                              // Build the author and price indexes while loading
+                                                                                // rather than on the first query that needs them
+      bool   buildTitleIndex              = false;                              // Likewise for the title index
+      bool   buildCompletionTrie          = false;                              // Likewise for the completion trie
+      std::size_t            completionsPerPrefix = CompletionTrie::DEFAULT_RESULTS_PER_NODE;
+                                                                                // Completions precomputed for each prefix.  Asking
+                                                                                // for more than this many is slower.
+      CompletionTrie::Scorer completionScore;                                   // Ranks completions, highest first.  By price if
+                                                                                // empty.
+      bool   buildIsbnResolver            = false;                              // Build the mistyped ISBN resolver while loading
+                                                                                // rather than on first use
+      std::size_t            isbnResolutionBudget = IsbnResolver::DEFAULT_COMPARISON_BUDGET;
+                                                                                // Most ISBNs compared when resolving by edit distance,
+                                                                                // which bounds how long resolving can take
+    };
+
+    struct FilterStatistics
+    {
+      std::size_t hits           = 0;                                           // Lookups the Bloom filter passed on to the index
+      std::size_t misses         = 0;                                           // Lookups the Bloom filter rejected outright
+      std::size_t falsePositives = 0;                                           // Hits not found in the index after all
+    };
+
+    class Snapshot                                                              // Pins the catalog current at construction until
+    {                                                                           // destruction.  Intended to be short lived.
+      public:
+        Book *              find    ( const std::string                   & isbn  ) const;
+        std::vector<Book *> findMany( const std::vector<std::string_view> & isbns ) const;
+        std::size_t         size    ()                                              const;
+        std::vector<std::string> isbns()                                            const;  // Every ISBN, in order, building no book
+
+        std::vector<Book *> findByAuthor    ( const std::string & author   ) const;
+        std::vector<Book *> findByPriceRange( double low, double high      ) const;
+        std::vector<Book *> cheapest        ( std::size_t count            ) const;
+        std::vector<Book *> mostExpensive   ( std::size_t count            ) const;
+        std::vector<Book *> searchTitles    ( const std::string & query, std::size_t limit = 10, TitleIndex::Match match = TitleIndex::Match::ALL_TERMS ) const;
+        std::vector<Book *> complete        ( const std::string & prefix, std::size_t limit = 10 ) const;
+        Book *              resolveIsbn     ( const std::string & isbn     ) const;
+
+      private:
+        friend class BookDatabase;
+        Snapshot( BookDatabase & database );
+
+        BookDatabase &          _database;
+        EpochManager::ReadGuard _guard;                                         // must be entered before the catalog is loaded
+        Catalog *               _catalog;
+    };
+
+
     // Get a reference to the one and only instance of the database
     static BookDatabase & instance();
+    static void           configure( const Options & options );                 // Must be called before the first call to instance()
+                                                                                // to affect the initial load
+
+    // Begin loading the database on a background thread and return at once, so the caller can get on with other work meanwhile.
+    // The future becomes ready once the database is loaded, and rethrows anything loading threw.  Until then, instance() (and so
+    // every lookup) waits for the load to complete.  Calling this after the database is loaded, or more than once, is harmless.
+    static std::shared_future<void> loadInBackground();
 
     // Locate and return a reference to a particular record
     Book * find( const std::string & isbn );                                    // Returns a pointer to the item in the database if
                                                                                 // found, nullptr otherwise
+
+    // Locate a batch of records at once, such as all the books in a shopping cart.  All the keys are hashed and their index entries
+    // prefetched before any are resolved, so the cache misses of one lookup overlap with those of the others.
+    std::vector<Book *> findMany( const std::vector<std::string_view> & isbns );  // Returns pointers to the items in the same order as
+                                                                                // the ISBNs given, nullptr for those not found
+    // Locate records by something other than ISBN using the secondary indexes (see SecondaryIndexes.hpp).  The indexes are built on
+    // the first such query, or while loading if Options::buildSecondaryIndexes is set, and reflect deltas applied since.
+    std::vector<Book *> findByAuthor    ( const std::string & author );         // Returns the author's books in ISBN order
+    std::vector<Book *> findByPriceRange( double low, double high  );           // Returns books priced from low through high,
+                                                                                // cheapest first
+    std::vector<Book *> cheapest        ( std::size_t count        );           // Returns up to count books, cheapest first
+    std::vector<Book *> mostExpensive   ( std::size_t count        );           // Returns up to count books, most expensive first
+
+    // Keyword search over titles using the title index (see TitleIndex.hpp), built on first use or while loading if
+    // Options::buildTitleIndex is set.  Returns up to limit books whose titles contain all (or any) of the query's words, in ISBN
+    // order when matching all words, and best matches first when matching any.
+    std::vector<Book *> searchTitles( const std::string & query, std::size_t limit = 10, TitleIndex::Match match = TitleIndex::Match::ALL_TERMS );
+
+    // As-you-type suggestions using the completion trie (see CompletionTrie.hpp), built on first use or while loading if
+    // Options::buildCompletionTrie is set.  Returns up to limit books whose title or ISBN begins with prefix, ignoring case and
+    // punctuation, highest Options::completionScore first.
+    std::vector<Book *> complete( const std::string & prefix, std::size_t limit = 10 );
+
+    // Find the book most likely meant by an ISBN that isn't in the database (see IsbnResolver.hpp).  Tries, in order, the ISBN
+    // without spaces or hyphens, its ISBN-10 or ISBN-13 equivalent, the valid ISBNs one mistyped or swapped digit away, and the
+    // ISBNs one edit away.  The first step to find exactly one book decides.  Returns nullptr if none did, or if the edit distance
+    // search ran out of budget (Options::isbnResolutionBudget) before it could be sure.
+    Book * resolveIsbn( const std::string & isbn );
+
+    Snapshot snapshot();                                                        // Returns a consistent view of the current catalog
+
+    // Replace the catalog with one freshly loaded from a file, without interrupting lookups.  Returns after the old catalog is freed.
+    void reload();                                                              // Reloads from the preferred file currently available
+    void reload( const std::string & filename );
+
+    // Apply added, updated and removed books (see BookChange.hpp) without interrupting lookups.  Changes are layered over the books
+    // loaded so the cost is proportional to the size of the delta, not the database.  Adding a book already present replaces it,
+    // updating a book not present adds it, and removing a book not present has no effect.
+    void applyDelta( const std::string             & filename );              // Throws DeltaFormat_Ex, leaving the database
+    void applyDelta( const std::vector<BookChange> & changes  );              // unchanged, if the file isn't a valid delta
+
     // Queries
-    std::size_t size() const;                                                   // Returns the number of items in the database
+    std::size_t           size()                const;                          // Returns the number of items in the database
+    FilterStatistics      filterStatistics()    const;                          // Returns the Bloom filter's effectiveness so far
+    RecordCache::Statistics recordCacheStatistics() const;                      // Returns the record cache's effectiveness so far,
+                                                                                // all zeros if there's none
+    TitleIndex::Footprint titleIndexFootprint();                                // Returns the title index's memory use, building
+                                                                                // the index if need be
 
   private:
     BookDatabase            ( const std::string  & filename );
     BookDatabase            ( const BookDatabase &          ) = delete;         // intentionally prohibit making copies
     BookDatabase & operator=( const BookDatabase &          ) = delete;         // intentionally prohibit copy assignments
+   ~BookDatabase();
 
     // Private implementation details
-    std::map<std::string /*ISBN*/, Book> _data;
+    struct alignas( 64 ) FilterCounters                                         // One set per thread, so counting doesn't contend
+    {
+      std::atomic<std::size_t> hits{ 0 }, misses{ 0 }, falsePositives{ 0 };
+    };
+
+    static std::string preferredFilename();
+    void               publish( Catalog * catalog );                            // Replaces the current catalog, _reloadMutex must be held
+    FilterCounters &   filterCounters();                                        // Returns the calling thread's counters
+    static Options &   options();                                               // Returns the options configured
+
+    mutable EpochManager                                      _epochs;
+    std::atomic<Catalog *>                                    _catalog;
+    std::mutex                                                _reloadMutex;     // Serializes writers, readers never take it
+    std::array<FilterCounters, EpochManager::MAX_READERS + 1> _filterCounters;
 };
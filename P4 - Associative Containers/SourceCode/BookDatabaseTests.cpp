@@ -1,14 +1,25 @@
+#include <algorithm>  // all_of(), any_of(), is_sorted(), min()
+#include <atomic>
+#include <chrono>     // seconds
 #include <cmath>      // abs()
+#include <cstddef>    // size_t
 #include <cstdlib>    // exit()
 #include <exception>
-#include <filesystem> // exists()
+#include <filesystem> // exists(), remove(), temp_directory_path()
+#include <fstream>
+#include <future>     // future_status
 #include <iomanip>    // setprecision()
 #include <iostream>   // boolalpha(), showpoint(), fixed()
 #include <sstream>
 #include <string>     // to_string()
+#include <thread>
+#include <vector>
 
 #include "CheckResults.hpp"
+#include "BookChange.hpp"
 #include "BookDatabase.hpp"
+#include "BookFileIndex.hpp"
+#include "BookTree.hpp"
 
 
 
@@ -60,6 +71,420 @@ namespace  // anonymous
       auto book = db.find( "--------------" );
       affirm.is_equal( "Database query - non-existing book found when it shouldn't have been", nullptr, book );
     }
+
+    {
+      auto before = db.filterStatistics();
+      db.find( "--------------" );
+      db.find( "0001034359"     );
+      auto after  = db.filterStatistics();
+      affirm.is_equal( "Database filter statistics - every lookup counted", 2ULL, ( after.hits - before.hits ) + ( after.misses - before.misses ) );
+    }
+
+    {
+      auto books = db.findMany( { "0001034359", "--------------", "0001034359" } );
+      affirm.is_equal( "Database batch query - one result per ISBN", 3ULL, books.size() );
+
+      if( books.size() == 3 )
+      {
+        affirm.is_true ( "Database batch query - existing books located in order", books[0] != nullptr && books[0] == db.find( "0001034359" ) && books[2] == books[0] );
+        affirm.is_equal( "Database batch query - non-existing book found when it shouldn't have been", nullptr, books[1] );
+      }
+    }
+
+    {
+      // Readers keep looking up books while the database is reloaded out from under them, and always see a complete catalog
+      const auto               sizeBefore    = db.size();
+      const bool               expectedFound = db.find( "0001034359" ) != nullptr;
+      std::atomic<bool>        done{ false };
+      std::atomic<std::size_t> lookups{ 0 }, failures{ 0 };
+
+      std::thread reader( [&]
+      {
+        do
+        {
+          auto catalog = db.snapshot();
+          auto book    = catalog.find( "0001034359" );
+          if( ( book != nullptr ) != expectedFound || catalog.size() != sizeBefore ) ++failures;
+          ++lookups;
+        } while( !done );
+      } );
+
+      db.reload();
+      db.reload();
+      done = true;
+      reader.join();
+
+      affirm.is_equal( "Database reload - size unchanged",                             sizeBefore,    db.size()                              );
+      affirm.is_equal( "Database reload - books still found",                          expectedFound, db.find( "0001034359" ) != nullptr );
+      affirm.is_equal( "Database reload - concurrent readers saw complete catalogs",   0ULL,          failures.load()                        );
+      affirm.is_true ( "Database reload - concurrent readers kept reading",            lookups.load() > 0                                     );
+    }
+
+    {
+      std::istringstream delta( "+ \"0000000001\", \"Title\", \"Author\", 1.5\n"
+                                "- \"0000000002\"\n"
+                                "~ \"0000000003\", \"Title \\\"quoted\\\"\", \"Author\", 2\n" );
+      std::vector<BookChange> changes;
+      for( BookChange change; delta >> change; ) changes.push_back( change );
+
+      affirm.is_equal( "Delta file - every entry read",  3ULL, changes.size() );
+      affirm.is_true ( "Delta file - read to the end",   delta.eof()          );
+
+      if( changes.size() == 3 )
+      {
+        affirm.is_true ( "Delta file - operations read", changes[0].operation == BookChange::Operation::ADD
+                                                      && changes[1].operation == BookChange::Operation::REMOVE
+                                                      && changes[2].operation == BookChange::Operation::UPDATE );
+        affirm.is_equal( "Delta file - removal's ISBN read", "0000000002", changes[1].book.isbn() );
+
+        std::ostringstream written;
+        for( const auto & change : changes ) written << change << '\n';
+        affirm.is_equal( "Delta file - entries written as read", delta.str(), written.str() );
+      }
+
+      std::istringstream malformed( "* \"0000000001\"\n" );
+      BookChange         change;
+      malformed >> change;
+      affirm.is_true( "Delta file - unknown operation rejected", malformed.fail() && !malformed.eof() );
+    }
+
+    if( auto book = db.find( "0001034359" ); book != nullptr )
+    {
+      const Book        original   = *book;
+      const std::size_t sizeBefore = db.size();
+      const Book        added( "Delta Title", "Delta Author", "-delta-isbn-", 1.23 );
+      Book              updated = original;
+      updated.price( original.price() + 1 );
+
+      db.applyDelta( { { BookChange::Operation::UPDATE, updated }, { BookChange::Operation::ADD, added } } );
+      affirm.is_equal( "Database delta - size includes added book", sizeBefore + 1, db.size() );
+      affirm.is_true ( "Database delta - added book found",         db.find( "-delta-isbn-" ) != nullptr && *db.find( "-delta-isbn-" ) == added );
+      affirm.is_true ( "Database delta - updated book found",       *db.find( "0001034359" ) == updated );
+
+      const auto isbns = db.snapshot().isbns();
+      affirm.is_true ( "Database delta - ISBNs listed in order",    isbns.size() == db.size() && std::is_sorted( isbns.begin(), isbns.end() )
+                                                                 && std::binary_search( isbns.begin(), isbns.end(), "-delta-isbn-" ) );
+
+      auto books = db.findMany( { "-delta-isbn-", "0001034359", "--------------" } );
+      affirm.is_true ( "Database delta - batch query sees changes", books[0] != nullptr && *books[0] == added
+                                                                 && books[1] != nullptr && *books[1] == updated
+                                                                 && books[2] == nullptr );
+
+      db.applyDelta( { { BookChange::Operation::REMOVE, added }, { BookChange::Operation::REMOVE, original } } );
+      affirm.is_equal( "Database delta - size excludes removed books", sizeBefore - 1, db.size() );
+      affirm.is_true ( "Database delta - removed books not found",     db.find( "-delta-isbn-" ) == nullptr && db.find( "0001034359" ) == nullptr );
+
+      db.applyDelta( { { BookChange::Operation::ADD, original }, { BookChange::Operation::REMOVE, added } } );
+      affirm.is_equal( "Database delta - changes undone",              sizeBefore, db.size() );
+      affirm.is_true ( "Database delta - original book restored",      db.find( "0001034359" ) != nullptr && *db.find( "0001034359" ) == original );
+    }
+
+    if( auto book = db.find( "0001034359" ); book != nullptr )
+    {
+      const Book original = *book;
+      const auto inIsbnOrder        = []( const Book * lhs, const Book * rhs ) { return lhs->isbn()  < rhs->isbn();  };
+      const auto cheapestFirst      = []( const Book * lhs, const Book * rhs ) { return lhs->price() < rhs->price(); };
+      const auto mostExpensiveFirst = []( const Book * lhs, const Book * rhs ) { return lhs->price() > rhs->price(); };
+      const auto contains           = []( const std::vector<Book *> & books, const std::string & isbn )
+                                      { return std::any_of( books.begin(), books.end(), [&]( const Book * book ) { return book->isbn() == isbn; } ); };
+
+      auto byAuthor = db.findByAuthor( original.author() );
+      affirm.is_true( "Database author index - author's books found in ISBN order",  contains( byAuthor, original.isbn() ) && std::is_sorted( byAuthor.begin(), byAuthor.end(), inIsbnOrder )
+                                                                                     && std::all_of( byAuthor.begin(), byAuthor.end(), [&]( const Book * b ) { return b->author() == original.author(); } ) );
+
+      auto inRange = db.findByPriceRange( original.price() - 0.001, original.price() + 0.001 );
+      affirm.is_true( "Database price index - range query",                          contains( inRange, original.isbn() ) && std::is_sorted( inRange.begin(), inRange.end(), cheapestFirst ) );
+
+      auto cheapest      = db.cheapest     ( 10 );
+      auto mostExpensive = db.mostExpensive( 10 );
+      affirm.is_true( "Database price index - cheapest",                             cheapest.size() == std::min<std::size_t>( 10, db.size() ) && std::is_sorted( cheapest.begin(), cheapest.end(), cheapestFirst )
+                                                                                     && cheapest.front()->price() <= original.price() );
+      affirm.is_true( "Database price index - most expensive",                       mostExpensive.size() == cheapest.size() && std::is_sorted( mostExpensive.begin(), mostExpensive.end(), mostExpensiveFirst )
+                                                                                     && mostExpensive.front()->price() >= original.price() );
+
+      Book changed = original;
+      changed.author( "Delta Author" );
+      changed.price ( -1.00 );
+      db.applyDelta( { { BookChange::Operation::UPDATE, changed } } );
+
+      affirm.is_true( "Database secondary indexes - deltas reflected",               db.findByAuthor( "Delta Author" ) == std::vector<Book *>{ db.find( original.isbn() ) }
+                                                                                     && !contains( db.findByAuthor( original.author() ), original.isbn() )
+                                                                                     && db.cheapest( 1 ).front()->isbn() == original.isbn()
+                                                                                     && !contains( db.mostExpensive( db.size() - 1 ), original.isbn() ) );
+
+      db.applyDelta( { { BookChange::Operation::UPDATE, original } } );
+    }
+
+    if( auto book = db.find( "0001034359" ); book != nullptr )
+    {
+      const Book original = *book;
+      const auto contains = []( const std::vector<Book *> & books, const std::string & isbn )
+                            { return std::any_of( books.begin(), books.end(), [&]( const Book * book ) { return book->isbn() == isbn; } ); };
+
+      affirm.is_true( "Database title index - all title words found",                contains( db.searchTitles( original.title(), db.size() ), original.isbn() ) );
+      affirm.is_true( "Database title index - any title word found",                 contains( db.searchTitles( "zyzzyva " + original.title(), db.size(), TitleIndex::Match::ANY_TERM ), original.isbn() ) );
+      affirm.is_true( "Database title index - limit respected",                      db.searchTitles( original.title(), 1, TitleIndex::Match::ANY_TERM ).size() == 1 );
+      affirm.is_true( "Database title index - footprint reported",                   db.titleIndexFootprint().postings > 0 && db.titleIndexFootprint().total() > 0 );
+
+      Book changed = original;
+      changed.title( "Zyzzyva quux" );
+      db.applyDelta( { { BookChange::Operation::UPDATE, changed } } );
+      affirm.is_true( "Database title index - deltas reflected",                     db.searchTitles( "quux zyzzyva" ) == std::vector<Book *>{ db.find( original.isbn() ) }
+                                                                                     && !contains( db.searchTitles( original.title(), db.size() ), original.isbn() ) );
+      db.applyDelta( { { BookChange::Operation::UPDATE, original } } );
+    }
+
+    if( auto book = db.find( "0001034359" ); book != nullptr )
+    {
+      const Book original = *book;
+      const auto contains = []( const std::vector<Book *> & books, const std::string & isbn )
+                            { return std::any_of( books.begin(), books.end(), [&]( const Book * book ) { return book->isbn() == isbn; } ); };
+
+      affirm.is_true( "Database completion - by title prefix",                       contains( db.complete( original.title(), db.size() ), original.isbn() ) );
+      affirm.is_true( "Database completion - by partial ISBN",                       contains( db.complete( original.isbn().substr( 0, 8 ), db.size() ), original.isbn() ) );
+      affirm.is_true( "Database completion - limit respected",                       db.complete( "", 3 ).size() == 3 );
+
+      Book changed = original;
+      changed.title( "Zyzzyva quux" );
+      db.applyDelta( { { BookChange::Operation::UPDATE, changed } } );
+      affirm.is_true( "Database completion - deltas reflected",                      db.complete( "zyzzyva Q" ) == std::vector<Book *>{ db.find( original.isbn() ) }
+                                                                                     && contains( db.complete( original.isbn() ), original.isbn() )
+                                                                                     && !contains( db.complete( original.title(), db.size() ), original.isbn() ) );
+      db.applyDelta( { { BookChange::Operation::UPDATE, original } } );
+    }
+
+    if( auto book = db.find( "0001034359" ); book != nullptr )
+    {
+      affirm.is_true( "Database ISBN resolution - hyphenated",                       db.resolveIsbn( "0-00-103435-9" ) == book );
+      affirm.is_true( "Database ISBN resolution - ISBN-13 form",                     db.resolveIsbn( IsbnResolver::convert( book->isbn() ).value_or( "" ) ) == book );
+      affirm.is_true( "Database ISBN resolution - mistyped digit",                   db.resolveIsbn( "0001034859" ) == book );
+      affirm.is_true( "Database ISBN resolution - swapped digits",                   db.resolveIsbn( "0001034539" ) == book );
+      affirm.is_true( "Database ISBN resolution - dropped digit",                    db.resolveIsbn( "000134359" ) == book );
+      affirm.is_true( "Database ISBN resolution - nonsense",                         db.resolveIsbn( "not an isbn" ) == nullptr );
+    }
+
+    {
+      // A lazily loaded database gives the same answers as an eagerly loaded one
+      const std::size_t sizeBefore = db.size();
+      const auto        eagerBook  = db.find( "0001034359" );
+      const Book        expected   = eagerBook == nullptr ? Book() : *eagerBook;
+
+      BookDatabase::Options options;
+      options.loadLazily = true;
+      BookDatabase::configure( options );
+      db.reload();
+
+      affirm.is_equal( "Lazy database - expected size",                  sizeBefore, db.size() );
+      affirm.is_true ( "Lazy database - existing book located",          eagerBook == nullptr || ( db.find( "0001034359" ) != nullptr && *db.find( "0001034359" ) == expected ) );
+      affirm.is_equal( "Lazy database - non-existing book not found",    nullptr, db.find( "--------------" ) );
+      affirm.is_true ( "Lazy database - book parsed only once",          db.find( "0001034359" ) == db.find( "0001034359" ) );
+
+      auto books = db.findMany( { "--------------", "0001034359" } );
+      affirm.is_true ( "Lazy database - batch query",                    books.size() == 2 && books[0] == nullptr && books[1] == db.find( "0001034359" ) );
+
+      // Build a small database file with quotes and commas inside fields, and an ISBN repeated.  The last occurrence wins.
+      const auto filename  = ( std::filesystem::temp_directory_path() / "BookDatabaseTests.dat" ).string();
+      const auto indexFile = BookFileIndex::indexFilename( filename );
+      std::ofstream( filename, std::ios::binary ) << "\"0000000002\", \"Second\", \"Author\", 2\n"
+                                                     "\"0000000001\", \"First \\\"quoted\\\", with comma\", \"Author\", 1\n"
+                                                     "\"0000000002\", \"Second, revised\", \"Author\", 2.5\n";
+
+      options.saveLazyIndexFile = true;
+      BookDatabase::configure( options );
+      for( auto source : { "scanned", "read from index file" } )
+      {
+        db.reload( filename );
+        auto first  = db.find( "0000000001" );
+        auto second = db.find( "0000000002" );
+        affirm.is_equal( std::string( "Lazy database - size, "                ) + source, 2ULL, db.size() );
+        affirm.is_true ( std::string( "Lazy database - escaped quotes, "      ) + source, first  != nullptr && *first  == Book( "First \"quoted\", with comma", "Author", "0000000001", 1   ) );
+        affirm.is_true ( std::string( "Lazy database - last occurrence wins, ") + source, second != nullptr && *second == Book( "Second, revised",             "Author", "0000000002", 2.5 ) );
+        affirm.is_true ( std::string( "Lazy database - index file saved, "   ) + source, std::filesystem::exists( indexFile ) );
+      }
+
+      // Deltas however large leave the books in the file, already parsed, where they are rather than loading every book
+      const auto parsed = db.find( "0000000002" );
+      db.applyDelta( { { BookChange::Operation::ADD, Book( "Third", "Author", "0000000003", 3 ) }, { BookChange::Operation::REMOVE, Book( "", "", "0000000001" ) } } );
+      affirm.is_true ( "Lazy database - not compacted",                  db.size() == 2 && db.find( "0000000002" ) == parsed && db.find( "0000000001" ) == nullptr );
+      affirm.is_true ( "Lazy database - ISBNs listed",                   db.snapshot().isbns() == std::vector<std::string>{ "0000000002", "0000000003" } );
+
+      std::filesystem::remove( filename  );
+      std::filesystem::remove( indexFile );
+
+      BookDatabase::configure( BookDatabase::Options{} );
+      db.reload();
+      affirm.is_equal( "Lazy database - eager loading restored",         sizeBefore, db.size() );
+    }
+
+    {
+      // A perfect hash index gives the same answers as the hash table
+      const std::size_t sizeBefore = db.size();
+      const auto        book       = db.find( "0001034359" );
+      const Book        expected   = book == nullptr ? Book() : *book;
+
+      BookDatabase::Options options;
+      options.perfectHashIndex = true;
+      BookDatabase::configure( options );
+      db.reload();
+
+      affirm.is_equal( "Perfect hash database - expected size",               sizeBefore, db.size() );
+      affirm.is_true ( "Perfect hash database - existing book located",       book == nullptr || ( db.find( "0001034359" ) != nullptr && *db.find( "0001034359" ) == expected ) );
+      affirm.is_equal( "Perfect hash database - non-existing book not found", nullptr, db.find( "--------------" ) );
+
+      auto books = db.findMany( { "--------------", "0001034359", "0001034358" } );
+      affirm.is_true ( "Perfect hash database - batch query",                 books.size() == 3 && books[0] == nullptr && books[1] == db.find( "0001034359" ) && books[2] == nullptr );
+
+      BookDatabase::configure( BookDatabase::Options{} );
+      db.reload();
+    }
+
+    {
+      // Compressed titles and authors give the same answers, before and after a delta is applied
+      const std::size_t sizeBefore = db.size();
+      const auto        book       = db.find( "0001034359" );
+      const Book        expected   = book == nullptr ? Book() : *book;
+
+      BookDatabase::Options options;
+      options.compressStrings = true;
+      BookDatabase::configure( options );
+      db.reload();
+
+      affirm.is_equal( "Compressed database - expected size",               sizeBefore, db.size() );
+      affirm.is_true ( "Compressed database - existing book located",       book == nullptr || ( db.find( "0001034359" ) != nullptr && *db.find( "0001034359" ) == expected ) );
+      affirm.is_true ( "Compressed database - book built only once",        db.find( "0001034359" ) == db.find( "0001034359" ) );
+      affirm.is_equal( "Compressed database - non-existing book not found", nullptr, db.find( "--------------" ) );
+
+      auto books = db.findMany( { "--------------", "0001034359" } );
+      affirm.is_true ( "Compressed database - batch query",                 books.size() == 2 && books[0] == nullptr && books[1] == db.find( "0001034359" ) );
+      affirm.is_equal( "Compressed database - ISBNs listed",                sizeBefore, db.snapshot().isbns().size() );
+
+      if( book != nullptr )
+      {
+        auto changed = expected;
+        changed.title( "Compressed and changed" );
+        db.applyDelta( { { BookChange::Operation::UPDATE, changed } } );
+        affirm.is_true( "Compressed database - delta applied",              db.find( "0001034359" ) != nullptr && db.find( "0001034359" )->title() == "Compressed and changed" );
+      }
+
+      BookDatabase::configure( BookDatabase::Options{} );
+      db.reload();
+    }
+
+    {
+      // A disk resident database gives the same answers, and rebuilds its tree file when the database file changes
+      const std::size_t sizeBefore = db.size();
+      const auto        filename   = ( std::filesystem::temp_directory_path() / "BookDatabaseTreeTests.dat" ).string();
+      const auto        treeFile   = BookTree::treeFilename( filename );
+      std::ofstream( filename, std::ios::binary ) << "\"0000000002\", \"Second\", \"Author\", 2\n"
+                                                     "\"0000000001\", \"First \\\"quoted\\\", with comma\", \"Author\", 1\n"
+                                                     "\"0000000002\", \"Second, revised\", \"Author\", 2.5\n";
+
+      BookDatabase::Options options;
+      options.diskResident   = true;
+      options.pageCachePages = 2;
+      BookDatabase::configure( options );
+      db.reload( filename );
+
+      auto first  = db.find( "0000000001" );
+      auto second = db.find( "0000000002" );
+      affirm.is_equal( "Disk resident database - size",                        2ULL, db.size() );
+      affirm.is_true ( "Disk resident database - tree file built",             std::filesystem::exists( treeFile ) );
+      affirm.is_true ( "Disk resident database - escaped quotes",              first  != nullptr && *first  == Book( "First \"quoted\", with comma", "Author", "0000000001", 1   ) );
+      affirm.is_true ( "Disk resident database - last occurrence wins",        second != nullptr && *second == Book( "Second, revised",             "Author", "0000000002", 2.5 ) );
+      affirm.is_true ( "Disk resident database - book read only once",         db.find( "0000000001" ) == first );
+      affirm.is_equal( "Disk resident database - non-existing book not found", nullptr, db.find( "0000000003" ) );
+
+      auto books = db.findMany( { "0000000003", "0000000002" } );
+      affirm.is_true ( "Disk resident database - batch query",                 books.size() == 2 && books[0] == nullptr && books[1] == second );
+
+      std::ofstream( filename, std::ios::binary | std::ios::app ) << "\"0000000003\", \"Third\", \"Author\", 3\n";
+      db.reload( filename );
+      affirm.is_equal( "Disk resident database - tree rebuilt when file changes", 3ULL, db.size() );
+      affirm.is_true ( "Disk resident database - added book found",             db.find( "0000000003" ) != nullptr );
+      affirm.is_true ( "Disk resident database - ISBNs listed",                 db.snapshot().isbns() == std::vector<std::string>{ "0000000001", "0000000002", "0000000003" } );
+
+      std::filesystem::remove( filename );
+      std::filesystem::remove( treeFile );
+
+      BookDatabase::configure( BookDatabase::Options{} );
+      db.reload();
+      affirm.is_equal( "Disk resident database - eager loading restored",      sizeBefore, db.size() );
+    }
+
+    {
+      // A record cache in front of a lazily loaded database gives the same answers, and keeps books looked up again
+      const auto book     = db.find( "0001034359" );
+      const Book expected = book == nullptr ? Book() : *book;
+
+      BookDatabase::Options options;
+      options.loadLazily       = true;
+      options.recordCacheBytes = 64 * 1024;
+      BookDatabase::configure( options );
+      db.reload();
+
+      {
+        auto snapshot = db.snapshot();
+        auto first    = snapshot.find( "0001034359" );
+        affirm.is_true ( "Record cache database - existing book located",       book == nullptr || ( first != nullptr && *first == expected ) );
+        affirm.is_true ( "Record cache database - book found again in cache",   snapshot.find( "0001034359" ) == first );
+        affirm.is_equal( "Record cache database - non-existing book not found", nullptr, snapshot.find( "--------------" ) );
+
+        auto books = snapshot.findMany( { "--------------", "0001034359" } );
+        affirm.is_true ( "Record cache database - batch query",                 books.size() == 2 && books[0] == nullptr && books[1] == first );
+      }
+
+      const auto statistics = db.recordCacheStatistics();
+      affirm.is_true ( "Record cache database - hits counted",                  book == nullptr || statistics.hits >= 2 );
+      affirm.is_true ( "Record cache database - within budget",                 statistics.bytes <= options.recordCacheBytes );
+
+      BookDatabase::configure( BookDatabase::Options{} );
+      db.reload();
+      const auto none = db.recordCacheStatistics();
+      affirm.is_equal( "Record cache database - none unless asked for",         0ULL, none.hits + none.misses );
+    }
+
+    {
+      // A book found directly, without a Snapshot, stays valid while another thread's lookups evict it from the record cache
+      const auto book     = db.find( "0001034359" );
+      const Book expected = book == nullptr ? Book() : *book;
+
+      BookDatabase::Options options;
+      options.loadLazily       = true;
+      options.recordCacheBytes = 1024;
+      BookDatabase::configure( options );
+      db.reload();
+
+      const auto        held = db.find( "0001034359" );
+      std::atomic<bool> done{ false };
+      std::thread evictor( [&]
+      {
+        for( int round = 0; round < 20; ++round )
+        {
+          auto snapshot = db.snapshot();
+          snapshot.findByPriceRange( round * 5.0, round * 5.0 + 5.0 );
+        }
+        done = true;
+      } );
+
+      bool intact = true;
+      while( !done ) intact = intact && ( held == nullptr || *held == expected );
+      evictor.join();
+
+      affirm.is_true ( "Record cache database - direct lookups outlive eviction", db.recordCacheStatistics().evictions > 0 && intact
+                                                                                   && ( book == nullptr || ( held != nullptr && *held == expected ) ) );
+
+      BookDatabase::configure( BookDatabase::Options{} );
+      db.reload();
+    }
+
+    {
+      auto loaded = BookDatabase::loadInBackground();
+      affirm.is_true( "Background load - readiness handle valid",     loaded.valid() );
+
+      loaded.get();
+      affirm.is_true( "Background load - ready once loaded",          loaded.wait_for( std::chrono::seconds( 0 ) ) == std::future_status::ready );
+      affirm.is_true( "Background load - repeated requests harmless", BookDatabase::loadInBackground().wait_for( std::chrono::seconds( 0 ) ) == std::future_status::ready );
+    }
   }
 
 
@@ -0,0 +1,265 @@
+#include <algorithm>     // stable_sort()
+#include <atomic>
+#include <cctype>        // isdigit()
+#include <cstddef>       // size_t
+#include <cstdint>       // int64_t, uint32_t, uint64_t
+#include <filesystem>    // exists(), file_size(), last_write_time()
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <optional>
+#include <stdexcept>     // length_error
+#include <string>
+#include <string_view>
+#include <utility>       // move()
+#include <vector>
+
+#include "Book.hpp"
+#include "BookFileIndex.hpp"
+
+
+
+namespace  // anonymous
+{
+  // A saved index file begins with this header, followed by the entries and then the ISBNs exactly as they are held in memory.  The
+  // database file's size and modification time are recorded so an index saved for an older version of the file is not reused.
+  struct IndexFileHeader
+  {
+    char          magic[8]       = { 'B', 'K', 'I', 'D', 'X', '0', '0', '1' };
+    std::uint64_t databaseSize   = 0;
+    std::int64_t  databaseTime   = 0;
+    std::uint64_t entryCount     = 0;
+    std::uint64_t isbnBytes      = 0;
+  };
+
+  IndexFileHeader headerFor( const std::string & databaseFilename )
+  {
+    IndexFileHeader header;
+    header.databaseSize = std::filesystem::file_size( databaseFilename );
+    header.databaseTime = std::filesystem::last_write_time( databaseFilename ).time_since_epoch().count();
+    return header;
+  }
+}
+
+
+
+// Constructors, destructor
+BookFileIndex::BookFileIndex( const std::string & filename, bool saveIndexFile )
+  : _file( filename, std::ios::binary )
+{
+  if( !loadIndex( filename ) )
+  {
+    scan( _file );
+    if( saveIndexFile && _file.is_open() ) saveIndex( filename );
+  }
+
+  _books = std::vector<std::atomic<Book *>>( _entries.size() );
+}
+
+
+
+BookFileIndex::~BookFileIndex()
+{
+  for( auto & book : _books ) delete book.load();
+}
+
+
+
+// Queries
+std::size_t BookFileIndex::size() const
+{
+  return _entries.size();
+}
+
+
+
+std::string_view BookFileIndex::isbn( std::size_t position ) const
+{
+  const auto & entry = _entries[position];
+  return std::string_view( _isbns ).substr( entry.isbnOffset, entry.isbnLength );
+}
+
+
+
+std::size_t BookFileIndex::indexOf( std::string_view isbn ) const
+{
+  // Binary search, an O(log n) operation
+  std::size_t first = 0, last = _entries.size();
+  while( first < last )
+  {
+    auto middle = first + ( last - first ) / 2;
+    if( this->isbn( middle ) < isbn ) first = middle + 1;
+    else                              last  = middle;
+  }
+
+  return first < _entries.size() && this->isbn( first ) == isbn ? first : _entries.size();
+}
+
+
+
+std::string BookFileIndex::indexFilename( const std::string & filename )
+{
+  return filename + ".idx";
+}
+
+
+
+Book * BookFileIndex::at( std::size_t position )
+{
+  if( auto book = _books[position].load( std::memory_order_acquire ); book != nullptr ) return book;
+
+  // First access, parse the record.  Several threads may race to parse the same record, but only the first to finish publishes its
+  // result and the others use that.
+  auto record = read( position );
+  if( !record ) return nullptr;
+
+  auto   parsed   = new Book( std::move( *record ) );
+  Book * expected = nullptr;
+  if( _books[position].compare_exchange_strong( expected, parsed, std::memory_order_acq_rel ) ) return parsed;
+
+  delete parsed;
+  return expected;
+}
+
+
+
+std::optional<Book> BookFileIndex::read( std::size_t position )
+{
+  Book book;
+
+  std::lock_guard<std::mutex> lock( _fileMutex );
+  _file.clear();
+  _file.seekg( static_cast<std::streamoff>( _entries[position].recordOffset ) );
+
+  if( !( _file >> book ) ) return std::nullopt;
+  return book;
+}
+
+
+
+// Find every record's starting offset and ISBN without parsing the rest of the record.  Records are 3 quoted fields followed by an
+// unquoted price, so the quote opening a record is the first quote after a record's third quoted field.  Within quotes, a backslash
+// escapes the character after it.  A record is indexed once its price begins, so a record truncated at the end of the file is left
+// out just as it would be when loading eagerly.
+void BookFileIndex::scan( std::istream & database )
+{
+  std::vector<char> buffer( 1 << 20 );
+  std::uint64_t     offset       = 0;                         // offset in the file of buffer[0]
+  std::uint64_t     recordOffset = 0;
+  unsigned          quotedFields = 3;                         // quoted fields seen so far in the current record
+  bool              inQuotes     = false;
+  bool              escaped      = false;
+  bool              indexed      = true;                      // whether the current record has been added to the index
+  std::string       key;                                      // the current record's ISBN
+
+  while( database.read( buffer.data(), static_cast<std::streamsize>( buffer.size() ) ) || database.gcount() > 0 )
+  {
+    const auto count = static_cast<std::size_t>( database.gcount() );
+
+    for( std::size_t i = 0; i < count; ++i )
+    {
+      const char c = buffer[i];
+
+      if( !inQuotes )
+      {
+        if( c != '"' )
+        {
+          if( quotedFields == 3 && !indexed && std::isdigit( static_cast<unsigned char>( c ) ) )
+          {
+            if( _isbns.size() + key.size() > UINT32_MAX ) throw std::length_error( "Too many ISBNs to index" );
+            _entries.push_back( { recordOffset, static_cast<std::uint32_t>( _isbns.size() ), static_cast<std::uint32_t>( key.size() ) } );
+            _isbns += key;
+            indexed = true;
+          }
+          continue;
+        }
+
+        inQuotes = true;
+        if( quotedFields == 3 )                               // opening a new record
+        {
+          quotedFields = 0;
+          recordOffset = offset + i;
+          indexed      = false;
+          key.clear();
+        }
+      }
+      else if( escaped )
+      {
+        escaped = false;
+        if( quotedFields == 0 ) key += c;
+      }
+      else if( c == '\\' )
+      {
+        escaped = true;
+      }
+      else if( c == '"' )
+      {
+        inQuotes = false;
+        ++quotedFields;
+      }
+      else if( quotedFields == 0 )
+      {
+        key += c;
+      }
+    }
+
+    offset += count;
+  }
+
+  // Sort by ISBN.  When an ISBN appears more than once, the last occurrence in the file replaces the others, the same as loading the
+  // file eagerly.
+  std::stable_sort( _entries.begin(), _entries.end(), [this]( const Entry & lhs, const Entry & rhs )
+                    { return std::string_view( _isbns ).substr( lhs.isbnOffset, lhs.isbnLength ) < std::string_view( _isbns ).substr( rhs.isbnOffset, rhs.isbnLength ); } );
+
+  std::size_t kept = 0;
+  for( std::size_t i = 0; i < _entries.size(); ++i )
+  {
+    if( i + 1 < _entries.size() && isbn( i ) == isbn( i + 1 ) ) continue;
+    _entries[kept++] = _entries[i];
+  }
+  _entries.resize( kept );
+}
+
+
+
+bool BookFileIndex::loadIndex( const std::string & filename )
+{
+  const auto indexFile = indexFilename( filename );
+  if( !std::filesystem::exists( filename ) || !std::filesystem::exists( indexFile ) ) return false;
+
+  std::ifstream   fin( indexFile, std::ios::binary );
+  IndexFileHeader header;
+  const auto      expected = headerFor( filename );
+
+  if( !fin.read( reinterpret_cast<char *>( &header ), sizeof( header ) )
+   || std::string_view( header.magic, sizeof( header.magic ) ) != std::string_view( expected.magic, sizeof( expected.magic ) )
+   || header.databaseSize != expected.databaseSize
+   || header.databaseTime != expected.databaseTime ) return false;
+
+  _entries.resize( header.entryCount );
+  _isbns  .resize( header.isbnBytes  );
+  fin.read( reinterpret_cast<char *>( _entries.data() ), static_cast<std::streamsize>( _entries.size() * sizeof( Entry ) ) );
+  fin.read( _isbns.data(),                               static_cast<std::streamsize>( _isbns.size()                   ) );
+
+  if( fin ) return true;
+
+  _entries.clear();                                           // truncated, fall back to scanning
+  _isbns  .clear();
+  return false;
+}
+
+
+
+void BookFileIndex::saveIndex( const std::string & filename ) const
+{
+  auto header = headerFor( filename );
+  header.entryCount = _entries.size();
+  header.isbnBytes  = _isbns.size();
+
+  std::ofstream fout( indexFilename( filename ), std::ios::binary | std::ios::trunc );
+  fout.write( reinterpret_cast<const char *>( &header ),          sizeof( header ) );
+  fout.write( reinterpret_cast<const char *>( _entries.data() ), static_cast<std::streamsize>( _entries.size() * sizeof( Entry ) ) );
+  fout.write( _isbns.data(),                                      static_cast<std::streamsize>( _isbns.size()                   ) );
+
+  if( !fout ) std::clog << "Warning:  unable to save index file \"" << indexFilename( filename ) << "\"\n";
+}
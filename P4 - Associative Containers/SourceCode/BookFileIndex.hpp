@@ -0,0 +1,67 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>    // size_t
+#include <cstdint>    // uint32_t, uint64_t
+#include <fstream>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Book.hpp"
+
+
+
+// An index from ISBN to where each book's record begins within a database file.  Building the index scans the file for record
+// boundaries and ISBNs only, without parsing titles, authors, or prices, or reads a previously saved index file instead.  A book's
+// record is parsed the first time the book is asked for, and the result kept for subsequent requests.
+//
+// Thread safety:  Any number of threads may look up books at the same time.  Books returned remain valid for the index's lifetime.
+class BookFileIndex
+{
+  public:
+    // Constructors, destructor
+    BookFileIndex( const std::string & filename, bool saveIndexFile = false );  // Reuses a saved index file if one exists that
+                                                                                 // matches the database file, otherwise scans the
+                                                                                 // database file and, if asked, saves the index
+   ~BookFileIndex();
+
+    BookFileIndex            ( const BookFileIndex & ) = delete;
+    BookFileIndex & operator=( const BookFileIndex & ) = delete;
+
+    // Queries
+    std::size_t      size   ()                        const;                    // Returns the number of books indexed
+    std::size_t      indexOf( std::string_view isbn ) const;                    // Returns the position of the book in ISBN order, or
+                                                                                 // size() if the ISBN isn't indexed
+    std::string_view isbn   ( std::size_t position  ) const;                    // Returns the ISBN of the book at a position
+
+    // Returns the book at a position, parsing its record first if this is the first time it has been asked for.  Returns nullptr if
+    // the record can't be parsed.
+    Book * at( std::size_t position );
+
+    // Parses and returns the book at a position without keeping it, for reading through every book without holding them all
+    std::optional<Book> read( std::size_t position );
+
+    static std::string indexFilename( const std::string & filename );           // Returns the name of the saved index file for a
+                                                                                 // database file
+  private:
+    struct Entry                                                                // 16 bytes per book, plus the ISBN's characters
+    {
+      std::uint64_t recordOffset;                                               // where the book's record begins in the database file
+      std::uint32_t isbnOffset;                                                 // where the book's ISBN begins in _isbns
+      std::uint32_t isbnLength;
+    };
+
+    void scan     ( std::istream & database );
+    bool loadIndex( const std::string & filename );
+    void saveIndex( const std::string & filename ) const;
+
+    std::vector<Entry>               _entries;                                  // sorted by ISBN
+    std::string                      _isbns;                                    // every ISBN, back to back
+    std::vector<std::atomic<Book *>> _books;                                    // parallels _entries, nullptr until parsed
+
+    std::mutex                       _fileMutex;                                // serializes seeking and reading _file
+    std::ifstream                    _file;
+};
@@ -0,0 +1,568 @@
+#include <algorithm>     // lower_bound(), max(), min(), upper_bound()
+#include <cstddef>       // size_t
+#include <cstdint>       // int64_t, uint8_t, uint16_t, uint32_t, uint64_t
+#include <cstring>       // memcpy()
+#include <filesystem>    // exists(), file_size(), last_write_time()
+#include <fstream>
+#include <memory>        // make_shared(), make_unique()
+#include <mutex>
+#include <optional>
+#include <stdexcept>     // length_error
+#include <string>
+#include <string_view>
+#include <utility>       // move()
+#include <vector>
+
+#include "Book.hpp"
+#include "BookFileIndex.hpp"
+#include "BookTree.hpp"
+
+
+
+namespace  // anonymous
+{
+  // Page 0 holds this header.  As with BookFileIndex's saved index, the database file's size and modification time are recorded so a
+  // tree built from an older version of the file is not reused.
+  struct TreeFileHeader
+  {
+    char          magic[8]      = { 'B', 'K', 'T', 'R', 'E', 'E', '0', '1' };
+    std::uint64_t databaseSize  = 0;
+    std::int64_t  databaseTime  = 0;
+    std::uint64_t bookCount     = 0;
+    std::uint32_t pageSize      = BookTree::PAGE_SIZE;
+    std::uint32_t root          = 0;
+    std::uint32_t height        = 0;                          // 0 if there are no books
+    std::uint32_t leafCount     = 0;
+    std::uint32_t directory     = 0;                          // the first directory page
+  };
+
+  // Every other page begins with a type and entry count, followed by the offset within the page of each entry
+  enum class PageType : std::uint16_t { LEAF = 1, INTERIOR = 2 };
+
+  constexpr std::size_t PAGE_HEADER_SIZE = 2 * sizeof( std::uint16_t );
+  constexpr std::size_t OFFSET_SIZE      = sizeof( std::uint16_t );
+
+  // Leaf entries:      u16 ISBN length, ISBN, u8 storage, u32 record length, then the record (INLINE) or its first page (OVERFLOW)
+  // Records:           u32 title length, u32 author length, f64 price, title, author
+  // Interior entries:  u32 child page, u16 ISBN length, ISBN
+  enum class Storage : std::uint8_t { INLINE = 0, OVERFLOW = 1 };
+
+  constexpr std::size_t MAX_INLINE_RECORD = BookTree::PAGE_SIZE / 4;         // so every leaf holds at least a few books
+
+
+  template<typename T>
+  void put( std::string & out, T value )
+  {
+    char bytes[sizeof( T )];
+    std::memcpy( bytes, &value, sizeof( T ) );
+    out.append( bytes, sizeof( T ) );
+  }
+
+  template<typename T>
+  T get( const char * & in )
+  {
+    T value;
+    std::memcpy( &value, in, sizeof( T ) );
+    in += sizeof( T );
+    return value;
+  }
+
+  std::uint16_t entryCount( const char * page )
+  {
+    std::uint16_t count;
+    std::memcpy( &count, page + sizeof( std::uint16_t ), sizeof( count ) );
+    return count;
+  }
+
+  const char * entry( const char * page, std::size_t index )
+  {
+    std::uint16_t offset;
+    std::memcpy( &offset, page + PAGE_HEADER_SIZE + index * OFFSET_SIZE, sizeof( offset ) );
+    return page + offset;
+  }
+
+  std::string_view entryIsbn( const char * page, std::size_t index, std::size_t isbnOffset )
+  {
+    auto in     = entry( page, index ) + isbnOffset;
+    auto length = get<std::uint16_t>( in );
+    return { in, length };
+  }
+
+  // Lays entries out as a page:  the header, the offsets, then the entries themselves
+  std::string pageOf( PageType type, const std::vector<std::string> & entries )
+  {
+    std::string page;
+    put( page, static_cast<std::uint16_t>( type           ) );
+    put( page, static_cast<std::uint16_t>( entries.size() ) );
+
+    auto offset = PAGE_HEADER_SIZE + entries.size() * OFFSET_SIZE;
+    for( const auto & entry : entries )
+    {
+      put( page, static_cast<std::uint16_t>( offset ) );
+      offset += entry.size();
+    }
+    for( const auto & entry : entries ) page += entry;
+
+    return page;
+  }
+
+  TreeFileHeader headerFor( const std::string & databaseFilename )
+  {
+    TreeFileHeader header;
+    header.databaseSize = std::filesystem::file_size( databaseFilename );
+    header.databaseTime = std::filesystem::last_write_time( databaseFilename ).time_since_epoch().count();
+    return header;
+  }
+}
+
+
+
+
+/*******************************************************************************
+**  Builder
+*******************************************************************************/
+BookTree::Builder::Builder( const std::string & filename )
+  : _file( filename, std::ios::binary | std::ios::trunc )
+{
+  if( !_file ) throw Format_Ex( "Unable to create book tree file \"" + filename + '"' );
+  _file.write( std::string( PAGE_SIZE, '\0' ).data(), PAGE_SIZE );          // the header's place
+}
+
+
+
+void BookTree::Builder::add( const Book & book )
+{
+  const auto isbn = book.isbn();
+  if( isbn.size() > MAX_ISBN_LENGTH           ) throw std::length_error( "ISBN too long for a book tree:  " + isbn );
+  if( _bookCount > 0 && !( _lastIsbn < isbn ) ) throw Order_Ex( "Books added to a book tree out of ISBN order:  " + isbn );
+
+  const auto title  = book.title();
+  const auto author = book.author();
+
+  std::string record;
+  put( record, static_cast<std::uint32_t>( title .size() ) );
+  put( record, static_cast<std::uint32_t>( author.size() ) );
+  put( record, book.price() );
+  record += title;
+  record += author;
+
+  std::string entry;
+  put( entry, static_cast<std::uint16_t>( isbn.size() ) );
+  entry += isbn;
+
+  if( record.size() <= MAX_INLINE_RECORD )
+  {
+    put( entry, Storage::INLINE );
+    put( entry, static_cast<std::uint32_t>( record.size() ) );
+    entry += record;
+  }
+  else
+  {
+    // The leaf being filled hasn't been written yet, so the overflow pages written now are consecutive
+    put( entry, Storage::OVERFLOW );
+    put( entry, static_cast<std::uint32_t>( record.size() ) );
+    put( entry, _pageCount );
+    for( std::size_t offset = 0; offset < record.size(); offset += PAGE_SIZE ) writePage( std::string_view( record ).substr( offset, PAGE_SIZE ) );
+  }
+
+  if( PAGE_HEADER_SIZE + ( _entries.size() + 1 ) * OFFSET_SIZE + _entryBytes + entry.size() > PAGE_SIZE ) writeLeaf();
+
+  if( _entries.empty() ) _leafFirstIds.push_back( static_cast<std::uint32_t>( _bookCount ) );
+  _entryBytes += entry.size();
+  _entries.push_back( std::move( entry ) );
+
+  _lastIsbn = isbn;
+  ++_bookCount;
+}
+
+
+
+void BookTree::Builder::writeLeaf()
+{
+  const char * in        = _entries.front().data();
+  const auto   isbnSize  = get<std::uint16_t>( in );
+  _leaves.emplace_back( std::string( in, isbnSize ), writePage( pageOf( PageType::LEAF, _entries ) ) );
+
+  _entries.clear();
+  _entryBytes = 0;
+}
+
+
+
+std::uint32_t BookTree::Builder::writePage( std::string_view contents )
+{
+  std::string page( contents );
+  page.resize( PAGE_SIZE, '\0' );
+  _file.write( page.data(), PAGE_SIZE );
+
+  return _pageCount++;
+}
+
+
+
+void BookTree::Builder::finish( std::uint64_t databaseSize, std::int64_t databaseTime )
+{
+  if( !_entries.empty() ) writeLeaf();
+
+  TreeFileHeader header;
+  header.databaseSize = databaseSize;
+  header.databaseTime = databaseTime;
+  header.bookCount    = _bookCount;
+  header.leafCount    = static_cast<std::uint32_t>( _leaves.size() );
+
+  // Build the tree bottom up, each level's pages holding the first ISBN and page of as many pages of the level below as fit
+  auto level = std::move( _leaves );
+  if( !level.empty() ) header.height = 1;
+
+  std::vector<std::uint32_t> leafPages;
+  for( const auto & leaf : level ) leafPages.push_back( leaf.second );
+
+  while( level.size() > 1 )
+  {
+    decltype( level )        parents;
+    std::vector<std::string> entries;
+    std::string              firstIsbn;
+    std::size_t              bytes = 0;
+
+    for( const auto & [isbn, child] : level )
+    {
+      std::string entry;
+      put( entry, child );
+      put( entry, static_cast<std::uint16_t>( isbn.size() ) );
+      entry += isbn;
+
+      if( PAGE_HEADER_SIZE + ( entries.size() + 1 ) * OFFSET_SIZE + bytes + entry.size() > PAGE_SIZE )
+      {
+        parents.emplace_back( firstIsbn, writePage( pageOf( PageType::INTERIOR, entries ) ) );
+        entries.clear();
+        bytes = 0;
+      }
+
+      if( entries.empty() ) firstIsbn = isbn;
+      bytes += entry.size();
+      entries.push_back( std::move( entry ) );
+    }
+    parents.emplace_back( firstIsbn, writePage( pageOf( PageType::INTERIOR, entries ) ) );
+
+    level = std::move( parents );
+    ++header.height;
+  }
+  if( !level.empty() ) header.root = level.front().second;
+
+  // The directory:  every leaf's first id, then every leaf's page
+  std::string directory;
+  for( auto id   : _leafFirstIds ) put( directory, id   );
+  for( auto page : leafPages     ) put( directory, page );
+
+  header.directory = _pageCount;
+  for( std::size_t offset = 0; offset < directory.size(); offset += PAGE_SIZE ) writePage( std::string_view( directory ).substr( offset, PAGE_SIZE ) );
+
+  _file.seekp( 0 );
+  _file.write( reinterpret_cast<const char *>( &header ), sizeof( header ) );
+  _file.flush();
+
+  if( !_file ) throw Format_Ex( "Unable to write book tree file" );
+}
+
+
+
+
+/*******************************************************************************
+**  Tree
+*******************************************************************************/
+BookTree::BookTree( const std::string & filename, std::size_t cachePages )
+  : _shardPages( std::max<std::size_t>( cachePages / CACHE_SHARDS, 1 ) ),
+    _filename  ( filename )
+{
+  auto file = std::make_unique<std::ifstream>( filename, std::ios::binary );
+
+  TreeFileHeader header;
+  const TreeFileHeader expected;
+
+  if( !file->read( reinterpret_cast<char *>( &header ), sizeof( header ) )
+   || std::string_view( header.magic, sizeof( header.magic ) ) != std::string_view( expected.magic, sizeof( expected.magic ) )
+   || header.pageSize != PAGE_SIZE ) throw Format_Ex( "Not a book tree file:  \"" + filename + '"' );
+
+  _bookCount = header.bookCount;
+  _root      = header.root;
+  _height    = header.height;
+
+  _leafFirstIds.resize( header.leafCount );
+  _leafPages   .resize( header.leafCount );
+  file->seekg( static_cast<std::streamoff>( header.directory ) * static_cast<std::streamoff>( PAGE_SIZE ) );
+  file->read( reinterpret_cast<char *>( _leafFirstIds.data() ), static_cast<std::streamsize>( _leafFirstIds.size() * sizeof( std::uint32_t ) ) );
+  file->read( reinterpret_cast<char *>( _leafPages   .data() ), static_cast<std::streamsize>( _leafPages   .size() * sizeof( std::uint32_t ) ) );
+
+  if( !*file ) throw Format_Ex( "Truncated book tree file:  \"" + filename + '"' );
+
+  _files.push_back( std::move( file ) );
+}
+
+
+
+std::optional<Book> BookTree::find( std::string_view isbn ) const
+{
+  const auto found = locate( isbn );
+  if( found.leaf == nullptr ) return std::nullopt;
+  return book( found.leaf->data(), found.entry );
+}
+
+
+
+std::size_t BookTree::idOf( std::string_view isbn ) const
+{
+  const auto found = locate( isbn );
+  if( found.leaf == nullptr ) return _bookCount;
+
+  // Leaves were written in ISBN order, so their pages are in increasing order too
+  const auto leaf = static_cast<std::size_t>( std::lower_bound( _leafPages.begin(), _leafPages.end(), found.page ) - _leafPages.begin() );
+  return _leafFirstIds[leaf] + found.entry;
+}
+
+
+
+BookTree::Location BookTree::locate( std::string_view isbn ) const
+{
+  if( _height == 0 ) return {};
+
+  // Descend through the interior pages to the child whose first ISBN is the last not after the one sought
+  auto number = _root;
+  for( std::uint32_t level = 1; level < _height; ++level )
+  {
+    const auto   held     = page( number );
+    const char * interior = held->data();
+    std::size_t  low = 1, high = entryCount( interior );
+    while( low < high )
+    {
+      const auto middle = low + ( high - low ) / 2;
+      if( entryIsbn( interior, middle, sizeof( std::uint32_t ) ) <= isbn ) low  = middle + 1;
+      else                                                                 high = middle;
+    }
+
+    auto in = entry( interior, low - 1 );
+    number  = get<std::uint32_t>( in );
+  }
+
+  auto         held = page( number );
+  const char * leaf = held->data();
+  std::size_t  low = 0, high = entryCount( leaf );
+  while( low < high )
+  {
+    const auto middle = low + ( high - low ) / 2;
+    if( entryIsbn( leaf, middle, 0 ) < isbn ) low  = middle + 1;
+    else                                      high = middle;
+  }
+
+  if( low == entryCount( leaf ) || entryIsbn( leaf, low, 0 ) != isbn ) return {};
+  return { std::move( held ), number, low };
+}
+
+
+
+std::optional<Book> BookTree::at( std::size_t id ) const
+{
+  if( id >= _bookCount ) return std::nullopt;
+
+  const auto leaf = static_cast<std::size_t>( std::upper_bound( _leafFirstIds.begin(), _leafFirstIds.end(), id ) - _leafFirstIds.begin() ) - 1;
+
+  return book( page( _leafPages[leaf] )->data(), id - _leafFirstIds[leaf] );
+}
+
+
+
+std::vector<std::string> BookTree::isbns() const
+{
+  // Each leaf is read straight from the file rather than through the cache, so listing every ISBN doesn't evict the pages lookups use
+  std::vector<std::string> isbns;
+  isbns.reserve( _bookCount );
+
+  Page leaf;
+  for( auto number : _leafPages )
+  {
+    read( number, leaf );
+    for( std::size_t index = 0, count = entryCount( leaf.data() ); index < count; ++index ) isbns.emplace_back( entryIsbn( leaf.data(), index, 0 ) );
+  }
+  return isbns;
+}
+
+
+
+std::optional<Book> BookTree::book( const char * leaf, std::size_t index ) const
+{
+  auto       in      = entry( leaf, index );
+  const auto isbn    = std::string( entryIsbn( leaf, index, 0 ) );
+  in += sizeof( std::uint16_t ) + isbn.size();
+
+  const auto storage = get<Storage      >( in );
+  const auto length  = get<std::uint32_t>( in );
+
+  // An overflowing record is gathered from its pages, each read through the cache in turn
+  std::string record;
+  if( storage == Storage::INLINE ) record.assign( in, length );
+  else
+  {
+    for( auto number = get<std::uint32_t>( in ); record.size() < length; ++number )
+    {
+      record.append( page( number )->data(), std::min<std::size_t>( PAGE_SIZE, length - record.size() ) );
+    }
+  }
+
+  const char * fields       = record.data();
+  const auto   titleLength  = get<std::uint32_t>( fields );
+  const auto   authorLength = get<std::uint32_t>( fields );
+  const auto   price        = get<double       >( fields );
+
+  return Book( std::string_view( fields, titleLength ), std::string_view( fields + titleLength, authorLength ), isbn, price );
+}
+
+
+
+BookTree::PageRef BookTree::page( std::uint32_t number ) const
+{
+  // Consecutive pages, such as an overflow run, are spread over the shards
+  auto & shard = _shards[number % CACHE_SHARDS];
+
+  {
+    std::lock_guard<std::mutex> lock( shard.mutex );
+    if( auto frame = shard.frameOf.find( number ); frame != shard.frameOf.end() )
+    {
+      ++shard.statistics.hits;
+      shard.frames[frame->second].referenced = true;
+      return shard.frames[frame->second].page;
+    }
+    ++shard.statistics.misses;
+  }
+
+  // Read without holding the lock, so a slow read doesn't hold up lookups of other pages in the shard
+  auto loaded = std::make_shared<Page>();
+  read( number, *loaded );
+
+  std::lock_guard<std::mutex> lock( shard.mutex );
+
+  // Another thread may have read the same page meanwhile, in which case use theirs
+  if( auto frame = shard.frameOf.find( number ); frame != shard.frameOf.end() ) return shard.frames[frame->second].page;
+
+  if( shard.frames.size() < _shardPages )
+  {
+    shard.frameOf[number] = shard.frames.size();
+    shard.frames.push_back( { number, loaded, true } );
+    return loaded;
+  }
+
+  // Sweep the hand past frames used since it last came by, clearing their mark, and take the first unmarked.  Readers still holding
+  // the page it held keep it until they're done.
+  while( shard.frames[shard.hand].referenced )
+  {
+    shard.frames[shard.hand].referenced = false;
+    shard.hand = ( shard.hand + 1 ) % shard.frames.size();
+  }
+
+  auto & frame = shard.frames[shard.hand];
+  shard.frameOf.erase( frame.number );
+  shard.frameOf[number] = shard.hand;
+  frame                 = { number, loaded, true };
+  shard.hand            = ( shard.hand + 1 ) % shard.frames.size();
+
+  return loaded;
+}
+
+
+
+void BookTree::read( std::uint32_t number, Page & page ) const
+{
+  std::unique_ptr<std::ifstream> file;
+  {
+    std::lock_guard<std::mutex> lock( _filesMutex );
+    if( !_files.empty() )
+    {
+      file = std::move( _files.back() );
+      _files.pop_back();
+    }
+  }
+  if( !file ) file = std::make_unique<std::ifstream>( _filename, std::ios::binary );
+
+  file->clear();
+  file->seekg( static_cast<std::streamoff>( number ) * static_cast<std::streamoff>( PAGE_SIZE ) );
+  const bool whole = static_cast<bool>( file->read( page.data(), PAGE_SIZE ) );
+
+  {
+    std::lock_guard<std::mutex> lock( _filesMutex );
+    _files.push_back( std::move( file ) );
+  }
+
+  if( !whole ) throw Format_Ex( "Truncated book tree file" );
+}
+
+
+
+std::size_t BookTree::size() const
+{
+  return _bookCount;
+}
+
+
+
+std::size_t BookTree::height() const
+{
+  return _height;
+}
+
+
+
+BookTree::CacheStatistics BookTree::cacheStatistics() const
+{
+  CacheStatistics total;
+  for( auto & shard : _shards )
+  {
+    std::lock_guard<std::mutex> lock( shard.mutex );
+    total.hits   += shard.statistics.hits;
+    total.misses += shard.statistics.misses;
+  }
+
+  return total;
+}
+
+
+
+
+/*******************************************************************************
+**  Tree files built from database files
+*******************************************************************************/
+std::string BookTree::treeFilename( const std::string & databaseFilename )
+{
+  return databaseFilename + ".bpt";
+}
+
+
+
+bool BookTree::isCurrent( const std::string & databaseFilename )
+{
+  const auto treeFile = treeFilename( databaseFilename );
+  if( !std::filesystem::exists( databaseFilename ) || !std::filesystem::exists( treeFile ) ) return false;
+
+  std::ifstream  fin( treeFile, std::ios::binary );
+  TreeFileHeader header;
+  const auto     expected = headerFor( databaseFilename );
+
+  return fin.read( reinterpret_cast<char *>( &header ), sizeof( header ) )
+      && std::string_view( header.magic, sizeof( header.magic ) ) == std::string_view( expected.magic, sizeof( expected.magic ) )
+      && header.databaseSize == expected.databaseSize
+      && header.databaseTime == expected.databaseTime;
+}
+
+
+
+void BookTree::build( const std::string & databaseFilename )
+{
+  // The file index sorts the ISBNs and remembers where each record is, so books can be read back one at a time in ISBN order
+  BookFileIndex index( databaseFilename );
+  Builder       builder( treeFilename( databaseFilename ) );
+
+  for( std::size_t position = 0; position < index.size(); ++position )
+  {
+    if( auto book = index.read( position ) ) builder.add( *book );
+  }
+
+  const auto source = headerFor( databaseFilename );
+  builder.finish( source.databaseSize, source.databaseTime );
+}
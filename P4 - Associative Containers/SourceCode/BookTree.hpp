@@ -0,0 +1,144 @@
+#pragma once
+
+#include <array>
+#include <cstddef>    // size_t
+#include <cstdint>    // int64_t, uint32_t, uint64_t
+#include <fstream>
+#include <memory>     // shared_ptr, unique_ptr
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>    // pair
+#include <vector>
+
+#include "Book.hpp"
+
+
+
+// A B+tree of books keyed by ISBN, held in a file of fixed size pages and read through a cache of a bounded number of pages, so a
+// catalog far larger than memory can be searched.  A lookup reads one page per level of the tree, usually three or fewer, and the
+// upper levels are nearly always cached.
+//
+// File layout:  page 0 is a header.  Leaves hold books in ISBN order, each book's record stored in the leaf itself, or if too long
+// for that, in an overflow run of consecutive pages the leaf refers to.  Interior pages hold the first ISBN beneath each child.  A
+// directory after the tree lists every leaf with the id of its first book, so books can also be found by their position in ISBN
+// order.  A tree is written once, bottom up, from books arriving in ISBN order, and never modified.
+//
+// Thread safety:  Any number of threads may look up books at the same time.  Pages are spread over shards of the cache by page number,
+// each with its own lock, and a page not cached is read without holding any, through a file handle no other thread is using.  So a
+// lookup waiting on the disk holds up no other, not even one for the same page, which reads it too.
+class BookTree
+{
+  public:
+    // Types
+    struct Format_Ex : std::runtime_error     { using runtime_error   ::runtime_error;    };  // Thrown if a file isn't a book tree
+    struct Order_Ex  : std::invalid_argument  { using invalid_argument::invalid_argument; };  // Thrown if books arrive out of order
+
+    static constexpr std::size_t PAGE_SIZE           = 4'096;
+    static constexpr std::size_t DEFAULT_CACHE_PAGES = 256;                     // 1 MB
+    static constexpr std::size_t CACHE_SHARDS        = 16;                      // the cache pages are split among, at least one each
+    static constexpr std::size_t MAX_ISBN_LENGTH     = 256;                     // longer ISBNs are rejected with std::length_error
+
+    struct CacheStatistics
+    {
+      std::size_t hits   = 0;                                                   // pages found in the cache
+      std::size_t misses = 0;                                                   // pages read from the file
+    };
+
+    class Builder                                                               // Writes a tree from books in increasing ISBN order,
+    {                                                                           // holding only about one leaf's worth in memory, and
+      public:                                                                   // one ISBN per leaf
+        Builder( const std::string & filename );
+
+        void add   ( const Book & book );
+        void finish( std::uint64_t databaseSize = 0, std::int64_t databaseTime = 0 );  // Records the database file the books came
+                                                                                        // from, see isCurrent()
+      private:
+        std::uint32_t writePage ( std::string_view contents );                  // Returns the page's number
+        void          writeLeaf ();
+
+        std::ofstream                                       _file;
+        std::uint32_t                                       _pageCount = 1;     // page 0 is written last
+        std::vector<std::string>                            _entries;           // the leaf being filled
+        std::size_t                                         _entryBytes = 0;
+        std::string                                         _lastIsbn;
+        std::uint64_t                                       _bookCount  = 0;
+        std::vector<std::pair<std::string, std::uint32_t>>  _leaves;            // each leaf's first ISBN and page
+        std::vector<std::uint32_t>                          _leafFirstIds;
+    };
+
+
+    // Constructors
+    BookTree( const std::string & filename, std::size_t cachePages = DEFAULT_CACHE_PAGES );
+
+    BookTree            ( const BookTree & ) = delete;
+    BookTree & operator=( const BookTree & ) = delete;
+
+    // Queries
+    std::optional<Book> find           ( std::string_view isbn ) const;
+    std::optional<Book> at             ( std::size_t id        ) const;         // The book at position id in ISBN order
+    std::size_t         idOf           ( std::string_view isbn ) const;         // The book's position in ISBN order, size() if
+                                                                                // not found
+    std::size_t         size           ()                        const;
+    std::vector<std::string> isbns()                             const;         // Every ISBN in order, reading each leaf but no
+                                                                                // record
+    std::size_t         height         ()                        const;         // Pages read by a lookup, overflow aside
+    CacheStatistics     cacheStatistics()                        const;
+
+    // Tree files built from database files
+    static std::string treeFilename( const std::string & databaseFilename );    // Returns the tree file's name for a database file
+    static bool        isCurrent   ( const std::string & databaseFilename );    // Whether the tree file exists and was built from the
+                                                                                // database file as it is now
+    static void        build       ( const std::string & databaseFilename );    // Writes the tree file for a database file.  Only
+                                                                                // the ISBNs are held in memory.
+  private:
+    using Page    = std::array<char, PAGE_SIZE>;
+    using PageRef = std::shared_ptr<const Page>;                                // valid for as long as it's held, evicted or not
+
+    PageRef             page( std::uint32_t number ) const;                     // Reads the page if it isn't cached
+    void                read( std::uint32_t number, Page & page ) const;
+    std::optional<Book> book( const char * leaf, std::size_t entry ) const;
+
+    struct Location
+    {
+      PageRef       leaf;                                                       // null if not found
+      std::uint32_t page  = 0;
+      std::size_t   entry = 0;
+    };
+    Location            locate( std::string_view isbn ) const;
+
+    std::uint64_t              _bookCount = 0;
+    std::uint32_t              _root      = 0;
+    std::uint32_t              _height    = 0;
+    std::vector<std::uint32_t> _leafFirstIds;                                   // the directory, in ISBN order
+    std::vector<std::uint32_t> _leafPages;
+
+    // The page cache.  Frames are reclaimed by the CLOCK algorithm:  a hand sweeps the shard's frames, sparing those used since it
+    // last passed, and takes the first that wasn't.
+    struct Frame
+    {
+      std::uint32_t number     = 0;
+      PageRef       page;
+      bool          referenced = false;
+    };
+
+    struct alignas( 64 ) Shard
+    {
+      std::mutex                                       mutex;
+      std::unordered_map<std::uint32_t, std::size_t>   frameOf;                 // page number to frame
+      std::vector<Frame>                               frames;                  // grows to _shardPages
+      std::size_t                                      hand = 0;
+      CacheStatistics                                  statistics;
+    };
+
+    std::size_t                                         _shardPages;
+    mutable std::array<Shard, CACHE_SHARDS>             _shards;
+
+    // Handles on the file, each used by one reader at a time.  There are as many as readers have ever read at once.
+    std::string                                         _filename;
+    mutable std::mutex                                  _filesMutex;
+    mutable std::vector<std::unique_ptr<std::ifstream>> _files;
+};
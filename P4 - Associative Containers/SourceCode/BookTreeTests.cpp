@@ -0,0 +1,166 @@
+#include <atomic>
+#include <cstddef>    // size_t
+#include <exception>
+#include <filesystem> // remove(), temp_directory_path()
+#include <iomanip>    // setprecision()
+#include <iostream>   // boolalpha(), showpoint(), fixed()
+#include <stdexcept>  // length_error
+#include <string>     // to_string()
+#include <thread>
+#include <vector>
+
+#include "Book.hpp"
+#include "BookTree.hpp"
+#include "CheckResults.hpp"
+
+
+
+
+
+namespace  // anonymous
+{
+  class BookTreeRegressionTest
+  {
+    public:
+      BookTreeRegressionTest();
+
+    private:
+      void tests();
+
+      Regression::CheckResults affirm;
+  } run_bookTree_tests;
+
+
+
+
+  void BookTreeRegressionTest::tests()
+  {
+    const auto filename = ( std::filesystem::temp_directory_path() / "BookTreeTests.bpt" ).string();
+
+    // Long ISBNs fill pages quickly, so even a few thousand books need several levels
+    const auto isbnOf = []( std::size_t i ) { auto number = std::to_string( i ); return std::string( 250 - number.size(), '0' ) + number; };
+    const auto bookOf = [&]( std::size_t i ) { return Book( "Title " + std::to_string( i ), "Author " + std::to_string( i % 17 ), isbnOf( i ), static_cast<double>( i ) / 4 ); };
+
+    constexpr std::size_t BOOKS = 2'000;
+    constexpr std::size_t LARGE = 1'234;                                        // too long to fit in a leaf
+
+    {
+      BookTree::Builder builder( filename );
+      for( std::size_t i = 0; i < BOOKS; ++i )
+      {
+        auto book = bookOf( i );
+        if( i == LARGE ) book.title( std::string( 3 * BookTree::PAGE_SIZE, 'x' ) );
+        builder.add( book );
+      }
+
+      bool rejected = false;
+      try { builder.add( bookOf( 0 ) ); } catch( const BookTree::Order_Ex & ) { rejected = true; }
+      affirm.is_true( "Book tree - books out of order rejected",    rejected );
+
+      rejected = false;
+      try { builder.add( Book( "", "", std::string( BookTree::MAX_ISBN_LENGTH + 1, '9' ) ) ); } catch( const std::length_error & ) { rejected = true; }
+      affirm.is_true( "Book tree - overly long ISBN rejected",      rejected );
+
+      builder.finish();
+    }
+
+    {
+      const BookTree tree( filename, 4 );                                      // far fewer pages than the tree has
+      affirm.is_equal( "Book tree - size",                          BOOKS, tree.size() );
+      affirm.is_equal( "Book tree - height",                        3ULL, tree.height() );
+
+      bool allFound = true;
+      for( std::size_t i = 0; i < BOOKS; i += 7 )
+      {
+        auto book = tree.find( isbnOf( i ) );
+        allFound = allFound && book && ( i == LARGE || *book == bookOf( i ) ) && tree.idOf( isbnOf( i ) ) == i;
+      }
+      affirm.is_true ( "Book tree - books found",                   allFound );
+
+      auto large = tree.find( isbnOf( LARGE ) );
+      affirm.is_true ( "Book tree - overflowing record read",       large && large->title() == std::string( 3 * BookTree::PAGE_SIZE, 'x' ) && large->price() > 0 );
+
+      affirm.is_true ( "Book tree - missing books not found",       !tree.find( isbnOf( BOOKS ) ) && !tree.find( "" ) && !tree.find( isbnOf( 5 ) + '0' ) );
+      affirm.is_equal( "Book tree - missing book's id",             BOOKS, tree.idOf( isbnOf( BOOKS ) ) );
+
+      auto last = tree.at( BOOKS - 1 );
+      affirm.is_true ( "Book tree - books found by id",             tree.at( 0 ) && *tree.at( 0 ) == bookOf( 0 ) && last && *last == bookOf( BOOKS - 1 ) );
+      affirm.is_true ( "Book tree - ids past the end not found",    !tree.at( BOOKS ) );
+
+      const auto before = tree.cacheStatistics();
+      const auto isbns  = tree.isbns();
+      bool       listed = isbns.size() == BOOKS;
+      for( std::size_t i = 0; listed && i < BOOKS; ++i ) listed = isbns[i] == isbnOf( i );
+      affirm.is_true ( "Book tree - ISBNs listed in order",         listed );
+      affirm.is_true ( "Book tree - ISBNs listed around the cache", tree.cacheStatistics().hits == before.hits && tree.cacheStatistics().misses == before.misses );
+
+    }
+
+    {
+      // Threads looking books up at once, through a cache far too small for them, each find every book, though the pages they're
+      // reading are evicted by the others as they go
+      const BookTree           tree( filename, 1 );
+      std::atomic<std::size_t> found{ 0 };
+      std::vector<std::thread> readers;
+      for( std::size_t reader = 0; reader < 4; ++reader ) readers.emplace_back( [&, reader]
+      {
+        for( std::size_t i = reader; i < BOOKS; i += 3 )
+        {
+          auto book = tree.find( isbnOf( i ) );
+          if( book && ( i == LARGE || *book == bookOf( i ) ) && tree.at( i ) && tree.at( i )->isbn() == isbnOf( i ) ) ++found;
+        }
+      } );
+      for( auto & reader : readers ) reader.join();
+
+      std::size_t expected = 0;
+      for( std::size_t reader = 0; reader < 4; ++reader ) expected += ( BOOKS - reader + 2 ) / 3;
+      affirm.is_equal( "Book tree - concurrent lookups",            expected, found.load() );
+    }
+
+    {
+      // With room to cache them, finding the same book again reads no pages
+      const BookTree tree( filename );
+      tree.find( isbnOf( 42 ) );
+      const auto before = tree.cacheStatistics();
+      tree.find( isbnOf( 42 ) );
+      const auto after  = tree.cacheStatistics();
+      affirm.is_equal( "Book tree - pages read once",               tree.height(), before.misses );
+      affirm.is_equal( "Book tree - cached pages reused",           before.misses, after.misses );
+      affirm.is_equal( "Book tree - every page used counted",       before.hits + tree.height(), after.hits );
+    }
+
+    {
+      BookTree::Builder( filename ).finish();
+      const BookTree empty( filename );
+      affirm.is_equal( "Book tree - empty",                         0ULL, empty.size() );
+      affirm.is_true ( "Book tree - nothing found when empty",      !empty.find( isbnOf( 0 ) ) && !empty.at( 0 ) );
+    }
+
+    std::filesystem::remove( filename );
+
+    bool rejected = false;
+    try { BookTree tree( filename ); } catch( const BookTree::Format_Ex & ) { rejected = true; }
+    affirm.is_true( "Book tree - missing file rejected",            rejected );
+  }
+
+
+
+  BookTreeRegressionTest::BookTreeRegressionTest()
+  {
+    std::clog << std::boolalpha << std::showpoint << std::fixed << std::setprecision( 2 );
+
+
+    try
+    {
+      std::clog << "\nBook Tree Regression Test:\n";
+      tests();
+
+      std::clog << affirm << '\n';
+    }
+    catch( const std::exception & ex )
+    {
+      std::clog << "FAILURE:  Regression test for \"class BookTree\" failed with an unhandled exception. \n\n\n"
+                << ex.what() << std::endl;
+    }
+  }
+} // namespace
@@ -1,19 +1,45 @@
 ///////////////////////// TO-DO (1) //////////////////////////////
   /// Include necessary header files
   /// Hint:  Include what you use, use what you include
+#include <algorithm>   // max(), min()
+#include <chrono>      // steady_clock
+#include <cstddef>     // size_t, ptrdiff_t
+#include <exception>   // exception_ptr, current_exception(), rethrow_exception()
 #include <fstream>
+#include <future>      // future, shared_future
 #include <iomanip>
+#include <iostream>
+#include <memory>      // make_shared(), make_unique()
+#include <mutex>
+#include <string_view>
+#include <thread>      // hardware_concurrency()
+#include <utility>     // exchange(), move()
+#include <vector>
 
 #include "BookDatabase.hpp"
 #include "Bookstore.hpp"
+#include "InventoryJournal.hpp"
+#include "InventoryStore.hpp"
+#include "ParallelFor.hpp"
+#include "Receipt.hpp"
+#include "SpscRing.hpp"
+#include "ThreadPool.hpp"
 /////////////////////// END-TO-DO (1) ////////////////////////////
 
 
 
 
 
-Bookstore::Bookstore( const std::string & persistenyInventoryDB )
+Bookstore::Bookstore( const std::string & persistenyInventoryDB, bool journaled )
 {
+  if( journaled )
+  {
+    _inventoryDB = InventoryJournal::recover( persistenyInventoryDB );
+    _journal     = std::make_unique<InventoryJournal>( persistenyInventoryDB );
+    stockFromInventory();
+    return;
+  }
+
   std::ifstream fin( persistenyInventoryDB );                     // Creates the stream object, and then opens the file if it can
                                                                   // The file is closed as fin goes out of scope
 
@@ -39,6 +65,8 @@ Bookstore::Bookstore( const std::string & persistenyInventoryDB )
   }
 
   /////////////////////// END-TO-DO (2) ////////////////////////////
+
+  stockFromInventory();
 }                                                                 // File is closed as fin goes out of scope
 
 
@@ -49,21 +77,88 @@ Bookstore::Bookstore( const std::string & persistenyInventoryDB )
 
 Bookstore::Inventory_DB & Bookstore::inventory()
 {
+  _inventoryHandedOut = true;
   return _inventoryDB;
 }
 
 
 
+const Bookstore::Inventory_DB & Bookstore::inventory() const
+{
+  return _inventoryDB;
+}
+
 
 
 
 
-Bookstore::BooksSold Bookstore::processCustomerShoppingCarts( const ShoppingCarts & shoppingCarts )
+
+void Bookstore::reconcile()
 {
-  auto & worldWideBookDatabase = BookDatabase::instance();        // Get a reference to the database of all books in the world. The
-                                                                  // database will contains a full description of the item and the
-                                                                  // item's price.
+  if( !_inventoryHandedOut ) return;
+
+  // The inventory and the stock are both in ISBN order, so they're walked side by side.  A quantity other than the one last set in
+  // the inventory was changed directly, a book stocked but no longer in the inventory was erased directly, and a book in the
+  // inventory that was never stocked was added directly, which only building the stock afresh takes in.  The inventory may still be
+  // changed through the reference handed out, so it's looked at again next time.
+  auto noteQuantity = [&]( const std::string & isbn, unsigned int quantity )
+  {
+    if( quantity < REORDER_THRESHOLD ) _belowThreshold.insert( isbn );
+    else                               _belowThreshold.erase ( isbn );
+  };
+
+  auto & stock = *_stock;
+  auto   shown = _inventoryDB.cbegin();
+  bool   added = false;
+  for( std::size_t slot = 0; slot < stock.size(); ++slot )
+  {
+    const auto & isbn = stock.isbn( slot );
+    for( ; shown != _inventoryDB.cend() && shown->first < isbn; ++shown, added = true ) noteQuantity( shown->first, shown->second );
+
+    if( shown != _inventoryDB.cend() && shown->first == isbn )
+    {
+      if( shown->second != _shown[slot] || stock.discontinued( slot ) )
+      {
+        stock.set( slot, shown->second );
+        _shown[slot] = shown->second;
+        noteQuantity( isbn, shown->second );
+      }
+      ++shown;
+    }
+    else if( !stock.discontinued( slot ) )
+    {
+      stock.discontinue( slot );
+      _belowThreshold.erase ( isbn );
+      _delisted      .insert( isbn );
+    }
+  }
+  for( ; shown != _inventoryDB.cend(); ++shown, added = true ) noteQuantity( shown->first, shown->second );
+
+  if( added ) stockFromInventory();
+}
+
+
+
+
+
+
+void Bookstore::stockFromInventory()
+{
+  _stock = std::make_shared<InventoryStore>( _inventoryDB, REORDER_THRESHOLD );
+
+  _shown.clear();
+  _shown.reserve( _inventoryDB.size() );
+  for( const auto & [isbn, quantity] : _inventoryDB ) _shown.push_back( quantity );
+}
+
+
+
 
+
+
+
+Bookstore::BooksSold Bookstore::processCustomerShoppingCarts( const ShoppingCarts & shoppingCarts )
+{
   BooksSold todaysSales;                                          // a collection of unique ISBNs of books sold
 
 
@@ -85,40 +180,338 @@ Bookstore::BooksSold Bookstore::processCustomerShoppingCarts( const ShoppingCart
     ///        1.2.2.3.2              Add the book's isbn to the list of books sold today
     ///        1.3         Print the total amount due on the receipt
 
-  for( auto & [name, cart] : shoppingCarts )
+  // The carts are laid out flat first, so the registers walk arrays rather than trees of trees
+  todaysSales = processCustomerShoppingCarts( CartBatch( shoppingCarts ) );
+
+  /////////////////////// END-TO-DO (3) ////////////////////////////
+
+  return todaysSales;
+} // processCustomerShoppingCarts
+
+
+
+
+
+
+
+Bookstore::BooksSold Bookstore::processCustomerShoppingCarts( const CartBatch & shoppingCarts )
+{
+  std::unique_lock<std::mutex> recording( _recordingMutex, std::defer_lock );
+  if( _recorder ) recording.lock();
+
+  // Books are taken from the store's lock-free stock as they're sold, so however many carts, and batches of carts, are checked out
+  // at once, no book is sold twice and no quantity drops below zero.  A book sold out is still charged, since the customer has it in
+  // hand, but its quantity stays at zero.  The inventory is brought up to date once every cart is checked out.
+  std::shared_ptr<InventoryStore> stock;
+  {
+    std::lock_guard<std::mutex> bookkeeping( _bookkeepingMutex );
+    reconcile();
+    stock = _stock;
+    if( _recorder ) _recorder->before( shoppingCarts, _inventoryDB, { _resolveMistypedIsbns, _reorderAsSold } );
+  }
+
+  BooksSold                todaysSales;
+  std::vector<std::string> sold;
+  auto recordSales = [&]
+  {
+    for( auto & isbn : sold )
+    {
+      if( _journal ) _journal->record( { InventoryJournal::Change::Kind::SALE, isbn, 1 } );
+      todaysSales.insert( std::move( isbn ) );
+    }
+    sold.clear();
+  };
+
+  std::vector<std::uint64_t>      latencies( _timeCheckouts ? shoppingCarts.size() : 0 );
+  std::vector<SpscRingStatistics> statistics;
+  auto ringUp = [&]( std::size_t index, std::vector<std::string> & soldFrom )
+  {
+    if( !_timeCheckouts ) return checkout( shoppingCarts[index], *stock, soldFrom );
+
+    const auto start   = std::chrono::steady_clock::now();
+    auto       receipt = checkout( shoppingCarts[index], *stock, soldFrom );
+    latencies[index] = static_cast<std::uint64_t>( std::chrono::duration_cast<std::chrono::nanoseconds>( std::chrono::steady_clock::now() - start ).count() );
+    return receipt;
+  };
+
+  // Receipts are rung up first and printed apart, in bulk, so formatting them doesn't hold up the registers
+  ReceiptWriter receipts( std::cout, ReceiptWriter::Format::TEXT, ReceiptWriter::DEFAULT_BUFFER_SIZE, &_printerMutex );
+
+  if( _pipelineCheckouts )
+  {
+    statistics = checkoutPipelined( shoppingCarts, *stock, receipts, sold, latencies );
+    recordSales();
+  }
+  else if( _checkoutThreads == 1 || shoppingCarts.size() < 2 )
+  {
+    for( std::size_t index = 0; index < shoppingCarts.size(); ++index )
+    {
+      receipts.write( ringUp( index, sold ) );
+      recordSales();
+    }
+  }
+  else
+  {
+    // Carts are checked out in any order and each worker remembers what it sold.  Then the receipts are printed in the carts' order
+    // and the sales recorded.  No cart's receipt depends on the inventory, so the result is the same as checking out one cart at a
+    // time.
+    const auto workers = _checkoutThreads == 0 ? std::max( 1U, std::thread::hardware_concurrency() ) : _checkoutThreads;
+    std::vector<Receipt>                  rungUp( shoppingCarts.size() );
+    std::vector<std::vector<std::string>> soldBy( std::min( workers, shoppingCarts.size() ) );
+
+    parallelFor( shoppingCarts.size(), soldBy.size(), [&]( std::size_t worker, std::size_t index )
+    {
+      rungUp[index] = ringUp( index, soldBy[worker] );
+    } );
+
+    for( const auto & receipt : rungUp ) receipts.write( receipt );
+
+    for( auto & workerSold : soldBy )
+    {
+      sold = std::move( workerSold );
+      recordSales();
+    }
+  }
+  receipts.flush();
+
+  // Every sale is on disk before the inventory shows it.  Syncing once for all the carts keeps the cost to each sale small.
+  if( _journal ) _journal->commit();
+
+  {
+    std::lock_guard<std::mutex> bookkeeping( _bookkeepingMutex );
+
+    // Only the books sold have changed, unless the stock was built afresh meanwhile, in which case their sales are lost with it
+    if( stock == _stock ) for( const auto & isbn : todaysSales )
+    {
+      auto slot  = stock->find( isbn );
+      auto shown = _inventoryDB.find( isbn );
+      if( slot != InventoryStore::npos && shown != _inventoryDB.end() ) shown->second = _shown[slot] = stock->available( slot );
+    }
+
+    // The books these carts left running low are the only ones that may need re-ordering
+    std::vector<std::size_t> belowThreshold;
+    stock->takeBelowThreshold( belowThreshold );
+    for( auto belowSlot : belowThreshold ) _belowThreshold.insert( stock->isbn( belowSlot ) );
+
+    _checkoutLatencies = std::move( latencies );
+    if( _pipelineCheckouts ) _pipelineStatistics = std::move( statistics );
+  }
+
+  if( _reorderAsSold ) dispatchReorders();
+
+  if( _recorder )
+  {
+    std::lock_guard<std::mutex> bookkeeping( _bookkeepingMutex );
+    _recorder->after( todaysSales, _inventoryDB );
+  }
+
+  return todaysSales;
+}
+
+
+
+
+
+
+
+Receipt Bookstore::checkout( const CartBatch::Cart & cart, InventoryStore & stock, std::vector<std::string> & sold ) const
+{
+  auto & worldWideBookDatabase = BookDatabase::instance();        // Get a reference to the database of all books in the world. The
+                                                                  // database will contains a full description of the item and the
+                                                                  // item's price.
+
+  thread_local std::vector<std::string_view> isbns;               // reused from cart to cart to avoid reallocating
+
+  // Look up every book in the cart as a batch so the database can overlap the lookups' memory latency.  The snapshot keeps the
+  // books found valid while they're copied onto the receipt even if the database is reloaded meanwhile.
+  isbns.clear();
+  for( auto & item : cart ) isbns.push_back( item.isbn() );
+  auto catalog = worldWideBookDatabase.snapshot();
+  auto books   = catalog.findMany( isbns );
+
+  auto receipt = price( cart, books.cbegin(), catalog );
+  takeFromStock( receipt, stock, sold );
+  return receipt;
+}
+
+
+
+
+
+
+
+Receipt Bookstore::price( const CartBatch::Cart & cart, std::vector<Book *>::const_iterator books, const BookDatabase::Snapshot & catalog ) const
+{
+  Receipt receipt;
+  receipt.customer = cart.name();
+  receipt.lines.reserve( cart.size() );
+
+  for( auto & item : cart )
   {
-    std::cout << name << "'s shopping cart contains:\n";
-    double amountDue = 0;
+    Book * book_ptr = *books++;
+    bool   resolved = false;
 
-    for( auto & [isbn, book] : cart )
+    if( book_ptr == nullptr && _resolveMistypedIsbns )
     {
-      Book * book_ptr = worldWideBookDatabase.find( isbn );
+      book_ptr = catalog.resolveIsbn( std::string( item.isbn() ) );
+      resolved = book_ptr != nullptr;
+    }
 
+    // Each copy is a line of its own, and taken from stock on its own, so copies beyond those on hand are still charged
+    for( unsigned int copy = 0; copy < item.quantity(); ++copy )
+    {
       if( book_ptr == nullptr )
       {
-        std::cout << '\t' << isbn << "\", (" << book.title() << ") not found, book is free! \n";
+        receipt.lines.emplace_back( Receipt::Status::NOT_FOUND, item.isbn(), Book( item.title() ) );
+        continue;
       }
-      else
+
+      receipt.lines.emplace_back( resolved ? Receipt::Status::RESOLVED : Receipt::Status::FOUND, item.isbn(), *book_ptr );
+      receipt.total += book_ptr->price();
+    }
+  }
+
+  return receipt;
+}
+
+
+
+
+
+
+
+void Bookstore::takeFromStock( const Receipt & receipt, InventoryStore & stock, std::vector<std::string> & sold )
+{
+  // Books are set aside line by line and sold once every line is.  Should that fail part way, those set aside are put back as the
+  // reservations are destroyed.
+  std::vector<InventoryStore::Reservation> reservations;
+
+  for( const auto & line : receipt.lines )
+  {
+    if( line.status == Receipt::Status::NOT_FOUND ) continue;
+
+    if( auto slot = stock.find( line.isbn ); slot != InventoryStore::npos )
+    {
+      reservations.push_back( stock.reserve( slot ) );                     // nothing reserved if sold out
+      sold.push_back( line.isbn );
+    }
+  }
+
+  for( auto & reservation : reservations ) reservation.commit();
+}
+
+
+
+
+
+
+
+std::vector<SpscRingStatistics> Bookstore::checkoutPipelined( const CartBatch & shoppingCarts, InventoryStore & stock, ReceiptWriter & receipts,
+                                                              std::vector<std::string> & sold, std::vector<std::uint64_t> & latencies )
+{
+  using Clock = std::chrono::steady_clock;
+
+  struct Scanned
+  {
+    std::size_t                   cart = 0;
+    Clock::time_point             scanned;
+    std::vector<std::string_view> isbns;
+  };
+
+  struct RungUp
+  {
+    std::size_t       cart = 0;
+    Clock::time_point scanned;
+    Receipt           receipt;
+  };
+
+  SpscRing<Scanned> toPrice   ( PIPELINE_DEPTH );
+  SpscRing<RungUp>  toStock   ( PIPELINE_DEPTH );
+  SpscRing<RungUp>  toReceipts( PIPELINE_DEPTH );
+
+  // Each stage closes the queues on both sides of it as it finishes, however it finishes, so the stage after it sees the end of the
+  // carts and the stage before it stops.  Anything a stage threw is rethrown once every stage has finished.
+  std::exception_ptr scanFailed, priceFailed, stockFailed, receiptFailed;
+
+  auto & pool    = ThreadPool::shared();
+  auto   scanner = pool.submit( [&]
+  {
+    try
+    {
+      for( std::size_t index = 0; index < shoppingCarts.size(); ++index )
+      {
+        Scanned scanned{ index, Clock::now(), {} };
+        for( auto & item : shoppingCarts[index] ) scanned.isbns.push_back( item.isbn() );
+        if( !toPrice.push( std::move( scanned ) ) ) break;
+      }
+    }
+    catch( ... ) { scanFailed = std::current_exception(); }
+    toPrice.close();
+  } );
+
+  auto pricer = pool.submit( [&]
+  {
+    try
+    {
+      // The carts waiting are looked up in one batch, up to PRICE_BATCH of them, but a cart is never held back for others to join it
+      std::vector<Scanned>          batch( PRICE_BATCH );
+      std::vector<std::string_view> isbns;
+
+      for( bool open = true; open && toPrice.pop( batch[0] ); )
       {
-        std::cout << '\t' << *book_ptr << '\n';
-        amountDue += book_ptr->price();
+        std::size_t carts = 1;
+        while( carts < PRICE_BATCH && toPrice.tryPop( batch[carts] ) ) ++carts;
 
-        if( auto it = _inventoryDB.find( book_ptr->isbn() ); it != _inventoryDB.end() )
+        isbns.clear();
+        for( std::size_t cart = 0; cart < carts; ++cart ) isbns.insert( isbns.end(), batch[cart].isbns.begin(), batch[cart].isbns.end() );
+        auto catalog = BookDatabase::instance().snapshot();
+        auto books   = catalog.findMany( isbns );
+
+        auto first = books.cbegin();
+        for( std::size_t cart = 0; open && cart < carts; ++cart )
         {
-          it->second -= 1;
-          todaysSales.insert( book_ptr->isbn() );
+          open   = toStock.push( { batch[cart].cart, batch[cart].scanned, price( shoppingCarts[batch[cart].cart], first, catalog ) } );
+          first += static_cast<std::ptrdiff_t>( batch[cart].isbns.size() );
         }
       }
     }
-    std::cout << std::fixed << std::setprecision( 2 ) << std::showpoint
-              << '\t' << std::string( 25, '-' ) << '\n'
-              << "\t Total  $" << amountDue << "\n\n\n";
+    catch( ... ) { priceFailed = std::current_exception(); }
+    toPrice.close();
+    toStock.close();
+  } );
+
+  auto stocker = pool.submit( [&]
+  {
+    try
+    {
+      for( RungUp rungUp; toStock.pop( rungUp ); )
+      {
+        takeFromStock( rungUp.receipt, stock, sold );
+        if( rungUp.cart < latencies.size() ) latencies[rungUp.cart] = static_cast<std::uint64_t>( std::chrono::duration_cast<std::chrono::nanoseconds>( Clock::now() - rungUp.scanned ).count() );
+        if( !toReceipts.push( std::move( rungUp ) ) ) break;
+      }
+    }
+    catch( ... ) { stockFailed = std::current_exception(); }
+    toStock.close();
+    toReceipts.close();
+  } );
+
+  // Receipts are printed on this thread, in the carts' order, since the queues keep the order the carts were scanned in
+  try
+  {
+    for( RungUp rungUp; toReceipts.pop( rungUp ); ) receipts.write( rungUp.receipt );
   }
+  catch( ... ) { receiptFailed = std::current_exception(); }
+  toReceipts.close();
 
-  /////////////////////// END-TO-DO (3) ////////////////////////////
+  scanner.wait();
+  pricer .wait();
+  stocker.wait();
 
-  return todaysSales;
-} // processCustomerShoppingCarts
+  for( const auto & failure : { scanFailed, priceFailed, stockFailed, receiptFailed } ) if( failure ) std::rethrow_exception( failure );
+
+  return { toPrice.statistics(), toStock.statistics(), toReceipts.statistics() };
+}
 
 
 
@@ -128,10 +521,6 @@ Bookstore::BooksSold Bookstore::processCustomerShoppingCarts( const ShoppingCart
 
 void Bookstore::reorderItems( BooksSold & todaysSales )
 {
-  auto & worldWideBookDatabase = BookDatabase::instance();        // Get a reference to the database of all books in the world. The
-                                                                  // database will contains a full description of the item and the
-                                                                  // item's price.
-
   ///////////////////////// TO-DO (4) //////////////////////////////
     /// For each product that has fallen below the reorder threshold, assume an order has been placed and now the shipment has
     /// arrived. Update the store's inventory to reflect the additional items on hand.
@@ -150,14 +539,66 @@ void Bookstore::reorderItems( BooksSold & todaysSales )
     ///        1.1.4.2             Increase the quantity on hand by the number of items ordered and received (LOT_COUNT)
     ///        2       Reset the list of book sold today so the list can be reused again later
 
+  // Sales noted the books they left below the threshold, and changes made directly to the inventory are taken in as they're found,
+  // so there's no need to look at every book sold.  Only the books noted that were among these sales are taken, the rest wait for
+  // the sales they were part of.  A book sold and since delisted is reported too, so no one waits on a shipment that isn't coming.
+  std::scoped_lock bookkeeping( _bookkeepingMutex, _printerMutex );
+  reconcile();
+
+  BooksSold candidates;
+  for( auto isbn = _belowThreshold.begin(); isbn != _belowThreshold.end(); )
+  {
+    if( todaysSales.count( *isbn ) == 0 ) ++isbn;
+    else                                  candidates.insert( _belowThreshold.extract( isbn++ ) );
+  }
+  for( auto & isbn : _delisted ) if( todaysSales.count( isbn ) != 0 && _inventoryDB.count( isbn ) == 0 ) candidates.insert( isbn );
+
+  std::cout << "Re-ordering books the store is running low on.\n\n";
+  reorder( candidates );
+
+  todaysSales.clear();
+
+  /////////////////////// END-TO-DO (4) ////////////////////////////
+}
+
+
+
+
+
+
+
+std::size_t Bookstore::dispatchReorders()
+{
+  std::scoped_lock bookkeeping( _bookkeepingMutex, _printerMutex );
+  reconcile();
+
+  if( _belowThreshold.empty() ) return 0;
+
   std::cout << "Re-ordering books the store is running low on.\n\n";
-  int i = 1;
-  for( std::string isbn : todaysSales )
+  return reorder( std::exchange( _belowThreshold, {} ) );
+}
+
+
+
+
+
+
+
+std::size_t Bookstore::reorder( const BooksSold & isbns )
+{
+  auto & worldWideBookDatabase = BookDatabase::instance();        // Get a reference to the database of all books in the world. The
+                                                                  // database will contains a full description of the item and the
+                                                                  // item's price.
+
+  int         i         = 1;
+  std::size_t reordered = 0;
+  auto        catalog   = worldWideBookDatabase.snapshot();
+  for( const auto & isbn : isbns )
   {
-    auto it = _inventoryDB.find( isbn );
-    if( it == _inventoryDB.end() || it->second < REORDER_THRESHOLD )
+    auto slot = _stock->find( isbn );
+    if( slot == InventoryStore::npos || _stock->available( slot ) < REORDER_THRESHOLD )        // it may have been restocked since
     {
-      auto book = worldWideBookDatabase.find( isbn );
+      auto book = catalog.find( isbn );
       if( book == nullptr )
       {
         std::cout << ' ' << i << ":  {" << isbn << "}\n\n";
@@ -167,19 +608,149 @@ void Bookstore::reorderItems( BooksSold & todaysSales )
         std::cout << ' ' << i << ":  {" << *book << "}\n\n";
       }
       i++;
-      if( it == _inventoryDB.end() )
+      if( slot == InventoryStore::npos )
       { std::cout << "        *** no longer sold in this store and will not be re-ordered\n"; }
       else
       {
-        std::cout << "        only " << it->second << " remain in stock which is " << ( REORDER_THRESHOLD - it->second ) << " unit(s) below reorder threshold (" << REORDER_THRESHOLD << "), re-ordering " << LOT_COUNT << " more\n";
-        it->second += LOT_COUNT;
+        const auto onHand = _stock->available( slot );
+        std::cout << "        only " << onHand << " remain in stock which is " << ( REORDER_THRESHOLD - onHand ) << " unit(s) below reorder threshold (" << REORDER_THRESHOLD << "), re-ordering " << LOT_COUNT << " more\n";
+        _stock->restock( slot, LOT_COUNT );
+        _inventoryDB.at( isbn ) = _shown[slot] = _stock->available( slot );
+        ++reordered;
+        if( _journal ) _journal->record( { InventoryJournal::Change::Kind::RESTOCK, isbn, LOT_COUNT } );
       }
     }
   }
+  if( _journal ) _journal->commit();
 
-  todaysSales.clear();
+  return reordered;
+}
 
-  /////////////////////// END-TO-DO (4) ////////////////////////////
+
+
+
+
+
+
+void Bookstore::resolveMistypedIsbns( bool enabled )
+{
+  _resolveMistypedIsbns = enabled;
+}
+
+
+
+
+
+
+
+void Bookstore::delist( const std::string & isbn )
+{
+  std::lock_guard<std::mutex> bookkeeping( _bookkeepingMutex );
+  reconcile();
+
+  if( auto slot = _stock->find( isbn ); slot != InventoryStore::npos ) _stock->discontinue( slot );
+  _inventoryDB   .erase ( isbn );
+  _belowThreshold.erase ( isbn );
+  _delisted      .insert( isbn );
+  if( _journal )
+  {
+    _journal->record( { InventoryJournal::Change::Kind::DELIST, isbn, 0 } );
+    _journal->commit();
+  }
+}
+
+
+
+
+
+
+
+std::shared_future<void> Bookstore::compactJournal()
+{
+  if( !_journal ) return {};
+
+  std::lock_guard<std::mutex> bookkeeping( _bookkeepingMutex );
+  reconcile();
+  return _journal->compact( _inventoryDB );
+}
+
+
+
+
+
+
+
+void Bookstore::reorderAsSold( bool enabled )
+{
+  _reorderAsSold = enabled;
+}
+
+
+
+
+
+
+
+void Bookstore::checkoutThreads( std::size_t count )
+{
+  _checkoutThreads = count;
+}
+
+
+
+
+
+
+
+void Bookstore::timeCheckouts( bool enabled )
+{
+  _timeCheckouts = enabled;
+}
+
+
+
+
+
+
+
+void Bookstore::pipelineCheckouts( bool enabled )
+{
+  _pipelineCheckouts = enabled;
+}
+
+
+
+
+
+
+
+const std::vector<std::uint64_t> & Bookstore::checkoutLatencies() const
+{
+  return _checkoutLatencies;
+}
+
+
+
+
+
+
+
+const std::vector<SpscRingStatistics> & Bookstore::pipelineStatistics() const
+{
+  return _pipelineStatistics;
+}
+
+
+
+
+
+
+
+void Bookstore::recordCheckouts( const std::string & captureFile )
+{
+  std::lock_guard<std::mutex> recording( _recordingMutex );
+  _recorder.reset();
+  if( !captureFile.empty() ) _recorder = std::make_unique<CheckoutRecorder>( captureFile );
 }
 
 
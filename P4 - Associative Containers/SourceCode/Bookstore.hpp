@@ -1,10 +1,24 @@
 #pragma once
 
+#include <atomic>
+#include <cstddef>   // size_t
+#include <cstdint>   // uint64_t
+#include <future>    // shared_future
 #include <map>
+#include <memory>    // shared_ptr, unique_ptr
+#include <mutex>
 #include <set>
 #include <string>
+#include <vector>
 
 #include "Book.hpp"
+#include "BookDatabase.hpp"
+#include "CheckoutCapture.hpp"
+#include "FlatCart.hpp"
+#include "InventoryJournal.hpp"
+#include "InventoryStore.hpp"
+#include "Receipt.hpp"
+#include "SpscRing.hpp"
 
 
 
@@ -25,10 +39,29 @@ class Bookstore
                                                                                       // is, this is a tree of trees.
 
     // Constructors, assignments, destructor
-    Bookstore( const std::string & persistenyInventoryDB = "BookstoreInventory.dat" );
+
+    // A journaled store opens with its inventory as it last left it, and journals each sale, re-order and book delisted as it happens
+    // so they outlast the program (see InventoryJournal.hpp).  Changes made directly to inventory() aren't journaled.
+    Bookstore( const std::string & persistenyInventoryDB = "BookstoreInventory.dat", bool journaled = false );
 
     // Queries
-    Inventory_DB & inventory();                                                       // Returns a reference to the store's one and only inventory database
+
+    // The inventory is a view of the stock carts are checked out against, brought up to date as each batch of carts is checked out
+    // and as books are re-ordered.  Once it's been handed out to be changed, changes made to it directly are looked for, and taken
+    // into the stock, whenever carts are checked out, books are re-ordered or delisted, or the journal compacted.  They mustn't be
+    // made while carts are being checked out.
+    Inventory_DB       & inventory();                                                 // Returns a reference to the store's one and only inventory database
+    const Inventory_DB & inventory() const;                                           // As above, for looking only, which spares each batch
+                                                                                      // looking for changes made directly
+
+    // Nanoseconds taken to ring up each cart the last time carts were checked out, in the carts' order, if timeCheckouts() is
+    // enabled, and empty otherwise.  Printing the receipts isn't included.  When pipelined, from when the cart was scanned to when
+    // its books were taken from stock, waiting between stages included.
+    const std::vector<std::uint64_t> & checkoutLatencies() const;
+
+    // How full each queue between the stages was kept the last time carts were checked out pipelined (see pipelineCheckouts()), in
+    // stage order:  scan to price, price to inventory, inventory to receipt
+    const std::vector<SpscRingStatistics> & pipelineStatistics() const;
 
 
     // Operations
@@ -37,18 +70,114 @@ class Bookstore
     // Returns a collection of ISBNs for books that have been sold
     BooksSold processCustomerShoppingCarts( const ShoppingCarts & shoppingCarts );
 
-    // Re-orders books sold that have fallen below the re-order threshold, then clears the reorder list
+    // As above, for carts laid out flat (see FlatCart.hpp), in the order they're in the batch.  A cart given as a map is laid out
+    // flat first.  Each copy of a book is a line on the receipt.
+    //
+    // Batches may be checked out on many threads at once, all selling from the one stock, so no book is sold twice.  Their receipts
+    // may be interleaved, a receipt at a time.  Batches recorded (see recordCheckouts()) are checked out one at a time.
+    BooksSold processCustomerShoppingCarts( const CartBatch & shoppingCarts );
+
+    // Re-orders books sold that have fallen below the re-order threshold, and reports those sold no longer in the inventory, then
+    // clears the reorder list.  Sales note the books they leave below the threshold as they happen, so only those among the sales
+    // given are looked at, along with any sold and since delisted, and those changed directly through inventory() count as if sold
+    // that way:  lowered below the threshold as noted, and erased as delisted.
     void reorderItems( BooksSold & todaysSales );
 
+    // Re-orders the books sold below the re-order threshold since last re-ordered right away, whatever sales they were part of,
+    // rather than waiting for the end of the day.  Books delisted aren't re-ordered, nor reported, here.  Returns how many were
+    // re-ordered.
+    std::size_t dispatchReorders();
+
+    // When enabled, books are re-ordered (see dispatchReorders()) as soon as the carts that sold them below the re-order threshold
+    // are checked out, instead of waiting for reorderItems().  Disabled by default.
+    void reorderAsSold( bool enabled );
+
     // Initializes a bunch of customers pushing shopping carts filled with groceries
     ShoppingCarts  makeShoppingCarts();
 
+    // When enabled, a book not found at checkout is charged as the book its ISBN was most likely mistyped from, if the database can
+    // tell (see BookDatabase::resolveIsbn()), and the receipt notes the ISBN scanned.  Disabled by default.
+    void resolveMistypedIsbns( bool enabled );
+
+    // Stops selling a book, removing it from the inventory and the books waiting to be re-ordered.  reorderItems() reports it as no
+    // longer sold whenever it's among the sales given.
+    void delist( const std::string & isbn );
+
+    // Writes a snapshot of the inventory in the background, after which the journal read when the store next opens starts afresh.
+    // The future is ready once the snapshot is written.  Returns an empty future unless the store is journaled.
+    std::shared_future<void> compactJournal();
+
+    // Check out this many carts at once on as many threads, or one per core if 0.  Receipts are printed in cart name order, and the
+    // inventory and books sold end up exactly as when checking out one cart at a time, which is the default (1).  The threads are
+    // the shared ThreadPool's (see ThreadPool.hpp), started by the first batch and kept for the next.
+    void checkoutThreads( std::size_t count );
+
+    // When enabled, checking out each cart is timed (see checkoutLatencies()).  Disabled by default.
+    void timeCheckouts( bool enabled );
+
+    // When enabled, carts are checked out by a pipeline of four stages, each on a thread of its own, handing carts on to the next
+    // through a bounded queue (see SpscRing.hpp):  scan gathers each cart's ISBNs, price looks up the books of the carts waiting in
+    // one batch and rings them up, inventory takes the books from stock, and receipt prints the receipts.  Looking up one cart's
+    // books overlaps printing the receipts of the carts ahead of it.  Receipts, inventory and books sold are exactly as when checking
+    // out one cart at a time.  The scan, price and inventory stages run on the shared ThreadPool's threads (see ThreadPool.hpp).
+    // Takes the place of checkoutThreads() while enabled.  Disabled by default.
+    void pipelineCheckouts( bool enabled );
+
+    // Records each batch of carts checked out from now on, with the inventory it was checked out against and what it sold, to the
+    // capture file given, replacing any there, for CheckoutReplayer to replay (see CheckoutCapture.hpp).  An empty filename stops
+    // recording.
+    void recordCheckouts( const std::string & captureFile );
+
 
   private:
     // Class attributes
     inline static constexpr unsigned int REORDER_THRESHOLD = 15;    // When the quantity on hand dips below this threshold, it's time to order more inventory
     inline static constexpr unsigned int LOT_COUNT         = 20;    // Number of items that can be ordered at one time
+    inline static constexpr std::size_t  PIPELINE_DEPTH    = 64;    // Carts each queue between pipeline stages holds
+    inline static constexpr std::size_t  PRICE_BATCH       = 16;    // Most carts the pipeline's price stage looks up at once
+
+    // Rings up one customer's cart, takes the books sold from stock, and appends the ISBN of each book sold that the store stocks.
+    // Touches nothing but its arguments, so many carts may be checked out at once against the same stock.
+    Receipt checkout( const CartBatch::Cart & cart, InventoryStore & stock, std::vector<std::string> & sold ) const;
+
+    // The two halves of checkout():  rings up the cart given its books as looked up in the catalog, one for each item, in order, then
+    // takes the books rung up from stock
+    Receipt     price        ( const CartBatch::Cart & cart, std::vector<Book *>::const_iterator books, const BookDatabase::Snapshot & catalog ) const;
+    static void takeFromStock( const Receipt & receipt, InventoryStore & stock, std::vector<std::string> & sold );
+
+    // Checks out every cart through the pipeline, appending the ISBN of each book sold that the store stocks, timing each cart if
+    // there's room for it in latencies.  Returns how full each queue between the stages was kept.
+    std::vector<SpscRingStatistics> checkoutPipelined( const CartBatch & shoppingCarts, InventoryStore & stock, ReceiptWriter & receipts,
+                                                       std::vector<std::string> & sold, std::vector<std::uint64_t> & latencies );
+
+    // Re-orders each of the books still below the re-order threshold, in ISBN order, and reports any no longer sold.  Returns how many
+    // were re-ordered.  _bookkeepingMutex and _printerMutex must be held.
+    std::size_t reorder( const BooksSold & isbns );
+
+    // Takes the changes made directly to the inventory since it was handed out into the stock.  _bookkeepingMutex must be held.
+    void reconcile();
+
+    // Builds the stock afresh from the inventory.  _bookkeepingMutex must be held.
+    void stockFromInventory();
 
     // Instance attributes
-    Inventory_DB       _inventoryDB;
+    std::shared_ptr<InventoryStore>   _stock;                         // sold from by every batch, built afresh only if books are
+                                                                      // added to the inventory directly
+    std::vector<unsigned int>         _shown;                         // each of _stock's books' quantity as last set in _inventoryDB
+    Inventory_DB                      _inventoryDB;                   // a view of _stock
+    std::unique_ptr<InventoryJournal> _journal;                       // null unless journaled
+    std::unique_ptr<CheckoutRecorder> _recorder;                      // null unless recording checkouts
+    BooksSold                         _belowThreshold;                // sold below REORDER_THRESHOLD and not yet re-ordered
+    BooksSold                         _delisted;                      // with delist(), so sales of them can be reported
+    std::atomic<bool>                 _inventoryHandedOut { false };  // inventory() may have been changed directly
+    std::mutex                        _bookkeepingMutex;              // guards everything above but _stock's quantities
+    std::mutex                        _recordingMutex;                // held while a batch is recorded
+    std::mutex                        _printerMutex;                  // held while std::cout is written to
+    bool                              _resolveMistypedIsbns = false;
+    bool                              _reorderAsSold        = false;
+    std::size_t                       _checkoutThreads      = 1;
+    bool                              _timeCheckouts        = false;
+    std::vector<std::uint64_t>        _checkoutLatencies;
+    bool                              _pipelineCheckouts    = false;
+    std::vector<SpscRingStatistics>   _pipelineStatistics;
 };
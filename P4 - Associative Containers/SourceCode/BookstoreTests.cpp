@@ -1,9 +1,17 @@
+#include <algorithm>  // find_if()
 #include <cmath>      // abs()
 #include <cstdlib>    // exit()
 #include <exception>
+#include <filesystem> // remove(), temp_directory_path()
+#include <fstream>
 #include <iomanip>     // setprecision()
 #include <iostream>    // boolalpha(), showpoint(), fixed(), unitbuf
+#include <iterator>    // next()
 #include <sstream>
+#include <string>      // to_string()
+#include <thread>
+#include <utility>     // as_const()
+#include <vector>
 
 #include "Bookstore.hpp"
 #include "CheckResults.hpp"
@@ -50,6 +58,9 @@ namespace  // anonymous
       void test_2( const Bookstore::Inventory_DB & inventory );
       void test_3( const Bookstore::Inventory_DB & inventory );
       void test_4( const Bookstore::BooksSold    & soldBooks, const Bookstore::Inventory_DB & inventory );
+      void test_5();
+      void test_6();
+      void test_7();
 
       void validate( const Bookstore::Inventory_DB & inventory, const Bookstore::Inventory_DB & pairs );
 
@@ -130,6 +141,10 @@ namespace  // anonymous
       theStore.reorderItems( booksSold );
       test_3( inventory );
 
+      test_5();
+      test_6();
+      test_7();
+
       std::clog << affirm << '\n';
     }
 
@@ -238,4 +253,233 @@ namespace  // anonymous
     affirm.is_true( "Items to reorder - content", expectedBooksToReorder == booksToReorder );
   }
 
+
+
+
+
+
+
+  void BookstoreRegressionTest::test_5()
+  {
+    // Checking out many more carts than threads, in parallel, gives the same receipts, inventory and sales as one at a time
+    Bookstore serialStore, parallelStore;
+    parallelStore.checkoutThreads( 4 );
+    parallelStore.timeCheckouts  ( true );
+
+    Bookstore::ShoppingCarts shoppingCarts;
+    for( std::size_t i = 0; i < 200; ++i ) for( auto & [name, cart] : serialStore.makeShoppingCarts() ) shoppingCarts.emplace( name + ' ' + std::to_string( i ), cart );
+
+    const auto         flags     = std::cout.flags();
+    const auto         precision = std::cout.precision();
+    std::ostringstream serialReceipts, parallelReceipts;
+    Bookstore::BooksSold serialSales, parallelSales;
+
+    std::cout.flags( flags );   std::cout.precision( precision );
+    { Redirect to( std::cout, serialReceipts   );  serialSales   = serialStore  .processCustomerShoppingCarts( shoppingCarts ); }
+
+    std::cout.flags( flags );   std::cout.precision( precision );
+    { Redirect to( std::cout, parallelReceipts );  parallelSales = parallelStore.processCustomerShoppingCarts( shoppingCarts ); }
+
+    affirm.is_true( "Parallel checkout - receipts in cart order", !serialReceipts.str().empty() && serialReceipts.str() == parallelReceipts.str() );
+    affirm.is_true( "Parallel checkout - same books sold",        serialSales == parallelSales );
+    affirm.is_true( "Parallel checkout - same inventory",         serialStore.inventory() == parallelStore.inventory() );
+    affirm.is_true( "Checkout - each cart timed when asked",      parallelStore.checkoutLatencies().size() == shoppingCarts.size() && serialStore.checkoutLatencies().empty() );
+
+    // as does checking out the same carts laid out flat
+    Bookstore            flatStore;
+    std::ostringstream   flatReceipts;
+    Bookstore::BooksSold flatSales;
+    std::cout.flags( flags );   std::cout.precision( precision );
+    { Redirect to( std::cout, flatReceipts );  flatSales = flatStore.processCustomerShoppingCarts( CartBatch( shoppingCarts ) ); }
+
+    affirm.is_true( "Flat carts - same receipts",                 serialReceipts.str() == flatReceipts.str() );
+    affirm.is_true( "Flat carts - same sales and inventory",      serialSales == flatSales && serialStore.inventory() == flatStore.inventory() );
+
+    // as does checking out through the pipeline, with every cart passing through each queue between its stages
+    Bookstore            pipelinedStore;
+    std::ostringstream   pipelinedReceipts;
+    Bookstore::BooksSold pipelinedSales;
+    pipelinedStore.pipelineCheckouts( true );
+    pipelinedStore.timeCheckouts    ( true );
+    std::cout.flags( flags );   std::cout.precision( precision );
+    { Redirect to( std::cout, pipelinedReceipts );  pipelinedSales = pipelinedStore.processCustomerShoppingCarts( shoppingCarts ); }
+
+    bool throughEveryQueue = pipelinedStore.pipelineStatistics().size() == 3;
+    for( auto & queue : pipelinedStore.pipelineStatistics() ) throughEveryQueue = throughEveryQueue && queue.pushes == shoppingCarts.size();
+
+    affirm.is_true( "Pipelined checkout - same receipts",         serialReceipts.str() == pipelinedReceipts.str() );
+    affirm.is_true( "Pipelined checkout - same sales and inventory", serialSales == pipelinedSales && serialStore.inventory() == pipelinedStore.inventory() );
+    affirm.is_true( "Pipelined checkout - through every stage",   throughEveryQueue && pipelinedStore.checkoutLatencies().size() == shoppingCarts.size() );
+
+    // Far more copies of some books are sold than were on hand, and their quantities stop at zero rather than wrapping around
+    Bookstore openingStore;
+    bool      noneWrapped = true;
+    for( auto & [isbn, quantity] : parallelStore.inventory() ) noneWrapped = noneWrapped && quantity <= openingStore.inventory().at( isbn );
+    affirm.is_true( "Checkout - sold out quantities stop at zero", noneWrapped );
+
+    // Batches checked out on many threads at once sell from the one stock, so the store ends up as if they'd been checked out in turn
+    Bookstore                concurrentStore;
+    Bookstore::ShoppingCarts firstCarts, secondCarts;
+    Bookstore::BooksSold     firstSales, secondSales;
+    for( auto & [name, cart] : shoppingCarts ) ( firstCarts.size() < shoppingCarts.size() / 2 ? firstCarts : secondCarts ).emplace( name, cart );
+    {
+      std::ostringstream receipts;
+      Redirect           to( std::cout, receipts );
+      std::thread        first( [&] { firstSales = concurrentStore.processCustomerShoppingCarts( firstCarts ); } );
+      secondSales = concurrentStore.processCustomerShoppingCarts( secondCarts );
+      first.join();
+    }
+    firstSales.insert( secondSales.begin(), secondSales.end() );
+
+    affirm.is_true( "Concurrent batches - same books sold",       firstSales == serialSales );
+    affirm.is_true( "Concurrent batches - same inventory",        std::as_const( concurrentStore ).inventory() == serialStore.inventory() );
+  }
+
+
+
+
+
+
+  void BookstoreRegressionTest::test_6()
+  {
+    // A journaled store opens with the inventory it last closed with, sales, re-orders and books delisted included
+    const auto filename = ( std::filesystem::temp_directory_path() / "BookstoreTests.dat" ).string();
+    auto removeFiles = [&]
+    {
+      for( auto suffix : { "", ".snapshot", ".journal.1", ".journal.2", ".journal.3", ".journal.4" } ) std::filesystem::remove( filename + suffix );
+    };
+    removeFiles();
+    {
+      std::ofstream file( filename );
+      for( auto & [isbn, quantity] : expectedValues ) file << std::quoted( isbn ) << ' ' << quantity << '\n';
+    }
+
+    Bookstore::Inventory_DB closingInventory;
+    {
+      Bookstore store( filename, true );
+      auto      sales = store.processCustomerShoppingCarts( store.makeShoppingCarts() );
+      store.delist( "9810500246" );
+      store.reorderItems( sales );
+      closingInventory = store.inventory();
+    }
+    affirm.is_true( "Journaled store - sales recorded",                  closingInventory != expectedValues && closingInventory.count( "9810500246" ) == 0 );
+
+    {
+      Bookstore store( filename, true );
+      affirm.is_true( "Journaled store - reopened as closed",           store.inventory() == closingInventory );
+
+      store.compactJournal().get();
+      store.processCustomerShoppingCarts( store.makeShoppingCarts() );
+      closingInventory = store.inventory();
+    }
+    affirm.is_true( "Journaled store - reopened as closed after compaction", Bookstore( filename, true ).inventory() == closingInventory );
+
+    removeFiles();
+  }
+
+
+
+
+
+
+  void BookstoreRegressionTest::test_7()
+  {
+    // Books sold below the re-order threshold are re-ordered just as if every book sold were looked at, whether at the end of the
+    // day or as soon as they're sold.  The inventory is only looked at here, never handed out to be changed, so it's the books noted
+    // below the threshold as they sold that are looked at.
+    Bookstore endOfDayStore, asSoldStore;
+    asSoldStore.reorderAsSold  ( true );
+    asSoldStore.checkoutThreads( 4    );
+
+    Bookstore::ShoppingCarts shoppingCarts;
+    for( std::size_t i = 0; i < 20; ++i ) for( auto & [name, cart] : endOfDayStore.makeShoppingCarts() ) shoppingCarts.emplace( name + ' ' + std::to_string( i ), cart );
+
+    std::ostringstream   buffer;
+    Redirect             null( std::cout, buffer );
+    Bookstore::BooksSold sales = endOfDayStore.processCustomerShoppingCarts( shoppingCarts );
+
+    const Bookstore & endOfDay = endOfDayStore;
+    const Bookstore   opening;
+    auto expected = endOfDay.inventory();
+    for( auto & isbn : sales ) if( auto it = expected.find( isbn ); it != expected.end() && it->second < 15 ) it->second += 20;
+
+    endOfDayStore.reorderItems( sales );
+    affirm.is_true( "Re-order - only books below threshold",      endOfDay.inventory() == expected && expected != opening.inventory() );
+    affirm.is_true( "Re-order - nothing left to re-order",        endOfDayStore.dispatchReorders() == 0 );
+
+    asSoldStore.processCustomerShoppingCarts( shoppingCarts );
+    affirm.is_true( "Re-order - as sold",                         std::as_const( asSoldStore ).inventory() == expected );
+
+
+    {
+      // Re-ordering one batch's sales leaves the books only the other batch sold for that batch, whether or not the store's inventory
+      // has been handed out to be changed
+      Bookstore quickStore, handedOutStore;
+      handedOutStore.inventory();
+
+      Bookstore::ShoppingCarts firstCarts, secondCarts;
+      for( auto & [name, cart] : shoppingCarts ) ( firstCarts.size() < shoppingCarts.size() / 2 ? firstCarts : secondCarts ).emplace( name, cart );
+
+      std::vector<Bookstore::Inventory_DB> afterFirst;
+      for( auto store : { &quickStore, &handedOutStore } )
+      {
+        auto firstSales  = store->processCustomerShoppingCarts( firstCarts  );
+        auto secondSales = store->processCustomerShoppingCarts( secondCarts );
+        store->reorderItems( firstSales );
+        afterFirst.push_back( std::as_const( *store ).inventory() );
+        store->reorderItems( secondSales );
+      }
+      affirm.is_true( "Re-order - one batch's sales at a time",   afterFirst.front() == afterFirst.back()
+                                                                  && std::as_const( quickStore ).inventory() == std::as_const( handedOutStore ).inventory() );
+    }
+
+
+    {
+      // Books lowered or erased directly through the inventory after they've sold are still looked at
+      Bookstore  store;
+      auto       sales     = store.processCustomerShoppingCarts( store.makeShoppingCarts() );
+      auto &     inventory = store.inventory();
+      const bool changed   = sales.size() >= 2;
+      const auto lowered   = changed ? *sales.begin()              : std::string();
+      const auto erased    = changed ? *std::next( sales.begin() ) : std::string();
+      if( changed )
+      {
+        inventory.at ( lowered ) = 1;
+        inventory.erase( erased  );
+      }
+
+      std::ostringstream report;
+      {
+        Redirect toReport( std::cout, report );
+        store.reorderItems( sales );
+      }
+      affirm.is_true( "Re-order - lowered directly",              changed && inventory.at( lowered ) == 21 );
+      affirm.is_true( "Re-order - erased directly",               changed && report.str().find( erased ) != std::string::npos );
+    }
+
+
+    {
+      // A book delisted once it's below the threshold is neither re-ordered nor reported by dispatchReorders(), but reorderItems()
+      // reports it's no longer sold whenever it's among the sales given
+      Bookstore  store;
+      auto       sales     = store.processCustomerShoppingCarts( shoppingCarts );
+      const auto lowOnHand = std::find_if( sales.begin(), sales.end(), [&]( const std::string & isbn ) { return std::as_const( store ).inventory().at( isbn ) < 15; } );
+      const bool found     = lowOnHand != sales.end();
+      const auto delisted  = found ? *lowOnHand : std::string();
+      if( found ) store.delist( delisted );
+
+      std::ostringstream dispatched, reordered;
+      {
+        Redirect toDispatched( std::cout, dispatched );
+        store.dispatchReorders();
+      }
+      {
+        Redirect toReordered( std::cout, reordered );
+        store.reorderItems( sales );
+      }
+      affirm.is_true( "Re-order - delisted book not dispatched",  found && dispatched.str().find( delisted ) == std::string::npos );
+      affirm.is_true( "Re-order - delisted book reported",        found && reordered .str().find( delisted ) != std::string::npos
+                                                                  && reordered.str().find( "no longer sold" ) != std::string::npos );
+    }
+  }
 } // namespace
@@ -0,0 +1,198 @@
+#include <algorithm>     // lower_bound(), min(), sort(), unique(), upper_bound()
+#include <cmath>         // floor(), log(), pow()
+#include <cstddef>       // size_t
+#include <cstdint>       // uint32_t, uint64_t
+#include <limits>        // numeric_limits
+#include <stdexcept>     // invalid_argument
+#include <string>
+#include <string_view>
+#include <utility>       // move(), swap()
+#include <vector>
+
+#include "BookDatabase.hpp"
+#include "CartGenerator.hpp"
+#include "FlatCart.hpp"
+#include "ParallelFor.hpp"
+
+
+
+namespace  // anonymous
+{
+  // SplitMix64, written out rather than taken from <random> so the carts made are the same with every standard library
+  class Random
+  {
+    public:
+      Random( std::uint64_t seed, std::uint64_t stream ) : _state( seed ^ mix( stream + 0x9E3779B97F4A7C15ULL ) ) {}
+
+      std::uint64_t next()           { return mix( _state += 0x9E3779B97F4A7C15ULL ); }
+      double        uniform()        { return static_cast<double>( next() >> 11 ) * 0x1.0p-53; }             // [0, 1)
+      std::size_t   below( std::size_t n )                                                                    // [0, n)
+      {
+        return std::min( static_cast<std::size_t>( uniform() * static_cast<double>( n ) ), n - 1 );
+      }
+
+    private:
+      static std::uint64_t mix( std::uint64_t z )
+      {
+        z = ( z ^ ( z >> 30 ) ) * 0xBF58476D1CE4E5B9ULL;
+        z = ( z ^ ( z >> 27 ) ) * 0x94D049BB133111EBULL;
+        return z ^ ( z >> 31 );
+      }
+
+      std::uint64_t _state;
+  };
+
+
+
+  std::vector<std::string_view> databaseIsbns( std::vector<std::string> & storage )
+  {
+    storage = BookDatabase::instance().snapshot().isbns();
+    return { storage.begin(), storage.end() };
+  }
+}
+
+
+
+CartGenerator::CartGenerator( const Options & options )
+  : _options( options )
+{
+  std::vector<std::string> storage;
+  load( databaseIsbns( storage ) );
+}
+
+
+
+CartGenerator::CartGenerator( const std::vector<std::string_view> & isbns, const Options & options )
+  : _options( options )
+{
+  load( isbns );
+}
+
+
+
+void CartGenerator::load( std::vector<std::string_view> isbns )
+{
+  if( _options.minItems > _options.maxItems )                                          throw std::invalid_argument( "CartGenerator:  minItems exceeds maxItems" );
+  if( !( _options.missRate >= 0.0 && _options.missRate <= 1.0 ) )                      throw std::invalid_argument( "CartGenerator:  missRate must be from 0 through 1" );
+  if( !( _options.zipfExponent >= 0.0 ) )                                              throw std::invalid_argument( "CartGenerator:  zipfExponent must not be negative" );
+  if( _options.cartSize == CartSize::GEOMETRIC &&
+      !( _options.meanItems >= static_cast<double>( _options.minItems ) ) )            throw std::invalid_argument( "CartGenerator:  meanItems is less than minItems" );
+
+  // Sorting first makes the ranks depend only on which books there are and the seed, not the order they came in
+  std::sort( isbns.begin(), isbns.end() );
+  isbns.erase( std::unique( isbns.begin(), isbns.end() ), isbns.end() );
+
+  Random random( _options.seed, std::numeric_limits<std::uint64_t>::max() );
+  for( auto i = isbns.size(); i > 1; --i ) std::swap( isbns[i - 1], isbns[random.below( i )] );
+
+  std::size_t length = 0;
+  for( auto isbn : isbns ) length += isbn.size();
+  _isbns  .reserve( length );
+  _offsets.reserve( isbns.size() + 1 );
+  for( auto isbn : isbns )
+  {
+    _isbns += isbn;
+    _offsets.push_back( static_cast<std::uint32_t>( _isbns.size() ) );
+  }
+
+  _sorted.resize( isbns.size() );
+  for( std::size_t rank = 0; rank < _sorted.size(); ++rank ) _sorted[rank] = static_cast<std::uint32_t>( rank );
+  std::sort( _sorted.begin(), _sorted.end(), [this]( std::uint32_t lhs, std::uint32_t rhs ) { return isbn( lhs ) < isbn( rhs ); } );
+
+  double total = 0.0;
+  _popularity.reserve( isbns.size() );
+  for( std::size_t rank = 1; rank <= isbns.size(); ++rank ) _popularity.push_back( total += 1.0 / std::pow( static_cast<double>( rank ), _options.zipfExponent ) );
+  for( auto & cumulative : _popularity ) cumulative /= total;
+}
+
+
+
+CartBatch CartGenerator::generate( std::size_t carts ) const
+{
+  return generate( 0, carts );
+}
+
+
+
+CartBatch CartGenerator::generate( std::size_t first, std::size_t carts ) const
+{
+  std::vector<CartBatch> chunks( ( carts + CHUNK_SIZE - 1 ) / CHUNK_SIZE );
+  parallelFor( chunks.size(), _options.threads, [&]( std::size_t, std::size_t index )
+  {
+    const auto begin = index * CHUNK_SIZE;
+    chunk( chunks[index], first + begin, std::min( CHUNK_SIZE, carts - begin ) );
+  } );
+
+  CartBatch batch;
+  for( auto & piece : chunks ) batch.append( std::move( piece ) );
+  return batch;
+}
+
+
+
+void CartGenerator::chunk( CartBatch & batch, std::size_t first, std::size_t carts ) const
+{
+  const auto mean  = _options.cartSize == CartSize::GEOMETRIC ? _options.meanItems : ( _options.minItems + _options.maxItems ) / 2.0;
+  batch.reserve( carts, static_cast<std::size_t>( static_cast<double>( carts ) * mean ) + 1 );
+
+  // A geometric number of extra items with mean m is floor( log(u) / log(1 - p) ) for p = 1 / (m + 1)
+  const auto extra   = _options.meanItems - static_cast<double>( _options.minItems );
+  const auto logMore = extra > 0.0 ? std::log( 1.0 - 1.0 / ( extra + 1.0 ) ) : 0.0;
+
+  char name[] = "Customer 0000000000";
+  char unknown[13];
+
+  for( auto customer = first; customer < first + carts; ++customer )
+  {
+    Random random( _options.seed, customer );
+
+    auto number = customer;
+    for( auto digit = sizeof( name ) - 1; digit-- > 9; number /= 10 ) name[digit] = static_cast<char>( '0' + number % 10 );
+    batch.open( { name, sizeof( name ) - 1 } );
+
+    std::size_t items = _options.minItems;
+    if( _options.cartSize == CartSize::UNIFORM ) items += random.below( _options.maxItems - _options.minItems + 1 );
+    else if( logMore < 0.0 )                     items += static_cast<std::size_t>( std::min( std::floor( std::log( 1.0 - random.uniform() ) / logMore ), static_cast<double>( _options.maxItems - _options.minItems ) ) );
+
+    for( std::size_t item = 0; item < items; ++item )
+    {
+      if( _popularity.empty() || random.uniform() < _options.missRate )
+      {
+        // Thirteen random digits that aren't an ISBN stocked.  With so many possible, a second try is almost never needed.
+        do
+        {
+          for( auto & digit : unknown ) digit = static_cast<char>( '0' + random.below( 10 ) );
+        } while( stocks( { unknown, sizeof( unknown ) } ) );
+
+        batch.add( { unknown, sizeof( unknown ) } );
+        continue;
+      }
+
+      const auto rank = static_cast<std::size_t>( std::upper_bound( _popularity.begin(), _popularity.end(), random.uniform() ) - _popularity.begin() );
+      batch.add( isbn( std::min( rank, _popularity.size() - 1 ) ) );
+    }
+    batch.close();
+  }
+}
+
+
+
+bool CartGenerator::stocks( std::string_view isbn ) const
+{
+  auto it = std::lower_bound( _sorted.begin(), _sorted.end(), isbn, [this]( std::uint32_t rank, std::string_view sought ) { return this->isbn( rank ) < sought; } );
+  return it != _sorted.end() && this->isbn( *it ) == isbn;
+}
+
+
+
+std::size_t CartGenerator::books() const
+{
+  return _popularity.size();
+}
+
+
+
+std::string_view CartGenerator::isbn( std::size_t rank ) const
+{
+  return std::string_view( _isbns ).substr( _offsets[rank], _offsets[rank + 1] - _offsets[rank] );
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstddef>    // size_t
+#include <cstdint>    // uint32_t, uint64_t
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "FlatCart.hpp"
+
+
+
+// Makes up shopping carts by the million, for load testing checkout with far more customers than Bookstore::makeShoppingCarts()
+// has.  The carts are a deterministic function of the seed:  the same options give the same carts, however many threads make them.
+//
+// Books are drawn from the loaded BookDatabase, or from a given list of ISBNs, with a Zipfian popularity.  The books are ranked in
+// an order shuffled by the seed, and the book of rank k (from 1) is drawn in proportion to 1 / k^zipfExponent, so a few books are
+// in many carts and most are in few, as in a real store.  A fraction of the items are ISBNs in neither, like a mistyped or unknown
+// book scanned at the register.
+//
+// Each cart draws from its own random stream, seeded by the seed and the cart's number, so carts are made in parallel, a chunk at a
+// time per thread, each chunk in a CartBatch of its own, and the chunks spliced together in order.  Carts are named "Customer N"
+// with N zero padded to ten digits, so name order is the order made.
+class CartGenerator
+{
+  public:
+    enum class CartSize
+    {
+      UNIFORM,                                                                  // Any number of items from minItems through maxItems
+      GEOMETRIC                                                                 // minItems plus a geometric number more, averaging
+    };                                                                          // meanItems in all, but never more than maxItems
+
+    struct Options
+    {
+      std::uint64_t seed         = 131;
+      std::size_t   threads      = 0;                                           // 0 for one per core
+      CartSize      cartSize     = CartSize::UNIFORM;
+      std::size_t   minItems     = 1;
+      std::size_t   maxItems     = 20;
+      double        meanItems    = 5.0;                                         // GEOMETRIC only
+      double        zipfExponent = 1.0;                                         // 0 for every book equally popular
+      double        missRate     = 0.01;                                        // Fraction of items not in the database
+    };
+
+    // Constructors.  Throw std::invalid_argument if the options don't make sense.
+    explicit CartGenerator( const Options & options );                          // Draws from the books in BookDatabase::instance()
+    CartGenerator( const std::vector<std::string_view> & isbns, const Options & options );
+
+    // Queries
+    CartBatch        generate( std::size_t carts )                    const;    // Customers 0 through carts - 1
+    CartBatch        generate( std::size_t first, std::size_t carts ) const;    // Customers first through first + carts - 1, the same
+                                                                                // carts they are in any other batch
+    std::size_t      books   ()                                       const;    // to draw from
+    std::string_view isbn    ( std::size_t rank )                     const;    // The book drawn most often is rank 0
+
+  private:
+    static constexpr std::size_t CHUNK_SIZE = 4096;                             // carts made at a time on one thread
+
+    void load  ( std::vector<std::string_view> isbns );
+    void chunk ( CartBatch & batch, std::size_t first, std::size_t carts ) const;
+    bool stocks( std::string_view isbn )                                   const;
+
+    Options                    _options;
+    std::string                _isbns;                                          // by rank, back to back
+    std::vector<std::uint32_t> _offsets = { 0 };                                // rank k is _isbns[_offsets[k], _offsets[k + 1])
+    std::vector<std::uint32_t> _sorted;                                         // ranks in ISBN order
+    std::vector<double>        _popularity;                                     // cumulative, by rank, ending at 1
+};
@@ -0,0 +1,165 @@
+#include <cstddef>    // size_t
+#include <exception>
+#include <iomanip>    // setprecision()
+#include <iostream>   // boolalpha(), showpoint(), fixed()
+#include <stdexcept>  // invalid_argument
+#include <string>     // to_string()
+#include <string_view>
+#include <vector>
+
+#include "BookDatabase.hpp"
+#include "CartGenerator.hpp"
+#include "CheckResults.hpp"
+#include "FlatCart.hpp"
+
+
+
+
+
+namespace  // anonymous
+{
+  class CartGeneratorRegressionTest
+  {
+    public:
+      CartGeneratorRegressionTest();
+
+    private:
+      void tests();
+
+      Regression::CheckResults affirm;
+  } run_cartGenerator_tests;
+
+
+
+
+  // Every cart as "name:isbn*quantity isbn*quantity ..."
+  std::vector<std::string> contents( const CartBatch & batch )
+  {
+    std::vector<std::string> carts;
+    for( auto cart : batch )
+    {
+      std::string line( cart.name() );
+      line += ':';
+      for( auto & item : cart ) line.append( item.isbn() ).append( "*" + std::to_string( item.quantity() ) + ' ' );
+      carts.push_back( std::move( line ) );
+    }
+    return carts;
+  }
+
+
+
+  void CartGeneratorRegressionTest::tests()
+  {
+    std::vector<std::string>      storage;
+    std::vector<std::string_view> isbns;
+    for( std::size_t i = 0; i < 100; ++i ) storage.push_back( "97800000" + std::to_string( 10'000 + i ) );
+    isbns.assign( storage.begin(), storage.end() );
+
+    CartGenerator::Options options;
+    options.missRate = 0.25;
+    options.threads  = 1;
+
+    {
+      // The same seed makes the same carts however many threads make them, and any stretch of customers is made the same alone
+      const CartGenerator one( isbns, options );
+      options.threads = 4;
+      const CartGenerator four( isbns, options );
+
+      const auto all = contents( one.generate( 10'000 ) );
+      affirm.is_true ( "Cart generator - same carts on any threads",  all == contents( four.generate( 10'000 ) ) );
+
+      const auto part = contents( four.generate( 5'000, 3'000 ) );
+      affirm.is_true ( "Cart generator - stretch of customers",        part == std::vector<std::string>( all.begin() + 5'000, all.begin() + 8'000 ) );
+      affirm.is_true ( "Cart generator - names in order made",         all.front().compare( 0, 20, "Customer 0000000000:" ) == 0 && part.front().compare( 0, 20, "Customer 0000005000:" ) == 0 );
+
+      options.seed = 2;
+      affirm.is_true ( "Cart generator - another seed, other carts",   all != contents( CartGenerator( isbns, options ).generate( 10'000 ) ) );
+    }
+
+    {
+      // Cart sizes stay in range, popular books are drawn far more often than unpopular ones, and misses are as often as asked
+      options.minItems = 3;
+      options.maxItems = 9;
+      const CartGenerator generator( isbns, options );
+      const auto          batch = generator.generate( 20'000 );
+
+      std::size_t items = 0, misses = 0, first = 0, last = 0;
+      bool        inRange = true;
+      for( auto cart : batch )
+      {
+        std::size_t size = 0;
+        for( auto & item : cart )
+        {
+          size   += item.quantity();
+          misses += item.isbn().compare( 0, 8, "97800000" ) == 0 ? 0 : item.quantity();
+          first  += item.isbn() == generator.isbn( 0  ) ? item.quantity() : 0;
+          last   += item.isbn() == generator.isbn( 99 ) ? item.quantity() : 0;
+        }
+        inRange = inRange && size >= 3 && size <= 9;
+        items  += size;
+      }
+      const auto missRate = static_cast<double>( misses ) / static_cast<double>( items );
+
+      affirm.is_true ( "Cart generator - uniform sizes in range",      inRange && items > 20'000 * 5 && items < 20'000 * 7 );
+      affirm.is_true ( "Cart generator - Zipfian popularity",          first > 50 * last && last > 0 );
+      affirm.is_true ( "Cart generator - miss rate",                   missRate > 0.24 && missRate < 0.26 );
+
+      options.cartSize  = CartGenerator::CartSize::GEOMETRIC;
+      options.minItems  = 1;
+      options.maxItems  = 1'000;
+      options.meanItems = 4.0;
+      std::size_t geometric = 0, largest = 0;
+      for( auto cart : CartGenerator( isbns, options ).generate( 20'000 ) )
+      {
+        std::size_t size = 0;
+        for( auto & item : cart ) size += item.quantity();
+        geometric += size;
+        largest    = size > largest ? size : largest;
+      }
+      affirm.is_true ( "Cart generator - geometric sizes",             geometric > 20'000 * 3.8 && geometric < 20'000 * 4.2 && largest > 20 );
+    }
+
+    {
+      bool threw = false;
+      options.meanItems = 0.5;
+      try                                         { CartGenerator generator( isbns, options ); }
+      catch( const std::invalid_argument & )      { threw = true;                              }
+      affirm.is_true ( "Cart generator - options checked",            threw );
+    }
+
+    {
+      // Books are drawn from the database by default
+      CartGenerator::Options defaults;
+      defaults.missRate = 0.0;
+      const CartGenerator generator( defaults );
+      const auto          batch = generator.generate( 100 );
+
+      auto        catalog = BookDatabase::instance().snapshot();
+      std::size_t found   = 0;
+      for( auto cart : batch ) for( auto & item : cart ) found += catalog.find( std::string( item.isbn() ) ) != nullptr ? 1 : 0;
+
+      affirm.is_true ( "Cart generator - drawn from the database",    generator.books() == catalog.size() && found == batch.items() && found > 0 );
+    }
+  }
+
+
+
+  CartGeneratorRegressionTest::CartGeneratorRegressionTest()
+  {
+    std::clog << std::boolalpha << std::showpoint << std::fixed << std::setprecision( 2 );
+
+
+    try
+    {
+      std::clog << "\nCart Generator Regression Test:\n";
+      tests();
+
+      std::clog << affirm << '\n';
+    }
+    catch( const std::exception & ex )
+    {
+      std::clog << "FAILURE:  Regression test for \"class CartGenerator\" failed with an unhandled exception. \n\n\n"
+                << ex.what() << std::endl;
+    }
+  }
+} // namespace
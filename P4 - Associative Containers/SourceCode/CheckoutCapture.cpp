@@ -0,0 +1,399 @@
+#include <chrono>        // nanoseconds, steady_clock
+#include <cstddef>       // size_t
+#include <cstdint>       // uint64_t
+#include <filesystem>    // file_size()
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <thread>        // sleep_until()
+#include <utility>       // pair
+#include <vector>
+
+#include "Bookstore.hpp"
+#include "CheckoutCapture.hpp"
+#include "FlatCart.hpp"
+
+
+
+namespace  // anonymous
+{
+  constexpr std::string_view CAPTURE_MAGIC = "CHKCAP01";
+
+  // A capture is its magic followed by records, each its kind (1 byte), the length of its payload (8), the payload, then a checksum
+  // (8) of all that.  Numbers in the framing are little endian, and numbers in a payload are written in as few bytes as they fit
+  // (LEB128), as is each text's length, which comes before it.  Payloads:
+  //    'I' inventory changes    the number of books stocked or with a new quantity, each book's ISBN and quantity, then the number
+  //                             of books no longer stocked and each one's ISBN
+  //    'B' batch of carts       nanoseconds since recording began, settings (1 to resolve mistyped ISBNs, 2 to re-order as sold),
+  //                             the number of carts, then each cart's name, its number of items, and each item's ISBN, title and
+  //                             quantity
+  //    'R' results              the number of books the batch sold and each one's ISBN, then inventory changes as above
+  constexpr char INVENTORY = 'I';
+  constexpr char BATCH     = 'B';
+  constexpr char RESULTS   = 'R';
+
+  constexpr std::uint64_t RESOLVE_MISTYPED_ISBNS = 1;
+  constexpr std::uint64_t REORDER_AS_SOLD        = 2;
+
+  constexpr std::size_t   HEADER_SIZE   = 1 + 8;
+  constexpr std::size_t   CHECKSUM_SIZE = 8;
+
+
+
+  // FNV-1a, continued from hash
+  std::uint64_t checksum( std::string_view bytes, std::uint64_t hash = 0xCBF2'9CE4'8422'2325ULL )
+  {
+    for( unsigned char c : bytes ) hash = ( hash ^ c ) * 0x0000'0100'0000'01B3ULL;
+    return hash;
+  }
+
+
+
+  void put( std::string & bytes, std::uint64_t value, std::size_t size )
+  {
+    for( std::size_t i = 0; i < size; ++i, value >>= 8 ) bytes += static_cast<char>( value & 0xFF );
+  }
+
+  std::uint64_t get( std::string_view bytes )
+  {
+    std::uint64_t value = 0;
+    for( std::size_t i = bytes.size(); i-- > 0; ) value = value << 8 | static_cast<unsigned char>( bytes[i] );
+    return value;
+  }
+
+
+
+  void putNumber( std::string & bytes, std::uint64_t value )
+  {
+    for( ; value >= 0x80; value >>= 7 ) bytes += static_cast<char>( ( value & 0x7F ) | 0x80 );
+    bytes += static_cast<char>( value );
+  }
+
+  void putText( std::string & bytes, std::string_view text )
+  {
+    putNumber( bytes, text.size() );
+    bytes += text;
+  }
+
+  // Reads a number at offset, advancing it, or returns false if the bytes run out first
+  bool getNumber( std::string_view bytes, std::size_t & offset, std::uint64_t & value )
+  {
+    value = 0;
+    for( unsigned shift = 0; offset < bytes.size() && shift < 64; shift += 7 )
+    {
+      const auto byte = static_cast<unsigned char>( bytes[offset++] );
+      value |= static_cast<std::uint64_t>( byte & 0x7F ) << shift;
+      if( ( byte & 0x80 ) == 0 ) return true;
+    }
+    return false;
+  }
+
+  bool getText( std::string_view bytes, std::size_t & offset, std::string_view & text )
+  {
+    std::uint64_t length;
+    if( !getNumber( bytes, offset, length ) || bytes.size() - offset < length ) return false;
+
+    text    = bytes.substr( offset, length );
+    offset += length;
+    return true;
+  }
+
+
+
+  // Appends the changes that make known into inventory, and makes them to known.  Both are walked once, together, in ISBN order.
+  // Returns how many changes there were.
+  std::size_t putChanges( std::string & bytes, CheckoutRecorder::Inventory & known, const CheckoutRecorder::Inventory & inventory )
+  {
+    std::string stocked, delisted;
+    std::size_t stockedCount = 0, delistedCount = 0;
+
+    auto it = known.begin();
+    for( const auto & [isbn, quantity] : inventory )
+    {
+      for( ; it != known.end() && it->first < isbn; ++delistedCount )
+      {
+        putText( delisted, it->first );
+        it = known.erase( it );
+      }
+
+      if( it != known.end() && it->first == isbn )
+      {
+        if( it->second != quantity )
+        {
+          putText  ( stocked, isbn     );
+          putNumber( stocked, quantity );
+          it->second = quantity;
+          ++stockedCount;
+        }
+        ++it;
+      }
+      else
+      {
+        putText  ( stocked, isbn     );
+        putNumber( stocked, quantity );
+        known.emplace_hint( it, isbn, quantity );
+        ++stockedCount;
+      }
+    }
+    for( ; it != known.end(); ++delistedCount )
+    {
+      putText( delisted, it->first );
+      it = known.erase( it );
+    }
+
+    putNumber( bytes, stockedCount  );
+    bytes += stocked;
+    putNumber( bytes, delistedCount );
+    bytes += delisted;
+    return stockedCount + delistedCount;
+  }
+
+
+
+  // Inventory changes read back, referring to the payload they were read from
+  struct Changes
+  {
+    std::vector<std::pair<std::string_view, unsigned int>> stocked;
+    std::vector<std::string_view>                         delisted;
+
+    void applyTo( CheckoutRecorder::Inventory & inventory ) const
+    {
+      for( auto [isbn, quantity] : stocked  ) inventory.insert_or_assign( std::string( isbn ), quantity );
+      for( auto isbn             : delisted ) inventory.erase( std::string( isbn ) );
+    }
+  };
+
+  bool getChanges( std::string_view bytes, std::size_t & offset, Changes & changes )
+  {
+    std::uint64_t count, quantity;
+    std::string_view isbn;
+
+    if( !getNumber( bytes, offset, count ) ) return false;
+    for( ; count > 0; --count )
+    {
+      if( !getText( bytes, offset, isbn ) || !getNumber( bytes, offset, quantity ) ) return false;
+      changes.stocked.emplace_back( isbn, static_cast<unsigned int>( quantity ) );
+    }
+
+    if( !getNumber( bytes, offset, count ) ) return false;
+    for( ; count > 0; --count )
+    {
+      if( !getText( bytes, offset, isbn ) ) return false;
+      changes.delisted.push_back( isbn );
+    }
+    return true;
+  }
+
+
+
+  // Reads the next record, or returns false at the end of the capture, or a record cut short, as when recording stopped part way
+  // through writing it
+  bool readRecord( std::ifstream & file, std::uint64_t & remaining, char & kind, std::string & payload, const std::string & filename )
+  {
+    std::string header( HEADER_SIZE, '\0' );
+    if( remaining < HEADER_SIZE + CHECKSUM_SIZE || !file.read( header.data(), static_cast<std::streamsize>( header.size() ) ) ) return false;
+
+    const auto length = get( std::string_view( header ).substr( 1 ) );
+    if( length > remaining - HEADER_SIZE - CHECKSUM_SIZE ) return false;
+    remaining -= HEADER_SIZE + length + CHECKSUM_SIZE;
+
+    std::string stored( CHECKSUM_SIZE, '\0' );
+    payload.resize( length );
+    if( !file.read( payload.data(), static_cast<std::streamsize>( length ) ) || !file.read( stored.data(), static_cast<std::streamsize>( stored.size() ) ) ) return false;
+
+    if( get( stored ) != checksum( payload, checksum( header ) ) ) throw CheckoutReplayer::Corrupt_Ex( "Damaged checkout capture:  \"" + filename + '"' );
+
+    kind = header[0];
+    return true;
+  }
+}
+
+
+
+
+
+
+
+CheckoutRecorder::CheckoutRecorder( const std::string & captureFile )
+  : _file( captureFile, std::ios::binary | std::ios::trunc )
+{
+  _file << CAPTURE_MAGIC;
+  if( !_file ) throw Io_Ex( "Unable to create checkout capture \"" + captureFile + '"' );
+}
+
+
+
+void CheckoutRecorder::before( const CartBatch & carts, const Inventory & inventory, const Settings & settings )
+{
+  // Whatever changed the inventory since the last batch, like re-orders and books delisted, is written ahead of the carts
+  std::string payload;
+  if( putChanges( payload, _known, inventory ) > 0 ) write( INVENTORY, payload );
+
+  payload.clear();
+  putNumber( payload, static_cast<std::uint64_t>( std::chrono::duration_cast<std::chrono::nanoseconds>( std::chrono::steady_clock::now() - _start ).count() ) );
+  putNumber( payload, ( settings.resolveMistypedIsbns ? RESOLVE_MISTYPED_ISBNS : 0 ) | ( settings.reorderAsSold ? REORDER_AS_SOLD : 0 ) );
+  putNumber( payload, carts.size() );
+  for( auto cart : carts )
+  {
+    putText  ( payload, cart.name() );
+    putNumber( payload, cart.size() );
+    for( auto & item : cart )
+    {
+      putText  ( payload, item.isbn()     );
+      putText  ( payload, item.title()    );
+      putNumber( payload, item.quantity() );
+    }
+  }
+  write( BATCH, payload );
+}
+
+
+
+void CheckoutRecorder::after( const BooksSold & sold, const Inventory & inventory )
+{
+  std::string payload;
+  putNumber( payload, sold.size() );
+  for( const auto & isbn : sold ) putText( payload, isbn );
+  putChanges( payload, _known, inventory );
+  write( RESULTS, payload );
+
+  // A capture holds every batch finished, however the program ends
+  _file.flush();
+  if( !_file ) throw Io_Ex( "Unable to write checkout capture" );
+}
+
+
+
+void CheckoutRecorder::write( char kind, const std::string & payload )
+{
+  std::string header( 1, kind ), stored;
+  put( header, payload.size(), 8 );
+  put( stored, checksum( payload, checksum( header ) ), CHECKSUM_SIZE );
+
+  _file << header << payload << stored;
+  if( !_file ) throw Io_Ex( "Unable to write checkout capture" );
+}
+
+
+
+
+
+
+
+CheckoutReplayer::CheckoutReplayer( const std::string & captureFile )
+  : _captureFile( captureFile )
+{
+  std::ifstream file( captureFile, std::ios::binary );
+  std::string   magic( CAPTURE_MAGIC.size(), '\0' );
+  if( !file.read( magic.data(), static_cast<std::streamsize>( magic.size() ) ) || magic != CAPTURE_MAGIC )
+  {
+    throw Corrupt_Ex( "Not a checkout capture:  \"" + captureFile + '"' );
+  }
+}
+
+
+
+CheckoutReplayer::Results CheckoutReplayer::replay( Bookstore & store, Speed speed )
+{
+  std::ifstream file( _captureFile, std::ios::binary );
+  file.seekg( static_cast<std::streamoff>( CAPTURE_MAGIC.size() ) );
+  std::uint64_t remaining = std::filesystem::file_size( _captureFile ) - CAPTURE_MAGIC.size();
+
+  // The store's inventory and the one recorded are kept side by side.  The capture's first changes are the whole inventory.
+  CheckoutRecorder::Inventory recorded;
+  store.inventory().clear();
+
+  Results                  results;
+  CartBatch                batch;
+  bool                     pending  = false;                          // a batch read but not yet checked out
+  std::uint64_t            settings = 0;
+  std::chrono::nanoseconds at{ 0 };
+
+  const auto  start = std::chrono::steady_clock::now();
+  std::string payload;
+  char        kind;
+  while( readRecord( file, remaining, kind, payload, _captureFile ) )
+  {
+    std::string_view view   = payload;
+    std::size_t      offset = 0;
+    bool             intact = true;
+
+    if( kind == INVENTORY )
+    {
+      Changes changes;
+      intact = getChanges( view, offset, changes );
+      if( intact )
+      {
+        changes.applyTo( recorded          );
+        changes.applyTo( store.inventory() );
+      }
+    }
+
+    else if( kind == BATCH )
+    {
+      std::uint64_t    nanoseconds, carts, items, quantity;
+      std::string_view name, isbn, title;
+
+      batch  = CartBatch();
+      intact = getNumber( view, offset, nanoseconds ) && getNumber( view, offset, settings ) && getNumber( view, offset, carts );
+      for( ; intact && carts > 0; --carts )
+      {
+        intact = getText( view, offset, name ) && getNumber( view, offset, items );
+        batch.open( name );
+        for( ; intact && items > 0; --items )
+        {
+          intact = getText( view, offset, isbn ) && getText( view, offset, title ) && getNumber( view, offset, quantity );
+          if( intact ) batch.add( isbn, title, static_cast<unsigned int>( quantity ) );
+        }
+        batch.close();
+      }
+      at      = std::chrono::nanoseconds( nanoseconds );
+      pending = intact;
+    }
+
+    else if( kind == RESULTS && pending )
+    {
+      std::uint64_t         count;
+      std::string_view      isbn;
+      Bookstore::BooksSold  expected;
+      Changes               changes;
+
+      intact = getNumber( view, offset, count );
+      for( ; intact && count > 0; --count )
+      {
+        intact = getText( view, offset, isbn );
+        if( intact ) expected.emplace_hint( expected.end(), isbn );
+      }
+      intact = intact && getChanges( view, offset, changes );
+
+      if( intact )
+      {
+        if( speed == Speed::RECORDED ) std::this_thread::sleep_until( start + at );
+
+        store.resolveMistypedIsbns( ( settings & RESOLVE_MISTYPED_ISBNS ) != 0 );
+        store.reorderAsSold       ( ( settings & REORDER_AS_SOLD        ) != 0 );
+
+        const auto begun = std::chrono::steady_clock::now();
+        const auto sold  = store.processCustomerShoppingCarts( batch );
+        results.checkoutTime += std::chrono::steady_clock::now() - begun;
+
+        changes.applyTo( recorded );
+        ++results.batches;
+        results.carts += batch.size();
+
+        if( sold != expected || store.inventory() != recorded )
+        {
+          if( results.mismatches++ == 0 ) results.firstMismatch = results.batches;
+          store.inventory() = recorded;
+        }
+        pending = false;
+      }
+    }
+
+    else intact = false;
+
+    if( !intact || offset != view.size() ) throw Corrupt_Ex( "Damaged checkout capture:  \"" + _captureFile + '"' );
+  }
+
+  return results;
+}
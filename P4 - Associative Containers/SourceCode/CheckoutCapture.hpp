@@ -0,0 +1,94 @@
+#pragma once
+
+#include <chrono>     // nanoseconds, steady_clock
+#include <cstddef>    // size_t
+#include <cstdint>    // uint64_t
+#include <fstream>
+#include <map>
+#include <set>
+#include <stdexcept>
+#include <string>
+
+#include "FlatCart.hpp"
+
+class Bookstore;
+
+
+
+// Captures of checkout traffic, so a store can be benchmarked and checked against the carts real customers brought rather than made
+// up ones.
+//
+// A CheckoutRecorder is handed each batch of carts as it's checked out (see Bookstore::recordCheckouts()), and appends to the capture
+// file the changes to the inventory since the last batch, the carts, when they came relative to the start of recording, and, once
+// checked out, the books they sold and the changes they made to the inventory.  Only changes are written, so a capture is small
+// next to the inventory even after many batches, and the first batch's changes are the whole inventory.
+//
+// A CheckoutReplayer reads a capture back a record at a time, so a capture of any size is replayed holding only one batch and two
+// copies of the inventory at once.  Each batch is checked out by the given store as fast as it can, or no sooner after the start than
+// it was recorded, and the books sold and inventory after are compared with those recorded.
+class CheckoutRecorder
+{
+  public:
+    using Inventory = std::map<std::string /*ISBN*/, unsigned int /*quantity*/>;
+    using BooksSold = std::set<std::string /*ISBN*/>;
+
+    struct Io_Ex : std::runtime_error { using runtime_error::runtime_error; };        // Thrown if the capture can't be written
+
+    struct Settings                                                     // The store's, which change what the same carts sell
+    {
+      bool resolveMistypedIsbns = false;
+      bool reorderAsSold        = false;
+    };
+
+    // Constructors, assignments, destructor
+    explicit CheckoutRecorder( const std::string & captureFile );      // Replaces any capture already there
+
+    CheckoutRecorder            ( const CheckoutRecorder & ) = delete;
+    CheckoutRecorder & operator=( const CheckoutRecorder & ) = delete;
+
+    // Operations.  Called around each batch of carts checked out, in turn.
+    void before( const CartBatch & carts, const Inventory & inventory, const Settings & settings );
+    void after ( const BooksSold & sold,  const Inventory & inventory );
+
+  private:
+    void write( char kind, const std::string & payload );
+
+    std::ofstream                         _file;
+    Inventory                             _known;                       // as of the last record written
+    std::chrono::steady_clock::time_point _start = std::chrono::steady_clock::now();
+};
+
+
+
+class CheckoutReplayer
+{
+  public:
+    struct Corrupt_Ex : std::runtime_error { using runtime_error::runtime_error; };   // Thrown if the capture is damaged
+
+    enum class Speed
+    {
+      RECORDED,                                                         // Each batch no sooner after the start than recorded
+      MAXIMUM                                                           // Each batch as soon as the last is done
+    };
+
+    struct Results
+    {
+      std::size_t              batches       = 0;
+      std::size_t              carts         = 0;
+      std::size_t              mismatches    = 0;                       // batches that sold other books or left another inventory
+      std::size_t              firstMismatch = 0;                       // the first of them, counting from 1, or 0 if none
+      std::chrono::nanoseconds checkoutTime{ 0 };                       // spent checking out, not reading or waiting
+    };
+
+    // Constructors, assignments, destructor
+    explicit CheckoutReplayer( const std::string & captureFile );      // Throws Corrupt_Ex if it isn't a capture
+
+    // Operations
+    // Replaces the store's inventory with the one recorded and checks out every batch captured.  After a mismatch the store's inventory
+    // is put back as recorded, so one batch going wrong doesn't make every one after it seem to.  A batch whose results weren't
+    // captured, as when recording stopped part way through it, is not checked out.
+    Results replay( Bookstore & store, Speed speed = Speed::MAXIMUM );
+
+  private:
+    std::string   _captureFile;
+};
@@ -0,0 +1,136 @@
+#include <chrono>       // milliseconds, steady_clock
+#include <cstddef>      // size_t
+#include <exception>
+#include <filesystem>   // temp_directory_path(), resize_file(), file_size(), remove()
+#include <fstream>
+#include <iomanip>      // setprecision()
+#include <iostream>     // boolalpha(), showpoint(), fixed()
+#include <sstream>      // ostringstream
+#include <string>
+#include <thread>       // sleep_for()
+
+#include "Bookstore.hpp"
+#include "CheckResults.hpp"
+#include "CheckoutCapture.hpp"
+#include "FlatCart.hpp"
+
+
+
+
+
+namespace  // anonymous
+{
+  class CheckoutCaptureRegressionTest
+  {
+    public:
+      CheckoutCaptureRegressionTest();
+
+    private:
+      void tests();
+
+      Regression::CheckResults affirm;
+  } run_checkoutCapture_tests;
+
+
+
+
+  // Receipts are printed to std::cout, which the tests keep clean
+  class Quiet
+  {
+    public:
+      Quiet()  { std::cout.flush();  std::cout.rdbuf( receipts.rdbuf() ); }
+     ~Quiet()  { std::cout.rdbuf( original );                            }
+
+    private:
+      std::ostringstream     receipts;
+      std::streambuf * const original = std::cout.rdbuf();
+  };
+
+
+
+  void CheckoutCaptureRegressionTest::tests()
+  {
+    const auto capture = ( std::filesystem::temp_directory_path() / "CheckoutCaptureTests.cap" ).string();
+    Quiet      quiet;
+
+    // A day's trading:  carts checked out, books re-ordered and delisted between batches, then more carts on another thread count
+    Bookstore recordingStore;
+    recordingStore.recordCheckouts( capture );
+
+    auto sales = recordingStore.processCustomerShoppingCarts( recordingStore.makeShoppingCarts() );
+    recordingStore.reorderItems( sales );
+    recordingStore.delist( "9802161748" );
+
+    std::this_thread::sleep_for( std::chrono::milliseconds( 100 ) );
+    recordingStore.checkoutThreads( 4 );
+    recordingStore.processCustomerShoppingCarts( CartBatch( recordingStore.makeShoppingCarts() ) );
+    recordingStore.recordCheckouts( "" );
+
+    {
+      // Replaying into a store with another inventory sells the same books and leaves the same inventory
+      Bookstore replayStore( "no such inventory file" );
+      const auto results = CheckoutReplayer( capture ).replay( replayStore );
+
+      affirm.is_equal( "Checkout capture - batches replayed",          2ULL, results.batches );
+      affirm.is_equal( "Checkout capture - no mismatches",              0ULL, results.mismatches );
+      affirm.is_true ( "Checkout capture - same closing inventory",    replayStore.inventory() == recordingStore.inventory() );
+    }
+
+    {
+      // At the recorded speed, the second batch waits as long after the first as when recorded
+      Bookstore  replayStore;
+      const auto start   = std::chrono::steady_clock::now();
+      const auto results = CheckoutReplayer( capture ).replay( replayStore, CheckoutReplayer::Speed::RECORDED );
+      affirm.is_true ( "Checkout capture - recorded speed",            results.batches == 2 && std::chrono::steady_clock::now() - start >= std::chrono::milliseconds( 100 ) );
+    }
+
+    {
+      // A capture cut short, as when recording stopped part way through, replays the batches finished
+      std::filesystem::resize_file( capture, std::filesystem::file_size( capture ) - 5 );
+      Bookstore replayStore;
+      affirm.is_equal( "Checkout capture - cut short",                  1ULL, CheckoutReplayer( capture ).replay( replayStore ).batches );
+    }
+
+    {
+      // but a damaged record is refused
+      {
+        std::fstream file( capture, std::ios::binary | std::ios::in | std::ios::out );
+        file.seekp( 20 );
+        file.put( '\x7F' );
+      }
+      bool threw = false;
+      try                                           { Bookstore replayStore;  CheckoutReplayer( capture ).replay( replayStore ); }
+      catch( const CheckoutReplayer::Corrupt_Ex & ) { threw = true;                                                               }
+      affirm.is_true ( "Checkout capture - damage detected",           threw );
+
+      threw = false;
+      std::ofstream( capture ) << "Not a capture";
+      try                                           { CheckoutReplayer replayer( capture ); }
+      catch( const CheckoutReplayer::Corrupt_Ex & ) { threw = true;                         }
+      affirm.is_true ( "Checkout capture - not a capture",             threw );
+    }
+
+    std::filesystem::remove( capture );
+  }
+
+
+
+  CheckoutCaptureRegressionTest::CheckoutCaptureRegressionTest()
+  {
+    std::clog << std::boolalpha << std::showpoint << std::fixed << std::setprecision( 2 );
+
+
+    try
+    {
+      std::clog << "\nCheckout Capture Regression Test:\n";
+      tests();
+
+      std::clog << affirm << '\n';
+    }
+    catch( const std::exception & ex )
+    {
+      std::clog << "FAILURE:  Regression test for \"class CheckoutReplayer\" failed with an unhandled exception. \n\n\n"
+                << ex.what() << std::endl;
+    }
+  }
+} // namespace
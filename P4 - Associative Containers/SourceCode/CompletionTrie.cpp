@@ -0,0 +1,220 @@
+#include <algorithm>     // clamp(), find(), min(), sort(), unique()
+#include <cctype>        // isalnum(), tolower()
+#include <cstddef>       // size_t, ptrdiff_t
+#include <cstdint>       // uint8_t, uint16_t, uint32_t
+#include <limits>        // numeric_limits
+#include <string>
+#include <string_view>
+#include <utility>       // make_pair(), move(), pair
+#include <vector>
+
+#include "Book.hpp"
+#include "CompletionTrie.hpp"
+
+
+
+CompletionTrie::CompletionTrie( const std::vector<const Book *> & books, Scorer score, std::size_t resultsPerNode )
+  : _scores        ( books.size() ),
+    _score         ( score ? std::move( score ) : []( const Book & book ) { return book.price(); } ),
+    _resultsPerNode( std::clamp<std::size_t>( resultsPerNode, 1, std::numeric_limits<std::uint8_t>::max() ) )
+{
+  std::vector<Key> keys;
+  keys.reserve( 2 * books.size() );
+
+  auto addKey = [&]( std::string text, std::size_t id )
+  {
+    if( !text.empty() ) keys.push_back( { std::move( text ) + ' ', static_cast<Id>( id ) } );
+  };
+
+  for( std::size_t id = 0; id < books.size(); ++id )
+  {
+    if( books[id] == nullptr ) continue;
+
+    _scores[id] = _score( *books[id] );
+    addKey( normalize( books[id]->title() ), id );
+    addKey( normalize( books[id]->isbn()  ), id );
+  }
+
+  std::sort( keys.begin(), keys.end(), []( const Key & lhs, const Key & rhs )
+             { return lhs.text != rhs.text ? lhs.text < rhs.text : lhs.id < rhs.id; } );
+
+  _keyIds.reserve( keys.size() );
+  for( const auto & key : keys ) _keyIds.push_back( key.id );
+
+  _nodes     .push_back( {} );
+  _firstBytes.push_back( '\0' );
+  if( !keys.empty() ) build( 0, keys, 0, keys.size(), 0 );
+}
+
+
+
+// Fill in the node holding keys[begin, end), which all agree on their first depth bytes, then build its children.  The children of a
+// node are allocated together, before any of them is built, so they end up adjacent.
+void CompletionTrie::build( std::uint32_t node, const std::vector<Key> & keys, std::size_t begin, std::size_t end, std::size_t depth )
+{
+  // Sorted keys share whatever their first and last share, so that is the node's label.  Labels too long to measure are split.
+  const auto & first    = keys[begin  ].text;
+  const auto & last     = keys[end - 1].text;
+  const auto   longest  = std::min( { first.size(), last.size(), depth + std::numeric_limits<std::uint16_t>::max() } );
+  auto         labelEnd = depth;
+  while( labelEnd < longest && first[labelEnd] == last[labelEnd] ) ++labelEnd;
+
+  _nodes[node].labelOffset = static_cast<std::uint32_t>( _labels.size() );
+  _nodes[node].labelLength = static_cast<std::uint16_t>( labelEnd - depth );
+  _nodes[node].keysBegin   = static_cast<std::uint32_t>( begin );
+  _nodes[node].keysEnd     = static_cast<std::uint32_t>( end   );
+  _labels.append( first, depth, labelEnd - depth );
+
+  // Keys ending at this node sort ahead of the longer keys they prefix.  The rest are grouped by their next byte, one child each.
+  auto childKeys = begin;
+  while( childKeys < end && keys[childKeys].text.size() == labelEnd ) ++childKeys;
+
+  std::vector<std::pair<std::size_t, std::size_t>> groups;
+  for( auto groupBegin = childKeys; groupBegin < end; )
+  {
+    auto groupEnd = groupBegin + 1;
+    while( groupEnd < end && keys[groupEnd].text[labelEnd] == keys[groupBegin].text[labelEnd] ) ++groupEnd;
+
+    groups.emplace_back( groupBegin, groupEnd );
+    groupBegin = groupEnd;
+  }
+
+  const auto firstChild = static_cast<std::uint32_t>( _nodes.size() );
+  _nodes     .resize( _nodes.size() + groups.size() );
+  _firstBytes.resize( _nodes.size() );
+  _nodes[node].firstChild = firstChild;
+  _nodes[node].childCount = static_cast<std::uint16_t>( groups.size() );
+
+  for( std::size_t i = 0; i < groups.size(); ++i )
+  {
+    _firstBytes[firstChild + i] = keys[groups[i].first].text[labelEnd];
+    build( static_cast<std::uint32_t>( firstChild + i ), keys, groups[i].first, groups[i].second, labelEnd );
+  }
+
+  // The best books beneath this node are among those ending here and the best beneath each child
+  std::vector<Id> candidates( _keyIds.begin() + static_cast<std::ptrdiff_t>( begin ), _keyIds.begin() + static_cast<std::ptrdiff_t>( childKeys ) );
+  for( std::size_t i = 0; i < groups.size(); ++i )
+  {
+    const auto & child = _nodes[firstChild + i];
+    candidates.insert( candidates.end(), _results.begin() + child.firstResult, _results.begin() + child.firstResult + child.resultCount );
+  }
+
+  const auto best = rank( std::move( candidates ), _resultsPerNode );
+  _nodes[node].firstResult = static_cast<std::uint32_t>( _results.size() );
+  _nodes[node].resultCount = static_cast<std::uint8_t >( best.size()     );
+  _results.insert( _results.end(), best.begin(), best.end() );
+}
+
+
+
+std::vector<CompletionTrie::Id> CompletionTrie::rank( std::vector<Id> ids, std::size_t limit ) const
+{
+  // A book may be reached through both its title and its ISBN.  Equal ids rank equally, so such duplicates end up side by side.
+  std::sort( ids.begin(), ids.end(), [this]( Id lhs, Id rhs ) { return std::make_pair( -_scores[lhs], lhs ) < std::make_pair( -_scores[rhs], rhs ); } );
+  ids.erase( std::unique( ids.begin(), ids.end() ), ids.end() );
+
+  if( ids.size() > limit ) ids.resize( limit );
+  return ids;
+}
+
+
+
+std::vector<CompletionTrie::Id> CompletionTrie::complete( std::string_view prefix, std::size_t limit ) const
+{
+  if( _keyIds.empty() || limit == 0 ) return {};
+
+  // Walk down from the root matching the prefix against each node's label, stopping at the node where the prefix runs out
+  const auto  key     = normalize( prefix, true );
+  std::size_t matched = 0;
+  auto        node    = &_nodes.front();
+
+  for( ;; )
+  {
+    const std::string_view label( _labels.data() + node->labelOffset, node->labelLength );
+    const auto             length = std::min( label.size(), key.size() - matched );
+
+    if( std::string_view( key ).substr( matched, length ) != label.substr( 0, length ) ) return {};
+
+    matched += length;
+    if( matched == key.size() ) break;
+
+    const auto children = _firstBytes.begin() + node->firstChild;
+    const auto child    = std::find( children, children + node->childCount, key[matched] );
+    if( child == children + node->childCount ) return {};
+
+    node = &_nodes[static_cast<std::size_t>( child - _firstBytes.begin() )];
+  }
+
+  // The precomputed results suffice unless more are wanted and there may be more to give
+  if( limit <= node->resultCount || node->resultCount < _resultsPerNode )
+  {
+    return { _results.begin() + node->firstResult, _results.begin() + node->firstResult + std::min<std::size_t>( limit, node->resultCount ) };
+  }
+
+  return rank( { _keyIds.begin() + node->keysBegin, _keyIds.begin() + node->keysEnd }, limit );
+}
+
+
+
+double CompletionTrie::score( Id id ) const
+{
+  return _scores[id];
+}
+
+
+
+double CompletionTrie::score( const Book & book ) const
+{
+  return _score( book );
+}
+
+
+
+std::size_t CompletionTrie::sizeInBytes() const
+{
+  return _nodes     .capacity() * sizeof( Node   )
+       + _firstBytes.capacity() * sizeof( char   )
+       + _labels    .capacity()
+       + _results   .capacity() * sizeof( Id     )
+       + _keyIds    .capacity() * sizeof( Id     )
+       + _scores    .capacity() * sizeof( double );
+}
+
+
+
+std::string CompletionTrie::normalize( std::string_view text, bool keepTrailingSeparator )
+{
+  std::string normalized;
+  normalized.reserve( text.size() );
+
+  // Same alphabet as TitleIndex::tokenize():  letters and digits, plus bytes outside ASCII so other alphabets pass through whole
+  bool separated = false;
+  for( unsigned char c : text )
+  {
+    if( c < 0x80 && !std::isalnum( c ) )
+    {
+      separated = !normalized.empty();
+      continue;
+    }
+
+    if( separated ) normalized += ' ';
+    separated = false;
+
+    normalized += c < 0x80 ? static_cast<char>( std::tolower( c ) ) : static_cast<char>( c );
+  }
+
+  if( separated && keepTrailingSeparator ) normalized += ' ';
+
+  return normalized;
+}
+
+
+
+bool CompletionTrie::completes( std::string_view prefix, std::string_view text )
+{
+  const auto key = normalize( text );
+  if( key.empty() ) return false;
+
+  const auto normalizedPrefix = normalize( prefix, true );
+  return ( key + ' ' ).compare( 0, normalizedPrefix.size(), normalizedPrefix ) == 0;
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstddef>    // size_t
+#include <cstdint>    // uint8_t, uint16_t, uint32_t
+#include <functional> // function
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Book.hpp"
+
+
+
+// Prefix completion over book titles and ISBNs, for as-you-type suggestions.  Each book is entered twice, under its normalized title
+// and under its ISBN, in a radix tree (a trie whose single-child chains are collapsed into one node labeled with the whole chain).
+// Every node remembers the best few books beneath it, ranked by a score supplied by the caller, so the common query is a walk down
+// the prefix followed by a copy of at most a handful of ids - no subtree is searched.
+//
+// The tree is stored flat:  nodes live in one array with each node's children adjacent and ordered by the first byte of their
+// label, and the first byte of every node's label is also kept in a parallel byte array.  Choosing a child therefore scans a few
+// contiguous bytes rather than following pointers, and labels are slices of one shared character pool.
+class CompletionTrie
+{
+  public:
+    using Id     = std::uint32_t;
+    using Scorer = std::function<double( const Book & )>;                       // higher scores are suggested first
+
+    static constexpr std::size_t DEFAULT_RESULTS_PER_NODE = 10;
+
+    // Constructors
+    CompletionTrie( const std::vector<const Book *> & books,                    // books[id] is the book with that id, nullptr if none
+                    Scorer                            score          = {},      // defaults to price
+                    std::size_t                       resultsPerNode = DEFAULT_RESULTS_PER_NODE );
+
+    // Queries
+    //
+    // Returns up to limit books whose normalized title or ISBN begins with the normalized prefix, highest score first and ascending
+    // id order among equals.  Limits up to resultsPerNode are answered from the precomputed results, larger limits rank the prefix's
+    // whole subtree.
+    std::vector<Id> complete   ( std::string_view prefix, std::size_t limit ) const;
+    double          score      ( Id           id   )                           const;  // the score the book was ranked by
+    double          score      ( const Book & book )                           const;  // the score any book would be ranked by
+    std::size_t     sizeInBytes()                                              const;
+
+    // Letters are folded to lower case and each run of spaces and punctuation becomes a single space, so "The  Hobbit:" completes
+    // "the hobbit".  A trailing separator is kept only when asked.  Keys are entered with a trailing space marking their end, so a
+    // prefix of "the " completes "The" and "The Hobbit" but not "Theory".
+    static std::string normalize( std::string_view text, bool keepTrailingSeparator = false );
+    static bool        completes( std::string_view prefix, std::string_view text );  // whether prefix would complete to text
+
+  private:
+    struct Node
+    {
+      std::uint32_t labelOffset;                                                // the label is _labels[labelOffset, +labelLength)
+      std::uint32_t firstChild;                                                 // children are _nodes[firstChild, +childCount)
+      std::uint32_t firstResult;                                                // best ids are _results[firstResult, +resultCount)
+      std::uint32_t keysBegin;                                                  // every key in the subtree is one of
+      std::uint32_t keysEnd;                                                    // _keyIds[keysBegin, keysEnd)
+      std::uint16_t labelLength;
+      std::uint16_t childCount;
+      std::uint8_t  resultCount;
+    };
+
+    struct Key
+    {
+      std::string text;
+      Id          id;
+    };
+
+    void            build( std::uint32_t node, const std::vector<Key> & keys, std::size_t begin, std::size_t end, std::size_t depth );
+    std::vector<Id> rank ( std::vector<Id> ids, std::size_t limit ) const;     // best limit distinct ids:  higher score, then
+                                                                                // lower id
+
+    std::vector<Node>   _nodes;                                                 // _nodes[0] is the root
+    std::vector<char>   _firstBytes;                                            // first byte of each node's label, parallels _nodes
+    std::string         _labels;
+    std::vector<Id>     _results;
+    std::vector<Id>     _keyIds;                                                // ids of all keys, in key order
+    std::vector<double> _scores;                                                // indexed by id
+    Scorer              _score;
+    std::size_t         _resultsPerNode;
+};
@@ -0,0 +1,121 @@
+#include <algorithm>  // min(), sort()
+#include <cstddef>    // size_t
+#include <exception>
+#include <iomanip>    // setprecision()
+#include <iostream>   // boolalpha(), showpoint(), fixed()
+#include <string>     // to_string()
+#include <utility>    // make_pair()
+#include <vector>
+
+#include "Book.hpp"
+#include "CheckResults.hpp"
+#include "CompletionTrie.hpp"
+
+
+
+
+
+namespace  // anonymous
+{
+  class CompletionTrieRegressionTest
+  {
+    public:
+      CompletionTrieRegressionTest();
+
+    private:
+      void tests();
+
+      Regression::CheckResults affirm;
+  } run_completionTrie_tests;
+
+
+
+
+  void CompletionTrieRegressionTest::tests()
+  {
+    using Ids = std::vector<CompletionTrie::Id>;
+
+    {
+      const Book hobbit     ( "The Hobbit",              "J. R. R. Tolkien", "0261102214", 12.99 );
+      const Book illustrated( "The Hobbit: Illustrated", "J. R. R. Tolkien", "0007525508", 30.00 );
+      const Book theory     ( "Theory of Everything",    "Stephen Hawking",  "0553380168", 15.00 );
+      const Book paperback  ( "The  hobbit",             "J. R. R. Tolkien", "0345339681",  7.99 );
+      const Book zen        ( "Zen",                     "Alan Watts",       "0261000000",  5.00 );
+
+      //                                                    id:  0        1             2        3        4           5
+      const std::vector<const Book *> books{ &hobbit, &illustrated, nullptr, &theory, &paperback, &zen };
+      const CompletionTrie            byPrice( books );
+
+      affirm.is_equal( "Completion trie - normalized",                      std::string( "the hobbit" ), CompletionTrie::normalize( "  The  Hobbit: " ) );
+      affirm.is_equal( "Completion trie - trailing separator kept",         std::string( "the "       ), CompletionTrie::normalize( "The -", true     ) );
+      affirm.is_true ( "Completion trie - title prefix, highest first",     byPrice.complete( "the",          10 ) == Ids{ 1, 3, 0, 4 } );
+      affirm.is_true ( "Completion trie - whole word prefix",               byPrice.complete( "THE ",         10 ) == Ids{ 1, 0, 4 } );
+      affirm.is_true ( "Completion trie - whole title prefix",              byPrice.complete( "the hobbit.",  10 ) == Ids{ 1, 0, 4 } );
+      affirm.is_true ( "Completion trie - completes tests",                 CompletionTrie::completes( "the hobbit!", "The Hobbit" ) && !CompletionTrie::completes( "the ", "Theory" ) );
+      affirm.is_true ( "Completion trie - limited",                         byPrice.complete( "the hobbit",    2 ) == Ids{ 1, 0 } );
+      affirm.is_true ( "Completion trie - partial ISBN",                    byPrice.complete( "0261",         10 ) == Ids{ 0, 5 } );
+      affirm.is_true ( "Completion trie - prefix within a label",           byPrice.complete( "02611",        10 ) == Ids{ 0 } );
+      affirm.is_true ( "Completion trie - empty prefix completes anything", byPrice.complete( "",              1 ) == Ids{ 1 } );
+      affirm.is_true ( "Completion trie - unknown prefix",                  byPrice.complete( "the hobbitx",  10 ).empty() && byPrice.complete( "x", 10 ).empty() );
+
+      const CompletionTrie cheapestFirst( books, []( const Book & book ) { return -book.price(); }, 2 );
+      affirm.is_true ( "Completion trie - custom score",                    cheapestFirst.complete( "the",  2 ) == Ids{ 4, 0 } );
+      affirm.is_true ( "Completion trie - beyond the precomputed results",  cheapestFirst.complete( "the", 10 ) == Ids{ 4, 0, 3, 1 } );
+      affirm.is_true ( "Completion trie - size reported",                   cheapestFirst.sizeInBytes() > 0 );
+    }
+
+    {
+      // Enough books for a deep, bushy tree, compared against ranking every match by brute force
+      constexpr std::size_t BOOK_COUNT = 5'000;
+
+      std::vector<Book>         books;
+      std::vector<const Book *> pointers;
+      books.reserve( BOOK_COUNT );
+      for( std::size_t id = 0; id < BOOK_COUNT; ++id )
+      {
+        books.emplace_back( "Book " + std::to_string( id ), "", "", static_cast<double>( id * 7'919 % 1'000 ) );
+        pointers.push_back( &books.back() );
+      }
+
+      const CompletionTrie trie( pointers );
+
+      for( const std::string prefix : { "book 1", "book 42", "b", "book 4999" } )
+      {
+        Ids expected;
+        for( CompletionTrie::Id id = 0; id < BOOK_COUNT; ++id )
+        {
+          if( CompletionTrie::normalize( books[id].title() ).compare( 0, prefix.size(), prefix ) == 0 ) expected.push_back( id );
+        }
+        std::sort( expected.begin(), expected.end(), [&]( auto lhs, auto rhs )
+                   { return std::make_pair( -books[lhs].price(), lhs ) < std::make_pair( -books[rhs].price(), rhs ); } );
+
+        for( std::size_t limit : { std::size_t{ 5 }, std::size_t{ 50 } } )
+        {
+          const Ids best( expected.begin(), expected.begin() + static_cast<std::ptrdiff_t>( std::min( limit, expected.size() ) ) );
+          affirm.is_true( "Completion trie - \"" + prefix + "\" top " + std::to_string( limit ) + " matches brute force", trie.complete( prefix, limit ) == best );
+        }
+      }
+    }
+  }
+
+
+
+  CompletionTrieRegressionTest::CompletionTrieRegressionTest()
+  {
+    std::clog << std::boolalpha << std::showpoint << std::fixed << std::setprecision( 2 );
+
+
+    try
+    {
+      std::clog << "\nCompletion Trie Regression Test:\n";
+      tests();
+
+      std::clog << affirm << '\n';
+    }
+    catch( const std::exception & ex )
+    {
+      std::clog << "FAILURE:  Regression test for \"class CompletionTrie\" failed with an unhandled exception. \n\n\n"
+                << ex.what() << std::endl;
+    }
+  }
+} // namespace
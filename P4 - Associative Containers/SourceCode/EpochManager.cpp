@@ -0,0 +1,141 @@
+#include <atomic>
+#include <cstddef>    // size_t
+#include <cstdint>    // uint64_t
+#include <mutex>
+#include <thread>     // yield()
+#include <vector>
+
+#include "EpochManager.hpp"
+
+
+
+namespace  // anonymous
+{
+  // Hands out dense thread identifiers, recycling them as threads end so long running programs that start and stop many threads
+  // don't exhaust the slots
+  class ThreadSlotRegistry
+  {
+    public:
+      ThreadSlotRegistry()
+      {
+        std::lock_guard<std::mutex> lock( mutex() );
+
+        if( !freeSlots().empty() )                              { slot = freeSlots().back();  freeSlots().pop_back(); }
+        else if( nextSlot() < EpochManager::MAX_READERS )       { slot = nextSlot()++;                                 }
+      }
+
+     ~ThreadSlotRegistry()
+      {
+        if( slot == EpochManager::MAX_READERS ) return;
+
+        std::lock_guard<std::mutex> lock( mutex() );
+        freeSlots().push_back( slot );
+      }
+
+      std::size_t slot = EpochManager::MAX_READERS;             // the shared overflow slot unless a private one is available
+
+    private:
+      // Function local statics avoid depending on the order in which objects at namespace scope are initialized across translation
+      // units.  They're never destroyed, since threads such as ThreadPool's workers may end, and give back their slots, while statics
+      // are being destroyed at exit.
+      static std::mutex               & mutex()     { static auto * instance = new std::mutex;               return *instance; }
+      static std::vector<std::size_t> & freeSlots() { static auto * instance = new std::vector<std::size_t>; return *instance; }
+      static std::size_t              & nextSlot()  { static std::size_t              instance = 0; return instance; }
+  };
+}
+
+
+
+std::size_t EpochManager::threadSlot()
+{
+  thread_local ThreadSlotRegistry registration;
+  return registration.slot;
+}
+
+
+
+EpochManager::ReadGuard EpochManager::enter()
+{
+  return ReadGuard( *this );
+}
+
+
+
+EpochManager::ReadGuard::ReadGuard( EpochManager & manager )
+  : _manager( &manager ), _slot( threadSlot() )
+{
+  if( _slot == MAX_READERS )
+  {
+    _manager->_overflowReaders.fetch_add( 1 );
+    return;
+  }
+
+  // Only the outermost critical section records the epoch.  The store is sequentially consistent so it is ordered before whatever
+  // shared pointer the reader loads next.
+  auto & slot = _manager->_slots[_slot];
+  if( slot.depth++ == 0 ) slot.epoch.store( _manager->_globalEpoch.load() );
+}
+
+
+
+EpochManager::ReadGuard::ReadGuard( ReadGuard && other ) noexcept
+  : _manager( other._manager ), _slot( other._slot )
+{
+  other._manager = nullptr;
+}
+
+
+
+EpochManager::ReadGuard::~ReadGuard()
+{
+  if( _manager == nullptr ) return;                             // moved from
+
+  if( _slot == MAX_READERS )
+  {
+    _manager->_overflowReaders.fetch_sub( 1 );
+    return;
+  }
+
+  auto & slot = _manager->_slots[_slot];
+  if( --slot.depth == 0 ) slot.epoch.store( IDLE, std::memory_order_release );
+}
+
+
+
+void EpochManager::synchronize()
+{
+  // Readers that begin after this point observe the new epoch, and therefore also whatever the writer published before calling
+  // synchronize().  Only readers that recorded an older epoch might still hold a reference to the old data, so wait for them.
+  const std::uint64_t newEpoch = _globalEpoch.fetch_add( 1 ) + 1;
+
+  for( auto & slot : _slots )
+  {
+    for( auto epoch = slot.epoch.load(); epoch != IDLE && epoch < newEpoch; epoch = slot.epoch.load() ) std::this_thread::yield();
+  }
+
+  // Overflow readers don't record an epoch, so conservatively wait until there are none at all
+  while( _overflowReaders.load() != 0 ) std::this_thread::yield();
+}
+
+
+
+std::uint64_t EpochManager::advance()
+{
+  return _globalEpoch.fetch_add( 1 ) + 1;
+}
+
+
+
+std::uint64_t EpochManager::oldestReader() const
+{
+  // Overflow readers don't record an epoch, so conservatively treat them as older than any
+  if( _overflowReaders.load() != 0 ) return 0;
+
+  auto oldest = _globalEpoch.load() + 1;
+  for( const auto & slot : _slots )
+  {
+    if( const auto epoch = slot.epoch.load(); epoch != IDLE && epoch < oldest ) oldest = epoch;
+  }
+
+  return oldest;
+}
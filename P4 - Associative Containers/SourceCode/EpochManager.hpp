@@ -0,0 +1,72 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>    // size_t
+#include <cstdint>    // uint64_t
+
+
+
+// Epoch based reclamation, the heart of a read-copy-update (RCU) scheme.  Readers announce when they are about to read shared data
+// by entering a read-side critical section, and announce when they are done by leaving it.  A writer replaces the shared data by
+// publishing a new version, then calls synchronize() to wait until every reader that might still be looking at the old version has
+// left its critical section.  After that, nobody can reach the old version and it may be freed.
+//
+// Each thread announces itself in its own cache line sized slot, so readers never write to memory another reader touches.  Entering
+// and leaving a critical section costs a couple of uncontended stores regardless of how many threads are reading, which lets read
+// throughput scale with the number of threads.  Threads beyond MAX_READERS share an overflow counter, which is correct but slower.
+class EpochManager
+{
+  public:
+    static constexpr std::size_t MAX_READERS = 256;
+
+    // RAII read-side critical section.  Critical sections may nest within a thread.
+    class ReadGuard
+    {
+      public:
+        ReadGuard            ( EpochManager & manager );
+        ReadGuard            ( ReadGuard   && other ) noexcept;
+        ReadGuard            ( const ReadGuard & )  = delete;
+        ReadGuard & operator=( const ReadGuard & )  = delete;
+        ReadGuard & operator=( ReadGuard && )       = delete;
+       ~ReadGuard();
+
+      private:
+        EpochManager * _manager;
+        std::size_t    _slot;
+    };
+
+    // Constructors, assignments, destructor
+    EpochManager            ()                      = default;
+    EpochManager            ( const EpochManager & ) = delete;
+    EpochManager & operator=( const EpochManager & ) = delete;
+
+    // Operations
+    ReadGuard enter();                                               // Begins a read-side critical section on the calling thread
+    void      synchronize();                                         // Waits for every critical section already begun to end.  Must
+                                                                     // not be called from within a critical section.
+
+    // Reclamation without waiting, for data retired from within critical sections.  Retire data by making it unreachable, then
+    // calling advance() and remembering the epoch returned.  Once that epoch is no later than oldestReader(), every critical section
+    // that might have reached the data has ended and it may be freed.
+    std::uint64_t advance     ();                                    // Begins and returns a new epoch
+    std::uint64_t oldestReader() const;                              // The epoch the oldest critical section under way began in,
+                                                                     // or one past the current epoch if there are none
+
+    // Returns a small, dense identifier for the calling thread in [0, MAX_READERS], where MAX_READERS means the thread has no slot of
+    // its own and shares the overflow slot.  Useful for keeping other per-thread data, such as statistics, free of contention.
+    static std::size_t threadSlot();
+
+  private:
+    static constexpr std::uint64_t IDLE = 0;                         // epoch recorded by a slot whose thread is not reading
+
+    struct alignas( 64 ) Slot
+    {
+      std::atomic<std::uint64_t> epoch{ IDLE };                      // epoch observed when the outermost critical section began
+      std::size_t                depth = 0;                          // critical section nesting depth, touched only by the owner
+    };
+
+    alignas( 64 ) std::atomic<std::uint64_t>  _globalEpoch{ 1 };
+    alignas( 64 ) std::atomic<std::size_t>    _overflowReaders{ 0 };
+    std::array<Slot, MAX_READERS>             _slots;
+};
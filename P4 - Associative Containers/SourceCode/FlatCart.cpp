@@ -0,0 +1,268 @@
+#include <algorithm>     // max(), stable_sort()
+#include <cstddef>       // size_t
+#include <cstdint>       // uint32_t
+#include <cstring>       // memcpy()
+#include <iterator>      // make_move_iterator(), next(), prev()
+#include <memory>        // make_unique()
+#include <stdexcept>     // logic_error
+#include <string_view>
+#include <vector>
+
+#include "FlatCart.hpp"
+
+
+
+CartItem::CartItem( std::string_view isbn, std::string_view title, unsigned int quantity )
+  : _quantity( quantity ), _titleLength( static_cast<std::uint32_t>( title.size() ) ), _title( title.data() )
+{
+  if( isbn.size() <= PACKED_LENGTH )
+  {
+    std::memcpy( _isbn.data(), isbn.data(), isbn.size() );
+    _length = static_cast<std::uint8_t>( isbn.size() );
+  }
+  else
+  {
+    const char *  text   = isbn.data();
+    std::uint32_t length = static_cast<std::uint32_t>( isbn.size() );
+    std::memcpy( _isbn.data(),                  &text,   sizeof( text   ) );
+    std::memcpy( _isbn.data() + sizeof( text ), &length, sizeof( length ) );
+    _length = REFERRED;
+  }
+}
+
+
+
+std::string_view CartItem::isbn() const
+{
+  if( _length != REFERRED ) return { _isbn.data(), _length };
+
+  const char *  text;
+  std::uint32_t length;
+  std::memcpy( &text,   _isbn.data(),                  sizeof( text   ) );
+  std::memcpy( &length, _isbn.data() + sizeof( text ), sizeof( length ) );
+  return { text, length };
+}
+
+
+
+std::string_view CartItem::title() const
+{
+  return { _title, _titleLength };
+}
+
+
+
+unsigned int CartItem::quantity() const
+{
+  return _quantity;
+}
+
+
+
+void CartItem::sortAndMerge( std::vector<CartItem> & items, std::size_t first )
+{
+  // The sort is stable, so the title kept is the one first added
+  auto begin = items.begin() + static_cast<std::ptrdiff_t>( first );
+  std::stable_sort( begin, items.end(), []( const CartItem & lhs, const CartItem & rhs ) { return lhs.isbn() < rhs.isbn(); } );
+
+  if( begin == items.end() ) return;
+
+  auto kept = begin;
+  for( auto it = std::next( begin ); it != items.end(); ++it )
+  {
+    if( it->isbn() == kept->isbn() ) kept->_quantity += it->_quantity;
+    else                             *++kept = *it;
+  }
+  items.erase( std::next( kept ), items.end() );
+}
+
+
+
+
+
+
+
+void FlatCart::add( std::string_view isbn, std::string_view title, unsigned int quantity )
+{
+  _items.emplace_back( isbn, title, quantity );
+}
+
+
+
+void FlatCart::close()
+{
+  CartItem::sortAndMerge( _items, 0 );
+}
+
+
+
+const CartItem * FlatCart::begin() const { return _items.data();                 }
+const CartItem * FlatCart::end  () const { return _items.data() + _items.size(); }
+std::size_t      FlatCart::size () const { return _items.size();                 }
+bool             FlatCart::empty() const { return _items.empty();                }
+
+
+
+
+
+
+
+CartBatch::Cart::Cart( std::string_view name, const CartItem * first, std::size_t size )
+  : _name( name ), _first( first ), _size( size )
+{}
+
+
+
+std::string_view CartBatch::Cart::name () const { return _name;          }
+const CartItem * CartBatch::Cart::begin() const { return _first;         }
+const CartItem * CartBatch::Cart::end  () const { return _first + _size; }
+std::size_t      CartBatch::Cart::size () const { return _size;          }
+bool             CartBatch::Cart::empty() const { return _size == 0;     }
+
+
+
+CartBatch::const_iterator::const_iterator( const CartBatch & batch, std::size_t index )
+  : _batch( &batch ), _index( index )
+{}
+
+
+
+CartBatch::Cart             CartBatch::const_iterator::operator* ()                               const { return ( *_batch )[_index];                                }
+CartBatch::const_iterator & CartBatch::const_iterator::operator++()                                     { ++_index;  return *this;                                   }
+bool                        CartBatch::const_iterator::operator==( const const_iterator & other ) const { return _batch == other._batch && _index == other._index; }
+bool                        CartBatch::const_iterator::operator!=( const const_iterator & other ) const { return !( *this == other );                          }
+
+
+
+
+
+
+
+CartBatch::CartBatch( const ShoppingCarts & carts )
+{
+  std::size_t items = 0;
+  for( auto & [name, cart] : carts ) items += cart.size();
+  _items.reserve( items );
+  _carts.reserve( carts.size() );
+
+  for( auto & [name, cart] : carts )
+  {
+    open( name );
+    for( auto & [isbn, book] : cart ) add( isbn, book.title() );
+    close();
+  }
+}
+
+
+
+void CartBatch::open( std::string_view customer )
+{
+  close();
+  _open   = keep( customer );
+  _isOpen = true;
+}
+
+
+
+void CartBatch::add( std::string_view isbn, std::string_view title, unsigned int quantity )
+{
+  if( !_isOpen ) throw std::logic_error( "CartBatch::add:  no cart open" );
+
+  _items.emplace_back( isbn.size() > CartItem::PACKED_LENGTH ? keep( isbn ) : isbn, keep( title ), quantity );
+}
+
+
+
+void CartBatch::add( std::string_view customer, const FlatCart & cart )
+{
+  open( customer );
+  for( auto & item : cart ) add( item.isbn(), item.title(), item.quantity() );
+  close();
+}
+
+
+
+void CartBatch::close()
+{
+  if( !_isOpen ) return;
+
+  const auto first = _carts.empty() ? 0 : _carts.back().first + _carts.back().size;
+  CartItem::sortAndMerge( _items, first );
+  _carts.push_back( { _open, first, _items.size() - first } );
+  _isOpen = false;
+}
+
+
+
+void CartBatch::append( CartBatch && other )
+{
+  close();
+  other.close();
+
+  const auto offset = _items.size();
+  _items.insert( _items.end(), other._items.begin(), other._items.end() );
+  for( auto span : other._carts )
+  {
+    span.first += offset;
+    _carts.push_back( span );
+  }
+
+  // The text other kept moves with its blocks, which go ahead of the block this batch is filling
+  if( _blocks.empty() )
+  {
+    _used     = other._used;
+    _capacity = other._capacity;
+  }
+  _blocks.insert( _blocks.empty() ? _blocks.end() : std::prev( _blocks.end() ), std::make_move_iterator( other._blocks.begin() ), std::make_move_iterator( other._blocks.end() ) );
+
+  other._items .clear();
+  other._carts .clear();
+  other._blocks.clear();
+}
+
+
+
+void CartBatch::reserve( std::size_t carts, std::size_t items )
+{
+  _carts.reserve( carts );
+  _items.reserve( items );
+}
+
+
+
+CartBatch::Cart CartBatch::operator[]( std::size_t index ) const
+{
+  auto & span = _carts.at( index );
+  return { span.name, _items.data() + span.first, span.size };
+}
+
+
+
+CartBatch::const_iterator CartBatch::begin() const { return { *this, 0             }; }
+CartBatch::const_iterator CartBatch::end  () const { return { *this, _carts.size() }; }
+std::size_t               CartBatch::size () const { return _carts.size();            }
+
+std::size_t CartBatch::items() const
+{
+  return _carts.empty() ? 0 : _carts.back().first + _carts.back().size;
+}
+
+
+
+std::string_view CartBatch::keep( std::string_view text )
+{
+  if( text.empty() ) return {};
+
+  // A moved from batch has no blocks, so starts a new one
+  if( _blocks.empty() || _capacity - _used < text.size() )
+  {
+    _capacity = std::max( BLOCK_SIZE, text.size() );
+    _used     = 0;
+    _blocks.push_back( std::make_unique<char[]>( _capacity ) );
+  }
+
+  auto kept = _blocks.back().get() + _used;
+  std::memcpy( kept, text.data(), text.size() );
+  _used += text.size();
+  return { kept, text.size() };
+}
@@ -0,0 +1,163 @@
+#pragma once
+
+#include <array>
+#include <cstddef>    // size_t
+#include <cstdint>    // uint8_t, uint32_t
+#include <map>
+#include <memory>     // unique_ptr
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Book.hpp"
+
+
+
+// Shopping carts laid out flat in memory, for checking out without chasing pointers.  A cart held as a map of Books costs a tree node
+// and three strings per book just to carry an ISBN and a title.  A flat cart is an array of small items, each with the ISBN packed
+// into the item itself, the quantity, and a reference to the title, if there is one.
+
+
+
+// One line of a flat cart.  An ISBN of up to PACKED_LENGTH characters, which is every ISBN, hyphens and all, is copied into the item.
+// A longer one, and the title, are only referred to, so must outlive the item.
+class CartItem
+{
+  public:
+    static constexpr std::size_t PACKED_LENGTH = 23;
+
+    // Constructors
+    CartItem( std::string_view isbn, std::string_view title = {}, unsigned int quantity = 1 );
+
+    // Queries
+    std::string_view isbn    () const;                                          // Views into the item itself if packed, so is valid
+    std::string_view title   () const;                                          // only as long as the item stays put
+    unsigned int     quantity() const;
+
+  private:
+    friend class FlatCart;
+    friend class CartBatch;
+
+    static constexpr std::uint8_t REFERRED = 0xFF;                              // _length of an ISBN too long to pack
+
+    // Puts the items from first on in ISBN order and merges duplicates into the first added
+    static void sortAndMerge( std::vector<CartItem> & items, std::size_t first );
+
+    std::array<char, PACKED_LENGTH> _isbn        = {};                          // or, if REFERRED, a pointer to it and its length
+    std::uint8_t                    _length      = 0;
+    std::uint32_t                   _quantity    = 1;
+    std::uint32_t                   _titleLength = 0;
+    const char *                    _title       = nullptr;
+};
+
+
+
+// One customer's cart.  Items are added in any order, then close() puts them in ISBN order, as a cart kept in a map would be, and
+// merges any ISBN added more than once into one item.
+class FlatCart
+{
+  public:
+    // Operations
+    void add  ( std::string_view isbn, std::string_view title = {}, unsigned int quantity = 1 );  // see CartItem for what's copied
+    void close();                                                               // Sorts by ISBN and merges duplicates, summing their
+                                                                                // quantities and keeping the first title
+    // Queries
+    const CartItem * begin() const;
+    const CartItem * end  () const;
+    std::size_t      size () const;
+    bool             empty() const;
+
+  private:
+    std::vector<CartItem> _items;
+};
+
+
+
+// Many customers' carts, their items back to back in one array, with the names, titles and long ISBNs copied into an arena the
+// batch owns.  Carts are checked out in the order they were added, so add them in name order to match a map of carts.
+class CartBatch
+{
+  public:
+    using ShoppingCarts = std::map<std::string /*name*/, std::map<std::string /*ISBN*/, Book>>;       // as Bookstore::ShoppingCarts
+
+    // One cart in the batch, valid as long as the batch is and no cart is added
+    class Cart
+    {
+      public:
+        std::string_view name () const;
+        const CartItem * begin() const;
+        const CartItem * end  () const;
+        std::size_t      size () const;
+        bool             empty() const;
+
+      private:
+        friend class CartBatch;
+        Cart( std::string_view name, const CartItem * first, std::size_t size );
+
+        std::string_view _name;
+        const CartItem * _first = nullptr;
+        std::size_t      _size  = 0;
+    };
+
+    class const_iterator
+    {
+      public:
+        Cart             operator* ()                               const;
+        const_iterator & operator++();
+        bool             operator==( const const_iterator & other ) const;
+        bool             operator!=( const const_iterator & other ) const;
+
+      private:
+        friend class CartBatch;
+        const_iterator( const CartBatch & batch, std::size_t index );
+
+        const CartBatch * _batch;
+        std::size_t       _index;
+    };
+
+    // Constructors, assignments
+    CartBatch() = default;
+    explicit CartBatch( const ShoppingCarts & carts );
+
+    CartBatch            ( const CartBatch & ) = delete;                        // items refer into the arena
+    CartBatch & operator=( const CartBatch & ) = delete;
+    CartBatch            ( CartBatch && )      = default;
+    CartBatch & operator=( CartBatch && )      = default;
+
+    // Operations
+    void open ( std::string_view customer );                                    // Begins the customer's cart, closing the last
+    void add  ( std::string_view isbn, std::string_view title = {}, unsigned int quantity = 1 );   // to the cart open, copying the
+                                                                                // ISBN and title
+    void add  ( std::string_view customer, const FlatCart & cart );             // Copies a closed cart
+    void close();                                                               // Closes the cart open, as FlatCart::close() does
+    void append ( CartBatch && other );                                         // Moves other's carts after these, closing both
+    void reserve( std::size_t carts, std::size_t items );
+
+    // Queries
+    Cart           operator[]( std::size_t index ) const;                       // Carts closed, in the order added
+    const_iterator begin     ()                    const;
+    const_iterator end       ()                    const;
+    std::size_t    size      ()                    const;
+    std::size_t    items     ()                    const;                       // in all the carts closed
+
+  private:
+    static constexpr std::size_t BLOCK_SIZE = 64 * 1024;
+
+    struct Span
+    {
+      std::string_view name;
+      std::size_t      first = 0;
+      std::size_t      size  = 0;
+    };
+
+    std::string_view keep( std::string_view text );                            // copies text into the arena
+
+    std::vector<CartItem>                _items;                                // every cart's, the open one's last
+    std::vector<Span>                    _carts;                                // closed
+    std::string_view                     _open;                                 // name of the cart open
+    bool                                 _isOpen = false;
+
+    std::vector<std::unique_ptr<char[]>> _blocks;                               // the arena.  Blocks never move, so text kept stays put.
+    std::size_t                          _used     = 0;                         // of the last block
+    std::size_t                          _capacity = 0;
+};
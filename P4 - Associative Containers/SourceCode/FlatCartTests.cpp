@@ -0,0 +1,137 @@
+#include <cstddef>    // size_t
+#include <exception>
+#include <iomanip>    // setprecision()
+#include <iostream>   // boolalpha(), showpoint(), fixed()
+#include <stdexcept>  // logic_error
+#include <string>
+#include <string_view>
+#include <utility>    // move()
+#include <vector>
+
+#include "Book.hpp"
+#include "CheckResults.hpp"
+#include "FlatCart.hpp"
+
+
+
+
+
+namespace  // anonymous
+{
+  class FlatCartRegressionTest
+  {
+    public:
+      FlatCartRegressionTest();
+
+    private:
+      void tests();
+
+      Regression::CheckResults affirm;
+  } run_flatCart_tests;
+
+
+
+
+  // The cart's ISBNs, titles and quantities, in order, as "isbn/title/quantity" strings
+  template<typename Cart>
+  std::vector<std::string> contents( const Cart & cart )
+  {
+    std::vector<std::string> lines;
+    for( auto & item : cart ) lines.push_back( std::string( item.isbn() ) + '/' + std::string( item.title() ) + '/' + std::to_string( item.quantity() ) );
+    return lines;
+  }
+
+
+
+  void FlatCartRegressionTest::tests()
+  {
+    const std::string longIsbn = "ISBN-13: 978-0-306-40615-7 (paperback)";
+
+    {
+      // A closed cart is in ISBN order with duplicates merged, keeping the first title
+      FlatCart cart;
+      cart.add( "9991137319", "Grasses of U of L" );
+      cart.add( "54782169785", "131 Answer Key", 2 );
+      cart.add( longIsbn );
+      cart.add( "9991137319", "Grasses again", 3 );
+      cart.close();
+
+      affirm.is_equal( "Flat cart - size",                             3ULL, cart.size() );
+      affirm.is_true ( "Flat cart - sorted and merged",                contents( cart ) == std::vector<std::string>{ "54782169785/131 Answer Key/2", "9991137319/Grasses of U of L/4", longIsbn + "//1" } );
+      affirm.is_true ( "Flat cart - short ISBN packed into the item",  cart.begin()->isbn().data() == reinterpret_cast<const char *>( cart.begin() ) );
+    }
+
+    {
+      // A batch copies what it's given, so holds its carts after the originals are gone
+      CartBatch::ShoppingCarts carts = { { "Red Baron", { { "9991137319", Book( "Grasses of U of L" ) }, { "54782169785", Book( "131 Answer Key" ) } } },
+                                         { "Woodstock", { { "9802161748", Book( "Wild mammals"      ) } } } };
+      CartBatch batch( carts );
+
+      FlatCart flat;
+      {
+        std::string isbn = longIsbn, title = "Long ISBN";
+        flat.add( isbn, title );
+        flat.close();
+        batch.add( "Snoopy", flat );
+        batch.open( "Linus" );
+        batch.add( "0002", "Blanket", 2 );
+        batch.add( "0001" );
+        batch.add( "0002", "", 1 );
+        batch.close();
+        isbn.assign( isbn.size(), '?' );
+        title.assign( title.size(), '?' );
+      }
+      carts.clear();
+
+      std::vector<std::string> names;
+      for( auto cart : batch ) names.emplace_back( cart.name() );
+
+      affirm.is_equal( "Cart batch - carts",                           4ULL, batch.size() );
+      affirm.is_equal( "Cart batch - items",                           6ULL, batch.items() );
+      affirm.is_true ( "Cart batch - carts in the order added",        names == std::vector<std::string>{ "Red Baron", "Woodstock", "Snoopy", "Linus" } );
+      affirm.is_true ( "Cart batch - cart from a map",                 contents( batch[0] ) == std::vector<std::string>{ "54782169785/131 Answer Key/1", "9991137319/Grasses of U of L/1" } );
+      affirm.is_true ( "Cart batch - flat cart copied",                contents( batch[2] ) == std::vector<std::string>{ longIsbn + "/Long ISBN/1" } );
+      affirm.is_true ( "Cart batch - sorted and merged on close",      contents( batch[3] ) == std::vector<std::string>{ "0001//1", "0002/Blanket/3" } );
+      affirm.is_true ( "Cart batch - items back to back",              batch[0].end() == batch[1].begin() && batch[2].end() == batch[3].begin() );
+
+      CartBatch moved( std::move( batch ) );
+      affirm.is_true ( "Cart batch - moved",                           moved.size() == 4 && contents( moved[2] ) == std::vector<std::string>{ longIsbn + "/Long ISBN/1" } );
+    }
+
+    {
+      // Text larger than an arena block gets one of its own, and an item needs an open cart
+      CartBatch         batch;
+      const std::string title( 100'000, 't' );
+      batch.open( "Peppermint Patty" );
+      batch.add( "0001", title );
+      batch.close();
+      affirm.is_true ( "Cart batch - large title kept",                batch[0].begin()->title() == title && batch[0].name() == "Peppermint Patty" );
+
+      bool threw = false;
+      try                                     { batch.add( "0002" ); }
+      catch( const std::logic_error & )       { threw = true;        }
+      affirm.is_true ( "Cart batch - no cart open",                    threw );
+    }
+  }
+
+
+
+  FlatCartRegressionTest::FlatCartRegressionTest()
+  {
+    std::clog << std::boolalpha << std::showpoint << std::fixed << std::setprecision( 2 );
+
+
+    try
+    {
+      std::clog << "\nFlat Cart Regression Test:\n";
+      tests();
+
+      std::clog << affirm << '\n';
+    }
+    catch( const std::exception & ex )
+    {
+      std::clog << "FAILURE:  Regression test for \"class CartBatch\" failed with an unhandled exception. \n\n\n"
+                << ex.what() << std::endl;
+    }
+  }
+} // namespace
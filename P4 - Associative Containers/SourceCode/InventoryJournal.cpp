@@ -0,0 +1,452 @@
+#include <algorithm>     // min()
+#include <cstddef>       // size_t
+#include <cstdint>       // uint32_t, uint64_t
+#include <cstdio>        // FILE, fopen(), fwrite(), fflush(), fclose()
+#include <filesystem>    // exists(), remove(), rename(), resize_file()
+#include <functional>    // function
+#include <fstream>
+#include <future>        // async(), shared_future
+#include <iomanip>       // quoted()
+#include <iterator>      // istreambuf_iterator
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <system_error>  // error_code
+#include <utility>       // move(), swap()
+
+#if defined( _WIN32 )
+  #include <io.h>        // _commit(), _fileno()
+#else
+  #include <fcntl.h>     // open()
+  #include <unistd.h>    // fsync(), close()
+#endif
+
+#include "InventoryJournal.hpp"
+
+
+
+namespace  // anonymous
+{
+  constexpr std::string_view SEGMENT_MAGIC  = "INVJRNL1";
+  constexpr std::string_view SNAPSHOT_MAGIC = "INVSNAP1";
+
+  // A segment is its magic followed by records, each a change and a checksum of it:
+  //    kind (1 byte), ISBN length (4), ISBN, quantity (4), checksum (4)
+  // A snapshot is its magic, the last segment it covers (8), the number of books (8), each book's ISBN length (4), ISBN and quantity
+  // (4), then a checksum (8) of all that.  Numbers are little endian.
+
+  std::string segmentName ( const std::string & inventoryFile, std::uint64_t segment ) { return inventoryFile + ".journal." + std::to_string( segment ); }
+  std::string snapshotName( const std::string & inventoryFile )                         { return inventoryFile + ".snapshot";                            }
+
+
+
+  // FNV-1a
+  std::uint64_t checksum( std::string_view bytes )
+  {
+    std::uint64_t hash = 0xCBF2'9CE4'8422'2325ULL;
+    for( unsigned char c : bytes ) hash = ( hash ^ c ) * 0x0000'0100'0000'01B3ULL;
+    return hash;
+  }
+
+
+
+  void put( std::string & bytes, std::uint64_t value, std::size_t size )
+  {
+    for( std::size_t i = 0; i < size; ++i, value >>= 8 ) bytes += static_cast<char>( value & 0xFF );
+  }
+
+  // Reads size bytes at offset, advancing it, or returns false if there aren't that many
+  bool get( std::string_view bytes, std::size_t & offset, std::uint64_t & value, std::size_t size )
+  {
+    if( bytes.size() - offset < size ) return false;
+
+    value = 0;
+    for( std::size_t i = size; i-- > 0; ) value = value << 8 | static_cast<unsigned char>( bytes[offset + i] );
+    offset += size;
+    return true;
+  }
+
+  bool get( std::string_view bytes, std::size_t & offset, std::string & text )
+  {
+    std::uint64_t length;
+    if( !get( bytes, offset, length, 4 ) || bytes.size() - offset < length ) return false;
+
+    text.assign( bytes.substr( offset, length ) );
+    offset += length;
+    return true;
+  }
+
+
+
+  std::string readFile( const std::string & filename )
+  {
+    std::ifstream file( filename, std::ios::binary );
+    return { std::istreambuf_iterator<char>( file ), std::istreambuf_iterator<char>() };
+  }
+
+
+
+  // Writes everything written so far through to the disk
+  bool syncToDisk( std::FILE * file )
+  {
+    if( std::fflush( file ) != 0 ) return false;
+
+    #if defined( _WIN32 )
+      return _commit( _fileno( file ) ) == 0;
+    #else
+      return fsync( fileno( file ) ) == 0;
+    #endif
+  }
+
+  // Makes files created in or renamed into the file's directory survive a crash.  Windows does so as the files themselves are synced.
+  void syncDirectoryOf( const std::string & filename )
+  {
+    #if !defined( _WIN32 )
+      auto directory = std::filesystem::path( filename ).parent_path();
+      if( directory.empty() ) directory = ".";
+
+      if( const auto descriptor = open( directory.c_str(), O_RDONLY ); descriptor >= 0 )
+      {
+        fsync( descriptor );
+        close( descriptor );
+      }
+    #else
+      static_cast<void>( filename );
+    #endif
+  }
+
+
+
+  // The last segment the inventory file's snapshot covers, 0 if there's no snapshot
+  std::uint64_t coveredBySnapshot( const std::string & inventoryFile )
+  {
+    std::ifstream file( snapshotName( inventoryFile ), std::ios::binary );
+    if( !file ) return 0;
+
+    std::string   header( SNAPSHOT_MAGIC.size() + 8, '\0' );
+    std::size_t   offset = SNAPSHOT_MAGIC.size();
+    std::uint64_t covered;
+    if( !file.read( header.data(), static_cast<std::streamsize>( header.size() ) ) || header.compare( 0, SNAPSHOT_MAGIC.size(), SNAPSHOT_MAGIC ) != 0 || !get( header, offset, covered, 8 ) )
+    {
+      throw InventoryJournal::Corrupt_Ex( "Not an inventory snapshot:  \"" + snapshotName( inventoryFile ) + '"' );
+    }
+    return covered;
+  }
+
+
+
+  void writeSnapshot( const std::string & inventoryFile, std::uint64_t covered, const InventoryJournal::Inventory & inventory )
+  {
+    std::string bytes( SNAPSHOT_MAGIC );
+    put( bytes, covered,          8 );
+    put( bytes, inventory.size(), 8 );
+    for( const auto & [isbn, quantity] : inventory )
+    {
+      put( bytes, isbn.size(), 4 );
+      bytes += isbn;
+      put( bytes, quantity,    4 );
+    }
+    put( bytes, checksum( bytes ), 8 );
+
+    // Written aside and renamed into place, so a crash part way leaves the previous snapshot as it was
+    const auto snapshot  = snapshotName( inventoryFile );
+    const auto temporary = snapshot + ".tmp";
+
+    std::FILE * file = std::fopen( temporary.c_str(), "wb" );
+    if( file == nullptr ) throw InventoryJournal::Io_Ex( "Unable to create inventory snapshot \"" + temporary + '"' );
+
+    const bool written = std::fwrite( bytes.data(), 1, bytes.size(), file ) == bytes.size() && syncToDisk( file );
+    std::fclose( file );
+    if( !written ) throw InventoryJournal::Io_Ex( "Unable to write inventory snapshot \"" + temporary + '"' );
+
+    std::filesystem::rename( temporary, snapshot );
+    syncDirectoryOf( snapshot );
+  }
+
+
+
+  InventoryJournal::Inventory readSnapshot( const std::string & inventoryFile, std::uint64_t & covered )
+  {
+    const auto filename = snapshotName( inventoryFile );
+    const auto bytes    = readFile( filename );
+
+    InventoryJournal::Inventory inventory;
+    std::string_view            view = bytes;
+    std::size_t                 offset;
+    std::uint64_t               count, stored;
+
+    bool intact = view.size() >= SNAPSHOT_MAGIC.size() + 8 && view.substr( 0, SNAPSHOT_MAGIC.size() ) == SNAPSHOT_MAGIC;
+    if( intact )
+    {
+      offset = view.size() - 8;
+      intact = get( view, offset, stored, 8 ) && stored == checksum( view.substr( 0, view.size() - 8 ) );
+    }
+
+    offset = SNAPSHOT_MAGIC.size();
+    intact = intact && get( view, offset, covered, 8 ) && get( view, offset, count, 8 );
+    for( ; intact && count > 0; --count )
+    {
+      std::string   isbn;
+      std::uint64_t quantity;
+      intact = get( view, offset, isbn ) && get( view, offset, quantity, 4 );
+      if( intact ) inventory.emplace_hint( inventory.end(), std::move( isbn ), static_cast<unsigned int>( quantity ) );
+    }
+
+    if( !intact ) throw InventoryJournal::Corrupt_Ex( "Damaged inventory snapshot:  \"" + filename + '"' );
+    return inventory;
+  }
+
+
+
+  // Applies the segment's changes up to the first one cut short or damaged, as by a crash while it was being written
+  void replay( const std::string & filename, InventoryJournal::Inventory & inventory )
+  {
+    const auto       bytes = readFile( filename );
+    std::string_view view  = bytes;
+    if( view.substr( 0, SEGMENT_MAGIC.size() ) != SEGMENT_MAGIC ) return;
+
+    for( std::size_t offset = SEGMENT_MAGIC.size(); offset < view.size(); )
+    {
+      const auto               start = offset;
+      InventoryJournal::Change change;
+      std::uint64_t            kind, quantity, stored;
+
+      if( !get( view, offset, kind, 1 ) || !get( view, offset, change.isbn ) || !get( view, offset, quantity, 4 ) ) return;
+      const auto sum = static_cast<std::uint32_t>( checksum( view.substr( start, offset - start ) ) );
+      if( !get( view, offset, stored, 4 ) || stored != sum ) return;
+
+      change.kind     = static_cast<InventoryJournal::Change::Kind>( kind );
+      change.quantity = static_cast<unsigned int>( quantity );
+      InventoryJournal::apply( inventory, change );
+    }
+  }
+}
+
+
+
+InventoryJournal::InventoryJournal( const std::string & inventoryFile, Sync sync )
+  : _inventoryFile( inventoryFile ),
+    _sync         ( sync ? std::move( sync ) : Sync( syncToDisk ) )
+{
+  const auto covered = coveredBySnapshot( inventoryFile );
+
+  // Segments the snapshot covers are left behind if the program ended before compaction removed them
+  for( auto segment = covered; segment > 0 && std::filesystem::remove( segmentName( inventoryFile, segment ) ); --segment ) {}
+
+  // Never append to a segment already there, whose last change may have been cut short
+  _firstSegment = covered + 1;
+  _segment      = covered;
+  while( std::filesystem::exists( segmentName( inventoryFile, _segment + 1 ) ) ) ++_segment;
+
+  std::lock_guard<std::mutex> lock( _mutex );
+  openSegment();
+}
+
+
+
+InventoryJournal::~InventoryJournal()
+{
+  try
+  {
+    commit();
+    if( _compacted.valid() ) _compacted.wait();
+  }
+  catch( ... ) {}                                                             // destructors mustn't throw, and there's no one to tell
+
+  if( _file != nullptr ) std::fclose( _file );
+}
+
+
+
+void InventoryJournal::openSegment()
+{
+  // Segments are numbered without gaps, since recovery stops at the first missing, so a segment that can't be created is tried again
+  const auto filename = segmentName( _inventoryFile, _segment + 1 );
+
+  _file = std::fopen( filename.c_str(), "wb" );
+  if( _file == nullptr ) throw Io_Ex( "Unable to create inventory journal \"" + filename + '"' );
+  ++_segment;
+  _segmentBytes = 0;
+
+  writeOut( std::string( SEGMENT_MAGIC ) );
+  syncDirectoryOf( filename );
+}
+
+
+
+void InventoryJournal::writeOut( const std::string & bytes )
+{
+  if( std::fwrite( bytes.data(), 1, bytes.size(), _file ) == bytes.size() && _sync( _file ) )
+  {
+    _segmentBytes += bytes.size();
+    return;
+  }
+
+  // The segment may now end part way through a change, after which nothing would be replayed, or hold every change written whole
+  // though it couldn't be synced, all of which would be.  So give it up, cut back to what it held before, so changes written again to
+  // the next segment aren't replayed twice.  The next write begins a new segment.
+  std::fclose( _file );
+  _file = nullptr;
+
+  std::error_code error;
+  std::filesystem::resize_file( segmentName( _inventoryFile, _segment ), _segmentBytes, error );
+  _withdrawn = !error;
+
+  throw Io_Ex( "Unable to write inventory journal \"" + segmentName( _inventoryFile, _segment ) + '"' );
+}
+
+
+
+void InventoryJournal::record( const Change & change )
+{
+  std::lock_guard<std::mutex> lock( _mutex );
+
+  const auto start = _buffer.size();
+  put( _buffer, static_cast<unsigned char>( change.kind ), 1 );
+  put( _buffer, change.isbn.size(), 4 );
+  _buffer += change.isbn;
+  put( _buffer, change.quantity, 4 );
+  put( _buffer, checksum( std::string_view( _buffer ).substr( start ) ), 4 );
+
+  ++_recorded;
+}
+
+
+
+void InventoryJournal::commit()
+{
+  std::unique_lock<std::mutex> lock( _mutex );
+  const auto wanted = _recorded;
+
+  while( _durable < wanted )
+  {
+    // Someone else is syncing, perhaps the very changes wanted.  Wait and see.
+    if( _syncing )
+    {
+      _synced.wait( lock );
+      continue;
+    }
+
+    // Sync everything recorded so far, letting more changes be recorded meanwhile
+    if( _file == nullptr ) openSegment();
+
+    std::string batch;
+    std::swap( batch, _buffer );
+    const auto batchEnd = _recorded;
+    _syncing = true;
+    lock.unlock();
+
+    try
+    {
+      writeOut( batch );
+    }
+    catch( ... )
+    {
+      // Written again to a new segment, unless it couldn't be cut back out of the one given up, from which it may yet be replayed
+      lock.lock();
+      if( _withdrawn ) _buffer.insert( 0, batch );
+      _syncing = false;
+      _synced.notify_all();
+      throw;
+    }
+
+    lock.lock();
+    _durable = batchEnd;
+    _syncing = false;
+    ++_syncs;
+    _synced.notify_all();
+  }
+}
+
+
+
+std::shared_future<void> InventoryJournal::compact( Inventory inventory )
+{
+  std::unique_lock<std::mutex> lock( _mutex );
+  _synced.wait( lock, [this] { return !_syncing; } );
+
+  // Close off the current segment with everything recorded so far, which the snapshot will cover, and begin the next
+  if( _file == nullptr ) openSegment();
+  if( !_buffer.empty() )
+  {
+    try
+    {
+      writeOut( _buffer );
+    }
+    catch( ... )
+    {
+      if( !_withdrawn ) _buffer.clear();                                    // as in commit()
+      throw;
+    }
+    _buffer.clear();
+    _durable = _recorded;
+    ++_syncs;
+  }
+  std::fclose( _file );
+  _file = nullptr;
+
+  const auto first   = _firstSegment;
+  const auto covered = _segment;
+  openSegment();
+  _firstSegment = covered + 1;
+
+  // Wait for the compaction before to finish, so snapshots are never replaced by older ones
+  _compacted = std::async( std::launch::async, [inventoryFile = _inventoryFile, first, covered, inventory = std::move( inventory ), previous = _compacted]
+                           {
+                             if( previous.valid() ) previous.wait();
+
+                             writeSnapshot( inventoryFile, covered, inventory );
+                             for( auto segment = first; segment <= covered; ++segment ) std::filesystem::remove( segmentName( inventoryFile, segment ) );
+                           } ).share();
+  return _compacted;
+}
+
+
+
+std::uint64_t InventoryJournal::syncs() const
+{
+  std::lock_guard<std::mutex> lock( _mutex );
+  return _syncs;
+}
+
+
+
+void InventoryJournal::apply( Inventory & inventory, const Change & change )
+{
+  if( change.kind == Change::Kind::STOCK ) { inventory[change.isbn] = change.quantity;  return; }
+  if( change.kind == Change::Kind::DELIST ) { inventory.erase( change.isbn );           return; }
+
+  auto book = inventory.find( change.isbn );
+  if( book == inventory.end() ) return;
+
+  if( change.kind == Change::Kind::SALE    ) book->second -= std::min( book->second, change.quantity );
+  if( change.kind == Change::Kind::RESTOCK ) book->second += change.quantity;
+}
+
+
+
+InventoryJournal::Inventory InventoryJournal::recover( const std::string & inventoryFile )
+{
+  Inventory     inventory;
+  std::uint64_t covered = 0;
+
+  if( std::filesystem::exists( snapshotName( inventoryFile ) ) )
+  {
+    inventory = readSnapshot( inventoryFile, covered );
+  }
+  else
+  {
+    // Same format the store opens with
+    std::ifstream fin( inventoryFile );
+    std::string   isbn;
+    unsigned int  quantity;
+    while( fin >> std::quoted( isbn ) >> quantity ) inventory[isbn] = quantity;
+  }
+
+  for( auto segment = covered + 1; std::filesystem::exists( segmentName( inventoryFile, segment ) ); ++segment )
+  {
+    replay( segmentName( inventoryFile, segment ), inventory );
+  }
+
+  return inventory;
+}
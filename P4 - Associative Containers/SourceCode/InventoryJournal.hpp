@@ -0,0 +1,97 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>    // uint64_t
+#include <cstdio>     // FILE
+#include <functional> // function
+#include <future>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+
+
+
+// A write-ahead journal of changes to a store's inventory, so sales, re-orders and books delisted outlast the program without
+// rewriting the whole inventory file after each.
+//
+// Changes are appended to the journal in a compact binary form, first to a buffer in memory, which is all recording a change costs.
+// commit() writes what's buffered to the file and waits for it to reach the disk, and many threads committing at once share a
+// single write and sync (group commit):  one thread syncs everything recorded so far while the others wait for it, then each returns
+// if its changes were among those synced, or else the next syncs everything recorded meanwhile.
+//
+// The journal is kept as numbered segment files beside the inventory file.  compact() starts a new segment, then in the background
+// writes a snapshot of the inventory as of the end of the old segments, after which they're no longer needed and are removed.
+// recover() rebuilds the inventory from the latest snapshot, or the inventory file itself if there's none yet, and the segments
+// after it.  A change recorded but not yet committed when the program ended may be lost, but nothing committed ever is.
+//
+// Files, for inventory file "BookstoreInventory.dat":
+//    BookstoreInventory.dat              the opening inventory, as text
+//    BookstoreInventory.dat.snapshot     the inventory as of the end of the segments it covers
+//    BookstoreInventory.dat.journal.N    segment N of the journal
+class InventoryJournal
+{
+  public:
+    using Inventory = std::map<std::string /*ISBN*/, unsigned int /*quantity*/>;
+    using Sync      = std::function<bool( std::FILE * file )>;         // Writes everything written to the file through to the disk,
+                                                                        // false if it couldn't
+
+    struct Corrupt_Ex : std::runtime_error { using runtime_error::runtime_error; };   // Thrown if a snapshot is damaged
+    struct Io_Ex      : std::runtime_error { using runtime_error::runtime_error; };   // Thrown if a file can't be written or synced
+
+    struct Change
+    {
+      enum class Kind : char
+      {
+        SALE    = 'S',                                                  // quantity books sold, but not below zero
+        RESTOCK = 'R',                                                  // quantity books received, if the book is stocked
+        DELIST  = 'D',                                                  // the book is no longer stocked
+        STOCK   = 'Q'                                                   // the book is stocked, with quantity on hand
+      };
+
+      Kind         kind     = Kind::SALE;
+      std::string  isbn;
+      unsigned int quantity = 0;
+    };
+
+    // Constructors, assignments, destructor
+    explicit InventoryJournal( const std::string & inventoryFile,      // Appends to a new segment after any already there.  Syncs
+                               Sync                sync = {} );        // with fsync() (_commit() on Windows) unless given another way.
+
+    InventoryJournal            ( const InventoryJournal & ) = delete;
+    InventoryJournal & operator=( const InventoryJournal & ) = delete;
+   ~InventoryJournal();                                                 // commits, and waits for compaction to finish
+
+    // Operations.  Each may be called from many threads at once.
+    void                     record ( const Change & change );          // Buffers the change, it's durable once committed
+    void                     commit ();                                 // Returns once every change recorded so far is on disk
+    std::shared_future<void> compact( Inventory inventory );            // inventory must reflect every change recorded.  The future
+                                                                        // is ready once the snapshot is written and the segments it
+                                                                        // covers are removed.  Compactions run one at a time.
+    // Queries
+    std::uint64_t syncs() const;                                        // Number of times the journal was synced to disk
+
+    static void      apply  ( Inventory & inventory, const Change & change );
+    static Inventory recover( const std::string & inventoryFile );      // The inventory as of the last change committed
+
+  private:
+    void openSegment();                                                 // Begins the next segment.  _mutex must be held.
+    void writeOut   ( const std::string & bytes );                      // Writes and syncs to the current segment, giving it up if
+                                                                        // that fails
+    std::string              _inventoryFile;
+    Sync                     _sync;
+    std::uint64_t            _segmentBytes = 0;                         // written to the current segment and synced
+    bool                     _withdrawn    = false;                     // the last write that failed was cut back out of its segment
+    std::uint64_t            _firstSegment = 1;                         // oldest segment not yet covered by a snapshot
+    std::uint64_t            _segment      = 0;                         // the one being appended to
+    std::FILE *              _file         = nullptr;                   // null if the segment was given up
+    std::shared_future<void> _compacted;                                // the last compaction begun
+
+    mutable std::mutex       _mutex;
+    std::condition_variable  _synced;
+    std::string              _buffer;                                   // recorded but not yet written
+    std::uint64_t            _recorded     = 0;                         // changes recorded, and of those, synced
+    std::uint64_t            _durable      = 0;
+    bool                     _syncing      = false;                     // some thread is writing and syncing
+    std::uint64_t            _syncs        = 0;
+};
@@ -0,0 +1,192 @@
+#include <cstddef>    // size_t
+#include <cstdio>     // FILE, fflush()
+#include <exception>
+#include <filesystem> // exists(), remove(), temp_directory_path()
+#include <fstream>
+#include <iomanip>    // setprecision(), quoted()
+#include <iostream>   // boolalpha(), showpoint(), fixed()
+#include <string>     // to_string()
+#include <thread>
+#include <vector>
+
+#include "CheckResults.hpp"
+#include "InventoryJournal.hpp"
+
+
+
+
+
+namespace  // anonymous
+{
+  class InventoryJournalRegressionTest
+  {
+    public:
+      InventoryJournalRegressionTest();
+
+    private:
+      void tests();
+
+      Regression::CheckResults affirm;
+  } run_inventoryJournal_tests;
+
+
+
+
+  void removeJournal( const std::string & inventoryFile )
+  {
+    std::filesystem::remove( inventoryFile );
+    std::filesystem::remove( inventoryFile + ".snapshot" );
+    std::filesystem::remove( inventoryFile + ".snapshot.tmp" );
+    for( std::size_t segment = 1; segment <= 20; ++segment ) std::filesystem::remove( inventoryFile + ".journal." + std::to_string( segment ) );
+  }
+
+
+
+  void InventoryJournalRegressionTest::tests()
+  {
+    using Kind = InventoryJournal::Change::Kind;
+
+    const auto filename = ( std::filesystem::temp_directory_path() / "InventoryJournalTests.dat" ).string();
+    removeJournal( filename );
+
+    InventoryJournal::Inventory expected = { { "0001", 10 }, { "0002", 1 }, { "0003", 7 } };
+    {
+      std::ofstream file( filename );
+      for( const auto & [isbn, quantity] : expected ) file << std::quoted( isbn ) << '\t' << quantity << '\n';
+    }
+    affirm.is_true ( "Inventory journal - opening inventory",          InventoryJournal::recover( filename ) == expected );
+
+    {
+      // Committed changes are recovered, in order
+      InventoryJournal journal( filename );
+      for( const auto & change : { InventoryJournal::Change{ Kind::SALE,    "0001", 3 },
+                                   InventoryJournal::Change{ Kind::SALE,    "0002", 5 },    // stops at zero
+                                   InventoryJournal::Change{ Kind::RESTOCK, "0003", 20 },
+                                   InventoryJournal::Change{ Kind::RESTOCK, "0009", 20 },   // not stocked
+                                   InventoryJournal::Change{ Kind::DELIST,  "0001", 0 },
+                                   InventoryJournal::Change{ Kind::STOCK,   "0004", 2 } } )
+      {
+        journal.record( change );
+        InventoryJournal::apply( expected, change );
+      }
+      journal.commit();
+      affirm.is_true ( "Inventory journal - changes applied",          expected == InventoryJournal::Inventory{ { "0002", 0 }, { "0003", 27 }, { "0004", 2 } } );
+      affirm.is_true ( "Inventory journal - committed changes recovered", InventoryJournal::recover( filename ) == expected );
+    }
+
+    {
+      // A change cut short by a crash is ignored, as is anything after it in its segment, but later segments aren't
+      {
+        std::ofstream segment( filename + ".journal.1", std::ios::binary | std::ios::app );
+        segment.write( "S\x04\x00\x00\x00" "00", 7 );
+      }
+      affirm.is_true ( "Inventory journal - torn change ignored",      InventoryJournal::recover( filename ) == expected );
+
+      InventoryJournal journal( filename );
+      journal.record( { Kind::SALE, "0003", 1 } );
+      InventoryJournal::apply( expected, { Kind::SALE, "0003", 1 } );
+      journal.commit();
+      affirm.is_true ( "Inventory journal - new segment after torn one", InventoryJournal::recover( filename ) == expected );
+    }
+
+    {
+      // Many registers recording and committing at once lose nothing
+      InventoryJournal         journal( filename );
+      std::vector<std::thread> registers;
+      for( std::size_t t = 0; t < 8; ++t ) registers.emplace_back( [&]
+      {
+        for( std::size_t i = 0; i < 100; ++i )
+        {
+          journal.record( { Kind::RESTOCK, "0004", 1 } );
+          journal.commit();
+        }
+      } );
+      for( auto & thread : registers ) thread.join();
+      expected["0004"] += 800;
+      affirm.is_true ( "Inventory journal - concurrent changes recovered", InventoryJournal::recover( filename ) == expected );
+
+      // and committing the same changes at once share one sync
+      for( std::size_t i = 0; i < 100; ++i ) journal.record( { Kind::RESTOCK, "0004", 1 } );
+      expected["0004"] += 100;
+
+      const auto syncs = journal.syncs();
+      registers.clear();
+      for( std::size_t t = 0; t < 8; ++t ) registers.emplace_back( [&] { journal.commit(); } );
+      for( auto & thread : registers ) thread.join();
+
+      affirm.is_true ( "Inventory journal - group commit",             journal.syncs() == syncs + 1 );
+      affirm.is_true ( "Inventory journal - group committed changes recovered", InventoryJournal::recover( filename ) == expected );
+    }
+
+    {
+      // A batch written whole but not synced is cut back out of the segment given up, so written again to the next it's replayed once
+      std::size_t      syncs = 0;
+      InventoryJournal journal( filename, [&]( std::FILE * file ) { return std::fflush( file ) == 0 && ++syncs != 2; } );
+      journal.record( { Kind::SALE, "0003", 2 } );
+      InventoryJournal::apply( expected, { Kind::SALE, "0003", 2 } );
+
+      bool failed = false;
+      try                                      { journal.commit(); }
+      catch( const InventoryJournal::Io_Ex & ) { failed = true;    }
+      journal.commit();
+      affirm.is_true ( "Inventory journal - unsynced batch replayed once", failed && InventoryJournal::recover( filename ) == expected );
+    }
+
+    {
+      // A snapshot replaces the segments it covers, and later changes are replayed on top of it
+      InventoryJournal journal( filename );
+      journal.record( { Kind::STOCK, "0005", 5 } );
+      InventoryJournal::apply( expected, { Kind::STOCK, "0005", 5 } );
+      journal.compact( expected ).get();
+
+      affirm.is_true ( "Inventory journal - snapshot written",         std::filesystem::exists( filename + ".snapshot" ) );
+      affirm.is_true ( "Inventory journal - covered segments removed", !std::filesystem::exists( filename + ".journal.1" ) && !std::filesystem::exists( filename + ".journal.4" ) );
+
+      journal.record( { Kind::SALE, "0005", 2 } );
+      InventoryJournal::apply( expected, { Kind::SALE, "0005", 2 } );
+      journal.commit();
+      affirm.is_true ( "Inventory journal - recovered from snapshot",  InventoryJournal::recover( filename ) == expected );
+    }
+
+    {
+      InventoryJournal journal( filename );
+      journal.record( { Kind::DELIST, "0002", 0 } );
+      InventoryJournal::apply( expected, { Kind::DELIST, "0002", 0 } );
+      journal.commit();
+      affirm.is_true ( "Inventory journal - reopened after snapshot",  InventoryJournal::recover( filename ) == expected );
+    }
+
+    {
+      std::fstream snapshot( filename + ".snapshot", std::ios::binary | std::ios::in | std::ios::out );
+      snapshot.seekp( 20 );
+      snapshot.put( '\x7F' );
+    }
+    bool corrupt = false;
+    try                                                 { InventoryJournal::recover( filename ); }
+    catch( const InventoryJournal::Corrupt_Ex & )       { corrupt = true;                         }
+    affirm.is_true ( "Inventory journal - damaged snapshot detected",  corrupt );
+
+    removeJournal( filename );
+  }
+
+
+
+  InventoryJournalRegressionTest::InventoryJournalRegressionTest()
+  {
+    std::clog << std::boolalpha << std::showpoint << std::fixed << std::setprecision( 2 );
+
+
+    try
+    {
+      std::clog << "\nInventory Journal Regression Test:\n";
+      tests();
+
+      std::clog << affirm << '\n';
+    }
+    catch( const std::exception & ex )
+    {
+      std::clog << "FAILURE:  Regression test for \"class InventoryJournal\" failed with an unhandled exception. \n\n\n"
+                << ex.what() << std::endl;
+    }
+  }
+} // namespace
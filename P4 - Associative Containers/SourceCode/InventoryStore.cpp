@@ -0,0 +1,246 @@
+#include <algorithm>     // lower_bound()
+#include <cstddef>       // size_t
+#include <cstdint>       // uint64_t
+#include <limits>        // numeric_limits
+#include <map>
+#include <stdexcept>     // overflow_error
+#include <string>
+#include <string_view>
+#include <utility>       // exchange()
+#include <vector>
+
+#include "InventoryStore.hpp"
+
+
+
+InventoryStore::InventoryStore( const std::map<std::string, unsigned int> & inventory, unsigned int threshold )
+  : _quantities    ( new std::atomic<std::uint64_t>[inventory.size()] ),
+    _discontinued  ( new std::atomic<bool>[inventory.size()] ),
+    _threshold     ( threshold ),
+    _listed        ( new std::atomic<bool>[inventory.size()] ),
+    _belowThreshold( new std::atomic<std::size_t>[inventory.size()] )
+{
+  // The map is already sorted, which is the order the ISBNs are searched in
+  _isbns.reserve( inventory.size() );
+  for( auto & [isbn, quantity] : inventory )
+  {
+    _quantities    [_isbns.size()].store( pack( quantity, 0 ), std::memory_order_relaxed );
+    _discontinued  [_isbns.size()].store( false,               std::memory_order_relaxed );
+    _listed        [_isbns.size()].store( false,               std::memory_order_relaxed );
+    _belowThreshold[_isbns.size()].store( 0,                   std::memory_order_relaxed );
+    _isbns.push_back( isbn );
+  }
+}
+
+
+
+std::size_t InventoryStore::find( std::string_view isbn ) const
+{
+  auto it = std::lower_bound( _isbns.begin(), _isbns.end(), isbn, []( const std::string & stocked, std::string_view sought ) { return stocked < sought; } );
+  if( it == _isbns.end() || *it != isbn ) return npos;
+
+  auto slot = static_cast<std::size_t>( it - _isbns.begin() );
+  return _discontinued[slot].load() ? npos : slot;
+}
+
+
+
+const std::string & InventoryStore::isbn( std::size_t slot ) const
+{
+  return _isbns.at( slot );
+}
+
+
+
+unsigned int InventoryStore::available( std::size_t slot ) const
+{
+  return availableOf( _quantities[slot].load() );
+}
+
+
+
+unsigned int InventoryStore::reserved( std::size_t slot ) const
+{
+  return reservedOf( _quantities[slot].load() );
+}
+
+
+
+bool InventoryStore::discontinued( std::size_t slot ) const
+{
+  return _discontinued[slot].load();
+}
+
+
+
+std::size_t InventoryStore::size() const
+{
+  return _isbns.size();
+}
+
+
+
+InventoryStore::Reservation InventoryStore::reserve( std::size_t slot, unsigned int count )
+{
+  auto & quantity = _quantities[slot];
+
+  // Move count books from available to reserved, unless there aren't that many.  A failed compare and swap reloads the quantity.
+  auto current = quantity.load();
+  do
+  {
+    if( availableOf( current ) < count )
+    {
+      noteSale( slot, availableOf( current ) + std::uint64_t{ reservedOf( current ) } );          // a sale turned away still counts
+      return {};
+    }
+  } while( !quantity.compare_exchange_weak( current, pack( availableOf( current ) - count, reservedOf( current ) + std::uint64_t{ count } ) ) );
+
+  return { *this, slot, count };
+}
+
+
+
+bool InventoryStore::sell( std::size_t slot, unsigned int count )
+{
+  auto & quantity = _quantities[slot];
+
+  auto current = quantity.load();
+  do
+  {
+    if( availableOf( current ) < count )
+    {
+      noteSale( slot, availableOf( current ) + std::uint64_t{ reservedOf( current ) } );
+      return false;
+    }
+  } while( !quantity.compare_exchange_weak( current, current - pack( count, 0 ) ) );
+
+  noteSale( slot, availableOf( current ) - std::uint64_t{ count } + reservedOf( current ) );
+  return true;
+}
+
+
+
+void InventoryStore::restock( std::size_t slot, unsigned int count )
+{
+  auto & quantity = _quantities[slot];
+
+  auto current = quantity.load();
+  do
+  {
+    if( availableOf( current ) > std::numeric_limits<unsigned int>::max() - count ) throw std::overflow_error( "InventoryStore::restock:  quantity of " + _isbns[slot] + " out of range" );
+  } while( !quantity.compare_exchange_weak( current, current + pack( count, 0 ) ) );
+}
+
+
+
+void InventoryStore::set( std::size_t slot, unsigned int quantity )
+{
+  auto & current = _quantities[slot];
+
+  auto expected = current.load();
+  while( !current.compare_exchange_weak( expected, pack( quantity, reservedOf( expected ) ) ) ) {}
+  _discontinued[slot].store( false );
+}
+
+
+
+void InventoryStore::discontinue( std::size_t slot )
+{
+  _discontinued[slot].store( true );
+}
+
+
+
+std::size_t InventoryStore::takeBelowThreshold( std::vector<std::size_t> & slots )
+{
+  // Entries are taken in ticket order, stopping at one claimed but not yet written, which the next take picks up.  Each is emptied
+  // before its book is unlisted, so by the time a sale can list the book again and a later ticket comes round to this entry, it's
+  // free.
+  std::size_t count = 0;
+  for( ; _taken != _tickets.load(); ++_taken, ++count )
+  {
+    auto & entry = _belowThreshold[_taken % _isbns.size()];
+    auto   slot  = entry.load();
+    if( slot == 0 ) break;
+
+    entry.store( 0 );
+    _listed[slot - 1].store( false );
+    slots.push_back( slot - 1 );
+  }
+  return count;
+}
+
+
+
+void InventoryStore::noteSale( std::size_t slot, std::uint64_t onHand )
+{
+  if( onHand >= _threshold || _listed[slot].exchange( true ) ) return;
+
+  _belowThreshold[_tickets.fetch_add( 1 ) % _isbns.size()].store( slot + 1 );
+}
+
+
+
+
+
+
+
+InventoryStore::Reservation::Reservation( InventoryStore & store, std::size_t slot, unsigned int count )
+  : _store( &store ), _slot( slot ), _count( count )
+{}
+
+
+
+InventoryStore::Reservation::Reservation( Reservation && other ) noexcept
+  : _store( std::exchange( other._store, nullptr ) ), _slot( other._slot ), _count( other._count )
+{}
+
+
+
+InventoryStore::Reservation & InventoryStore::Reservation::operator=( Reservation && other ) noexcept
+{
+  if( this != &other )
+  {
+    release();
+    _store = std::exchange( other._store, nullptr );
+    _slot  = other._slot;
+    _count = other._count;
+  }
+  return *this;
+}
+
+
+
+InventoryStore::Reservation::~Reservation()
+{
+  release();
+}
+
+
+
+InventoryStore::Reservation::operator bool() const
+{
+  return _store != nullptr;
+}
+
+
+
+void InventoryStore::Reservation::commit()
+{
+  if( _store == nullptr ) return;
+
+  // Reserved never holds fewer than this reservation's books, so subtracting can't borrow from available
+  auto current = _store->_quantities[_slot].fetch_sub( _count );
+  _store->noteSale( _slot, availableOf( current ) + std::uint64_t{ reservedOf( current ) } - _count );
+  _store = nullptr;
+}
+
+
+
+void InventoryStore::Reservation::release()
+{
+  if( _store == nullptr ) return;
+
+  _store->_quantities[_slot].fetch_add( pack( _count, 0 ) - _count );
+  _store = nullptr;
+}
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>    // size_t
+#include <cstdint>    // uint64_t
+#include <limits>     // numeric_limits
+#include <map>
+#include <memory>     // unique_ptr
+#include <string>
+#include <string_view>
+#include <vector>
+
+
+
+// Quantities on hand of a fixed set of books, bought and sold by many threads at once without locks and without ever selling a book
+// that isn't there.
+//
+// The ISBNs stocked are fixed when the store is loaded, and kept sorted so a book's slot is found by a binary search of memory nothing
+// ever writes to.  A book discontinued keeps its slot, but find() no longer finds it until its quantity is set again.  Each slot's
+// quantity is a single atomic word holding both the books available and the books reserved, so taking a book is one compare and swap
+// that fails rather than going below zero, and threads selling different books never share a lock.
+//
+// A sale is made in two steps:  reserve() sets books aside so no one else can take them, then the reservation is either committed,
+// completing the sale, or released, putting the books back.  A reservation still pending when destroyed is released, so books set
+// aside for a sale that fails part way are never lost.
+//
+// Given a threshold, the store also notes each book a sale leaves with fewer than that many on hand, as it happens, so whoever
+// re-orders needn't look at every book sold to find the few running low.  A book is listed once, on a lock-free queue, and listed
+// again only if, after it's taken off the queue, another sale finds it still below the threshold.
+class InventoryStore
+{
+  public:
+    static constexpr std::size_t npos = std::numeric_limits<std::size_t>::max();
+
+    // Books set aside for a sale.  Converts to false if the books couldn't be reserved, in which case there's nothing to commit.
+    class Reservation
+    {
+      public:
+        Reservation            () = default;
+        Reservation            ( Reservation && other ) noexcept;
+        Reservation & operator=( Reservation && other ) noexcept;
+       ~Reservation();
+
+        explicit operator bool() const;
+
+        void commit ();                                                         // The books are sold
+        void release();                                                         // The books go back on the shelf
+
+      private:
+        friend class InventoryStore;
+        Reservation( InventoryStore & store, std::size_t slot, unsigned int count );
+
+        InventoryStore * _store = nullptr;                                      // null once committed or released
+        std::size_t      _slot  = npos;
+        unsigned int     _count = 0;
+    };
+
+    // Constructors, assignments
+    InventoryStore() = default;
+    explicit InventoryStore( const std::map<std::string /*ISBN*/, unsigned int /*quantity*/> & inventory, unsigned int threshold = 0 );
+
+    InventoryStore            ( const InventoryStore & ) = delete;
+    InventoryStore & operator=( const InventoryStore & ) = delete;
+
+    // Queries
+    std::size_t         find        ( std::string_view isbn ) const;            // The book's slot, or npos if not stocked
+    const std::string & isbn        ( std::size_t slot )      const;
+    unsigned int        available   ( std::size_t slot )      const;            // On hand and not reserved
+    unsigned int        reserved    ( std::size_t slot )      const;
+    bool                discontinued( std::size_t slot )      const;
+    std::size_t         size        ()                        const;
+
+    // Operations.  Each may be called from many threads at once.
+    Reservation reserve    ( std::size_t slot, unsigned int count = 1 );        // False if fewer than count are available
+    bool        sell       ( std::size_t slot, unsigned int count = 1 );        // Reserves and commits at once, false if fewer than
+                                                                                // count are available, in which case none are sold
+    void        restock    ( std::size_t slot, unsigned int count );            // Throws std::overflow_error if the quantity would
+                                                                                // no longer fit
+    void        set        ( std::size_t slot, unsigned int quantity );         // Sets the books available, leaving those reserved,
+                                                                                // and stocks the book again if discontinued
+    void        discontinue( std::size_t slot );                                // find() no longer finds the book
+
+    // Appends the slots of books sales have left below the threshold since last taken, in the order they fell below it, and returns
+    // how many.  Only one thread may take at a time, though sales may go on meanwhile.
+    std::size_t takeBelowThreshold( std::vector<std::size_t> & slots );
+
+  private:
+    // available in the upper half, reserved in the lower
+    static constexpr std::uint64_t pack       ( std::uint64_t available, std::uint64_t reserved ) { return available << 32 | reserved;                  }
+    static constexpr unsigned int  availableOf( std::uint64_t quantity )                          { return static_cast<unsigned int>( quantity >> 32 ); }
+    static constexpr unsigned int  reservedOf ( std::uint64_t quantity )                          { return static_cast<unsigned int>( quantity );       }
+
+    // Lists the book if a sale left onHand below the threshold and it isn't listed already
+    void noteSale( std::size_t slot, std::uint64_t onHand );
+
+    std::vector<std::string>                      _isbns;                       // sorted
+    std::unique_ptr<std::atomic<std::uint64_t>[]> _quantities;                  // parallels _isbns
+    std::unique_ptr<std::atomic<bool>[]>          _discontinued;                // parallels _isbns
+
+    // Books below the threshold, a ring with room for every book since none is listed twice.  A ticket claims the next entry, which
+    // holds 0 until its slot + 1 is written.
+    unsigned int                                  _threshold = 0;
+    std::unique_ptr<std::atomic<bool>[]>          _listed;                      // parallels _isbns
+    std::unique_ptr<std::atomic<std::size_t>[]>   _belowThreshold;
+    std::atomic<std::size_t>                      _tickets { 0 };
+    std::size_t                                   _taken     = 0;
+};
@@ -0,0 +1,183 @@
+#include <algorithm>  // sort(), adjacent_find()
+#include <atomic>
+#include <cstddef>    // size_t
+#include <exception>
+#include <iomanip>    // setprecision()
+#include <iostream>   // boolalpha(), showpoint(), fixed()
+#include <limits>     // numeric_limits
+#include <map>
+#include <stdexcept>  // overflow_error
+#include <string>     // to_string()
+#include <thread>
+#include <utility>    // move()
+#include <vector>
+
+#include "CheckResults.hpp"
+#include "InventoryStore.hpp"
+
+
+
+
+
+namespace  // anonymous
+{
+  class InventoryStoreRegressionTest
+  {
+    public:
+      InventoryStoreRegressionTest();
+
+    private:
+      void tests();
+
+      Regression::CheckResults affirm;
+  } run_inventoryStore_tests;
+
+
+
+
+  void InventoryStoreRegressionTest::tests()
+  {
+    {
+      InventoryStore stock( { { "0001", 2 }, { "0002", 0 }, { "0003", 5 } } );
+
+      affirm.is_equal( "Inventory store - size",                       3ULL, stock.size() );
+      affirm.is_equal( "Inventory store - stocked book found",         "0003", stock.isbn( stock.find( "0003" ) ) );
+      affirm.is_equal( "Inventory store - book not stocked",           InventoryStore::npos, stock.find( "0004" ) );
+      affirm.is_equal( "Inventory store - quantity loaded",            5U, stock.available( stock.find( "0003" ) ) );
+
+      const auto first = stock.find( "0001" );
+      affirm.is_true ( "Inventory store - sell",                       stock.sell( first ) && stock.sell( first ) );
+      affirm.is_true ( "Inventory store - no sale when sold out",      !stock.sell( first ) && stock.available( first ) == 0 );
+      affirm.is_true ( "Inventory store - nothing reserved when none", !stock.reserve( stock.find( "0002" ) ) );
+
+      const auto third = stock.find( "0003" );
+      affirm.is_true ( "Inventory store - no partial sale",            !stock.sell( third, 6 ) && stock.available( third ) == 5 );
+
+      {
+        auto reservation = stock.reserve( third, 3 );
+        affirm.is_true ( "Inventory store - reserve",                  static_cast<bool>( reservation ) && stock.available( third ) == 2 && stock.reserved( third ) == 3 );
+        affirm.is_true ( "Inventory store - reserved books held back", !stock.reserve( third, 3 ) );
+
+        reservation.release();
+        affirm.is_true ( "Inventory store - release",                  !reservation && stock.available( third ) == 5 && stock.reserved( third ) == 0 );
+      }
+
+      {
+        auto reservation = stock.reserve( third, 4 );
+        reservation.commit();
+        affirm.is_true ( "Inventory store - commit",                   stock.available( third ) == 1 && stock.reserved( third ) == 0 );
+      }
+
+      {
+        auto pending = stock.reserve( third );
+        auto moved   = std::move( pending );
+        affirm.is_true ( "Inventory store - reservation moved",        !pending && static_cast<bool>( moved ) );
+      }
+      affirm.is_true ( "Inventory store - pending reservation released", stock.available( third ) == 1 && stock.reserved( third ) == 0 );
+
+      stock.restock( first, 20 );
+      affirm.is_equal( "Inventory store - restock",                    20U, stock.available( first ) );
+
+      bool overflowed = false;
+      try                                        { stock.restock( first, std::numeric_limits<unsigned int>::max() ); }
+      catch( const std::overflow_error & )       { overflowed = true;                                                 }
+      affirm.is_true ( "Inventory store - restock overflow",           overflowed && stock.available( first ) == 20 );
+
+      stock.set( first, 7 );
+      stock.discontinue( third );
+      affirm.is_true ( "Inventory store - set",                        stock.available( first ) == 7 && stock.reserved( first ) == 0 );
+      affirm.is_true ( "Inventory store - discontinued not found",     stock.find( "0003" ) == InventoryStore::npos && stock.discontinued( third ) );
+
+      stock.set( third, 4 );
+      affirm.is_true ( "Inventory store - stocked again once set",     stock.find( "0003" ) == third && stock.available( third ) == 4 );
+    }
+
+    {
+      // Books are listed as sales leave them below the threshold, once until taken, even if a sale is turned away
+      InventoryStore           stock( { { "0001", 3 }, { "0002", 0 }, { "0003", 9 } }, 2 );
+      std::vector<std::size_t> slots;
+      const auto first = stock.find( "0001" ), second = stock.find( "0002" ), third = stock.find( "0003" );
+
+      stock.sell( first );
+      stock.sell( third );
+      affirm.is_true ( "Inventory store - not yet below threshold",    stock.takeBelowThreshold( slots ) == 0 && slots.empty() );
+
+      stock.sell( first );
+      stock.sell( first );
+      stock.sell( first );                                              // sold out
+      stock.reserve( second );                                          // sold out before the day began
+      stock.reserve( third, 7 ).commit();
+      affirm.is_true ( "Inventory store - listed once, in order",      stock.takeBelowThreshold( slots ) == 3 && slots == std::vector<std::size_t>{ first, second, third } );
+
+      slots.clear();
+      affirm.is_true ( "Inventory store - taken",                      stock.takeBelowThreshold( slots ) == 0 );
+
+      stock.restock( first, 10 );
+      stock.sell( first );
+      stock.sell( third );
+      affirm.is_true ( "Inventory store - listed again once taken",    stock.takeBelowThreshold( slots ) == 1 && slots == std::vector<std::size_t>{ third } );
+    }
+
+    {
+      // Many registers selling the same few books never sell more than were on hand, and sell every one of them
+      constexpr unsigned int BOOKS    = 8;
+      constexpr unsigned int QUANTITY = 10'000;
+
+      std::map<std::string, unsigned int> inventory;
+      for( unsigned int book = 0; book < BOOKS; ++book ) inventory.emplace( std::to_string( book ), QUANTITY );
+      InventoryStore stock( inventory, QUANTITY / 2 );
+
+      std::atomic<unsigned int> sold{ 0 };
+      std::vector<std::thread>  registers;
+      for( unsigned int t = 0; t < 4; ++t ) registers.emplace_back( [&, t]
+      {
+        for( unsigned int i = 0; i < BOOKS * QUANTITY; ++i )
+        {
+          const auto slot = ( i + t ) % BOOKS;
+          if( i % 2 == 0 )
+          {
+            if( stock.sell( slot ) ) ++sold;
+          }
+          else if( auto reservation = stock.reserve( slot ) )
+          {
+            if( i % 3 == 0 ) reservation.release();
+            else           { reservation.commit(); ++sold; }
+          }
+        }
+      } );
+      for( auto & thread : registers ) thread.join();
+
+      bool allGone = true;
+      for( std::size_t slot = 0; slot < BOOKS; ++slot ) allGone = allGone && stock.available( slot ) == 0 && stock.reserved( slot ) == 0;
+
+      affirm.is_equal( "Inventory store - concurrent sales",           BOOKS * QUANTITY, sold.load() );
+      affirm.is_true ( "Inventory store - concurrent sales sold out",  allGone );
+
+      std::vector<std::size_t> slots;
+      stock.takeBelowThreshold( slots );
+      std::sort( slots.begin(), slots.end() );
+      affirm.is_true ( "Inventory store - concurrent sales listed once", slots.size() == BOOKS && std::adjacent_find( slots.begin(), slots.end() ) == slots.end() );
+    }
+  }
+
+
+
+  InventoryStoreRegressionTest::InventoryStoreRegressionTest()
+  {
+    std::clog << std::boolalpha << std::showpoint << std::fixed << std::setprecision( 2 );
+
+
+    try
+    {
+      std::clog << "\nInventory Store Regression Test:\n";
+      tests();
+
+      std::clog << affirm << '\n';
+    }
+    catch( const std::exception & ex )
+    {
+      std::clog << "FAILURE:  Regression test for \"class InventoryStore\" failed with an unhandled exception. \n\n\n"
+                << ex.what() << std::endl;
+    }
+  }
+} // namespace
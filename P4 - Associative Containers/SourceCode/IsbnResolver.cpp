@@ -0,0 +1,355 @@
+#include <algorithm>     // all_of(), find(), min(), shuffle(), sort(), swap()
+#include <array>
+#include <cctype>        // isdigit()
+#include <cstddef>       // size_t
+#include <cstdint>       // uint8_t, uint16_t, uint32_t
+#include <limits>        // numeric_limits
+#include <optional>
+#include <random>        // mt19937
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "IsbnResolver.hpp"
+
+
+
+namespace  // anonymous
+{
+  constexpr std::uint32_t NONE = std::numeric_limits<std::uint32_t>::max();
+
+  bool isDigit( char c ) { return std::isdigit( static_cast<unsigned char>( c ) ) != 0; }
+
+  // Whether the characters could make up an ISBN, whatever the check digit
+  bool hasIsbnShape( std::string_view isbn )
+  {
+    if( isbn.size() == 10 ) return std::all_of( isbn.begin(), isbn.end() - 1, isDigit ) && ( isDigit( isbn.back() ) || isbn.back() == 'X' );
+    if( isbn.size() == 13 ) return std::all_of( isbn.begin(), isbn.end(),     isDigit );
+    return false;
+  }
+
+  // The check digit that completes the first 9 digits of an ISBN-10, 'X' standing for 10.  Weights run from 10 down to 1 and the
+  // weighted sum must be a multiple of 11.
+  char isbn10CheckDigit( std::string_view digits )
+  {
+    unsigned sum = 0;
+    for( std::size_t i = 0; i < 9; ++i ) sum += static_cast<unsigned>( 10 - i ) * static_cast<unsigned>( digits[i] - '0' );
+
+    const auto check = ( 11 - sum % 11 ) % 11;
+    return check == 10 ? 'X' : static_cast<char>( '0' + check );
+  }
+
+  // The check digit that completes the first 12 digits of an ISBN-13.  Weights alternate 1, 3, 1, ... and the weighted sum must be a
+  // multiple of 10.
+  char isbn13CheckDigit( std::string_view digits )
+  {
+    unsigned sum = 0;
+    for( std::size_t i = 0; i < 12; ++i ) sum += ( i % 2 == 0 ? 1U : 3U ) * static_cast<unsigned>( digits[i] - '0' );
+
+    return static_cast<char>( '0' + ( 10 - sum % 10 ) % 10 );
+  }
+
+
+
+  // The edit distance from one pattern of up to 64 characters to many texts, by Myers' bit-parallel algorithm as formulated by
+  // Hyyro.  A whole column of the dynamic programming table is held as bit vectors of the differences between neighboring cells,
+  // and each character of the text advances the column in a dozen word operations rather than a pass over the pattern.
+  class PatternDistance
+  {
+    public:
+      static constexpr std::size_t MAX_LENGTH = 64;
+
+      explicit PatternDistance( std::string_view pattern )
+        : _length( static_cast<unsigned>( pattern.size() ) )
+      {
+        for( std::size_t i = 0; i < pattern.size(); ++i ) _matches[static_cast<unsigned char>( pattern[i] )] |= std::uint64_t{ 1 } << i;
+      }
+
+      unsigned to( std::string_view text ) const
+      {
+        if( _length == 0 ) return static_cast<unsigned>( text.size() );
+
+        const std::uint64_t lastRow  = std::uint64_t{ 1 } << ( _length - 1 );
+        std::uint64_t       positive = ~std::uint64_t{ 0 };                    // cells one more than the cell above
+        std::uint64_t       negative = 0;                                       // cells one less than the cell above
+        unsigned            score    = _length;                                 // the bottom cell of the column
+
+        for( unsigned char c : text )
+        {
+          const auto matches              = _matches[c];
+          const auto verticalZero         = matches | negative;
+          const auto horizontalZero       = ( ( ( matches & positive ) + positive ) ^ positive ) | matches;
+          auto       horizontalPositive   = negative | ~( horizontalZero | positive );
+          auto       horizontalNegative   = positive & horizontalZero;
+
+          if     ( horizontalPositive & lastRow ) ++score;
+          else if( horizontalNegative & lastRow ) --score;
+
+          horizontalPositive = ( horizontalPositive << 1 ) | 1;
+          horizontalNegative =   horizontalNegative << 1;
+          positive           = horizontalNegative | ~( verticalZero | horizontalPositive );
+          negative           = horizontalPositive & verticalZero;
+        }
+
+        return score;
+      }
+
+    private:
+      std::array<std::uint64_t, 256> _matches = {};                             // bit i set where the pattern's i-th character is c
+      unsigned                       _length;
+  };
+}
+
+
+
+IsbnResolver::IsbnResolver( const std::vector<std::string> & isbns )
+{
+  // Inserting in ISBN order would grow long chains of near neighbors, so insert in a fixed but scrambled order
+  std::vector<Id> order;
+  order.reserve( isbns.size() );
+  for( std::size_t id = 0; id < isbns.size(); ++id )
+  {
+    if( !isbns[id].empty() && isbns[id].size() <= std::numeric_limits<std::uint8_t>::max() ) order.push_back( static_cast<Id>( id ) );
+  }
+
+  std::mt19937 generator( 131 );
+  std::shuffle( order.begin(), order.end(), generator );
+
+  // Grow the tree with each node's children in a linked list.  Each child's distance from its parent differs from its siblings'.
+  struct Draft
+  {
+    Id            id;
+    std::uint32_t firstChild  = NONE;
+    std::uint32_t nextSibling = NONE;
+    std::uint8_t  distance    = 0;
+  };
+
+  std::vector<Draft> drafts;
+  drafts.reserve( order.size() );
+  for( auto id : order )
+  {
+    if( drafts.empty() ) { drafts.push_back( { id } ); continue; }
+
+    for( std::uint32_t at = 0; ; )
+    {
+      const auto distanceToNode = distance( isbns[id], isbns[drafts[at].id] );
+      if( distanceToNode == 0 ) break;                          // already present
+
+      auto child = drafts[at].firstChild;
+      while( child != NONE && drafts[child].distance != distanceToNode ) child = drafts[child].nextSibling;
+
+      if( child == NONE )
+      {
+        drafts.push_back( { id, NONE, drafts[at].firstChild, static_cast<std::uint8_t>( distanceToNode ) } );
+        drafts[at].firstChild = static_cast<std::uint32_t>( drafts.size() - 1 );
+        break;
+      }
+
+      at = child;
+    }
+  }
+
+  // Lay the tree out again breadth first, each node's children adjacent and ordered by distance, and its ISBN stored alongside
+  std::vector<std::uint32_t> children;
+  std::vector<std::uint32_t> breadthFirst;
+  breadthFirst.reserve( drafts.size() );
+  if( !drafts.empty() ) breadthFirst.push_back( 0 );
+
+  _nodes.reserve( drafts.size() );
+  for( std::size_t next = 0; next < breadthFirst.size(); ++next )
+  {
+    const auto & draft = drafts[breadthFirst[next]];
+
+    children.clear();
+    for( auto child = draft.firstChild; child != NONE; child = drafts[child].nextSibling ) children.push_back( child );
+    std::sort( children.begin(), children.end(), [&]( std::uint32_t lhs, std::uint32_t rhs ) { return drafts[lhs].distance < drafts[rhs].distance; } );
+
+    Node node;
+    node.isbnOffset = static_cast<std::uint32_t>( _isbns.size() );
+    node.id         = draft.id;
+    node.firstChild = static_cast<std::uint32_t>( breadthFirst.size() );
+    node.childCount = static_cast<std::uint16_t>( children.size() );
+    node.isbnLength = static_cast<std::uint8_t >( isbns[draft.id].size() );
+    node.distance   = draft.distance;
+
+    _nodes.push_back( node );
+    _isbns += isbns[draft.id];
+    breadthFirst.insert( breadthFirst.end(), children.begin(), children.end() );
+  }
+}
+
+
+
+IsbnResolver::Nearest IsbnResolver::nearest( std::string_view isbn, unsigned maxDistance, std::size_t budget ) const
+{
+  Nearest result;
+  result.distance = maxDistance + 1;
+
+  // Queries too long for the bit-parallel algorithm, which are hardly ISBNs anyway, fall back to the textbook one
+  const bool            bitParallel = isbn.size() <= PatternDistance::MAX_LENGTH;
+  const PatternDistance pattern( bitParallel ? isbn : std::string_view() );
+  auto distanceTo = [&]( std::string_view text ) { return bitParallel ? pattern.to( text ) : distance( isbn, text ); };
+
+  std::vector<std::uint32_t> pending;
+  if( !_nodes.empty() ) pending.push_back( 0 );
+
+  while( !pending.empty() )
+  {
+    if( budget-- == 0 )
+    {
+      result.complete = false;
+      break;
+    }
+
+    const auto & node           = _nodes[pending.back()];
+    const auto   distanceToNode = distanceTo( this->isbn( node ) );
+    pending.pop_back();
+
+    if     ( distanceToNode <  result.distance ) result.ids.assign( 1, node.id );
+    else if( distanceToNode == result.distance ) result.ids.push_back( node.id );
+    result.distance = std::min( result.distance, distanceToNode );
+
+    // By the triangle inequality, anything within radius of the query is within radius of distanceToNode from this node.  The
+    // radius shrinks as closer ISBNs are found.
+    const auto radius = std::min( result.distance, maxDistance );
+    for( auto child = node.firstChild; child < node.firstChild + node.childCount; ++child )
+    {
+      if     ( _nodes[child].distance + radius < distanceToNode ) continue;
+      else if( _nodes[child].distance > distanceToNode + radius ) break;
+      pending.push_back( child );
+    }
+  }
+
+  return result;
+}
+
+
+
+std::size_t IsbnResolver::sizeInBytes() const
+{
+  return _nodes.capacity() * sizeof( Node ) + _isbns.capacity();
+}
+
+
+
+std::string_view IsbnResolver::isbn( const Node & node ) const
+{
+  return { _isbns.data() + node.isbnOffset, node.isbnLength };
+}
+
+
+
+std::string IsbnResolver::normalize( std::string_view isbn )
+{
+  std::string normalized;
+  for( auto c : isbn )
+  {
+    if     ( c == ' ' || c == '-' ) continue;
+    else if( c == 'x'             ) normalized += 'X';
+    else                            normalized += c;
+  }
+
+  return normalized;
+}
+
+
+
+bool IsbnResolver::isValid( std::string_view isbn )
+{
+  if( !hasIsbnShape( isbn ) ) return false;
+
+  return isbn.size() == 10 ? isbn10CheckDigit( isbn ) == isbn.back()
+                           : isbn13CheckDigit( isbn ) == isbn.back();
+}
+
+
+
+std::optional<std::string> IsbnResolver::convert( std::string_view isbn )
+{
+  if( !isValid( isbn ) ) return std::nullopt;
+
+  if( isbn.size() == 10 )
+  {
+    std::string converted = "978" + std::string( isbn.substr( 0, 9 ) );
+    return converted + isbn13CheckDigit( converted );
+  }
+
+  // Only ISBN-13s in the 978 range have an ISBN-10 equivalent
+  if( isbn.substr( 0, 3 ) != "978" ) return std::nullopt;
+
+  std::string converted( isbn.substr( 3, 9 ) );
+  return converted + isbn10CheckDigit( converted );
+}
+
+
+
+std::vector<std::string> IsbnResolver::corrections( std::string_view isbn )
+{
+  std::vector<std::string> candidates;
+  if( !hasIsbnShape( isbn ) ) return candidates;
+
+  auto consider = [&]( const std::string & candidate )
+  {
+    if( isValid( candidate ) && std::find( candidates.begin(), candidates.end(), candidate ) == candidates.end() ) candidates.push_back( candidate );
+  };
+
+  // A check digit rules out all but one replacement for each position, so there are at most as many substitutions as digits
+  std::string candidate( isbn );
+  for( std::size_t i = 0; i < candidate.size(); ++i )
+  {
+    const auto original = candidate[i];
+    for( auto c : std::string_view( "0123456789X" ) )
+    {
+      if( c == original || ( c == 'X' && ( candidate.size() != 10 || i != 9 ) ) ) continue;
+
+      candidate[i] = c;
+      consider( candidate );
+    }
+    candidate[i] = original;
+  }
+
+  for( std::size_t i = 0; i + 1 < candidate.size(); ++i )
+  {
+    if( candidate[i] == candidate[i + 1] ) continue;
+
+    std::swap( candidate[i], candidate[i + 1] );
+    consider( candidate );
+    std::swap( candidate[i], candidate[i + 1] );
+  }
+
+  return candidates;
+}
+
+
+
+unsigned IsbnResolver::distance( std::string_view lhs, std::string_view rhs )
+{
+  // One row of the dynamic programming table suffices.  ISBNs are short, so the row usually fits on the stack.
+  if( lhs.size() < rhs.size() ) std::swap( lhs, rhs );
+
+  std::array<unsigned, 32> shortRow;
+  std::vector<unsigned>    longRow;
+  unsigned *               row = shortRow.data();
+  if( rhs.size() >= shortRow.size() )
+  {
+    longRow.resize( rhs.size() + 1 );
+    row = longRow.data();
+  }
+
+  for( std::size_t j = 0; j <= rhs.size(); ++j ) row[j] = static_cast<unsigned>( j );
+
+  for( std::size_t i = 1; i <= lhs.size(); ++i )
+  {
+    auto diagonal = row[0];
+    row[0] = static_cast<unsigned>( i );
+
+    for( std::size_t j = 1; j <= rhs.size(); ++j )
+    {
+      const auto above = row[j];
+      row[j]   = std::min( { above + 1, row[j - 1] + 1, diagonal + ( lhs[i - 1] == rhs[j - 1] ? 0U : 1U ) } );
+      diagonal = above;
+    }
+  }
+
+  return row[rhs.size()];
+}
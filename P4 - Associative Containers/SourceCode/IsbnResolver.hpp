@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstddef>    // size_t
+#include <cstdint>    // uint8_t, uint16_t, uint32_t
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+
+
+// Finds the ISBNs most likely meant by one that was mistyped.  Two kinds of help are offered:
+//
+//  o  Check digit arithmetic.  ISBN-10 and ISBN-13 check digits catch every single digit substitution and (almost) every swap of
+//     adjacent digits, and also say what the mistyped digit must have been.  corrections() lists the handful of valid ISBNs one
+//     such mistake away, and convert() rewrites an ISBN-10 as an ISBN-13 and back, so each can be looked up directly.
+//  o  A BK-tree over a fixed set of ISBNs, for mistakes check digits can't explain such as a dropped or doubled digit, or ISBNs
+//     that never had a valid check digit.  A BK-tree arranges strings so that the triangle inequality of edit distance rules out
+//     whole subtrees, and a search visits a small fraction of the strings.  Each search is given a budget of string comparisons
+//     so its worst case latency is bounded no matter how the tree is shaped.
+class IsbnResolver
+{
+  public:
+    using Id = std::uint32_t;
+
+    struct Nearest                                                              // the result of a search
+    {
+      std::vector<Id> ids;                                                      // ids at the smallest distance found
+      unsigned        distance = 0;                                             // that distance, meaningless if ids is empty
+      bool            complete = true;                                          // false if the budget ran out before the search
+    };                                                                          // finished, in which case closer ids may exist
+
+    static constexpr std::size_t DEFAULT_COMPARISON_BUDGET = 16'384;            // about twice what searching 100,000 ISBNs needs
+
+    // Constructors
+    IsbnResolver( const std::vector<std::string> & isbns );                     // isbns[id] is the ISBN with that id, empty if none
+
+    // Queries
+    Nearest     nearest    ( std::string_view isbn, unsigned maxDistance = 1, std::size_t budget = DEFAULT_COMPARISON_BUDGET ) const;
+    std::size_t sizeInBytes()                                                                                                     const;
+
+    static std::string              normalize  ( std::string_view isbn );       // drops spaces and hyphens, upper cases X
+    static bool                     isValid    ( std::string_view isbn );       // a 10 or 13 digit ISBN with a correct check digit
+    static std::optional<std::string> convert  ( std::string_view isbn );       // ISBN-10 to ISBN-13 (prefix 978) and back, the
+                                                                                // check digit recomputed
+    static std::vector<std::string> corrections( std::string_view isbn );       // valid ISBNs one substituted digit or one swap of
+                                                                                // adjacent digits away
+    static unsigned                 distance   ( std::string_view lhs, std::string_view rhs );  // Levenshtein edit distance
+
+  private:
+    struct Node
+    {
+      std::uint32_t isbnOffset;                                                 // the ISBN is _isbns[isbnOffset, +isbnLength)
+      Id            id;
+      std::uint32_t firstChild;                                                 // children are _nodes[firstChild, +childCount),
+      std::uint16_t childCount;                                                 // ordered by distance
+      std::uint8_t  isbnLength;
+      std::uint8_t  distance;                                                   // from the parent
+    };
+
+    std::string_view isbn( const Node & node ) const;
+
+    std::vector<Node> _nodes;                                                   // breadth first, _nodes[0] is the root
+    std::string       _isbns;                                                   // in the same order as _nodes
+};
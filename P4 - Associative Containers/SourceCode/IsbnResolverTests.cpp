@@ -0,0 +1,114 @@
+#include <algorithm>  // all_of(), find(), sort()
+#include <cstddef>    // size_t
+#include <exception>
+#include <iomanip>    // setprecision()
+#include <iostream>   // boolalpha(), showpoint(), fixed()
+#include <optional>
+#include <string>     // to_string()
+#include <vector>
+
+#include "CheckResults.hpp"
+#include "IsbnResolver.hpp"
+
+
+
+
+
+namespace  // anonymous
+{
+  class IsbnResolverRegressionTest
+  {
+    public:
+      IsbnResolverRegressionTest();
+
+    private:
+      void tests();
+
+      Regression::CheckResults affirm;
+  } run_isbnResolver_tests;
+
+
+
+
+  void IsbnResolverRegressionTest::tests()
+  {
+    using Ids     = std::vector<IsbnResolver::Id>;
+    using Strings = std::vector<std::string>;
+
+    const auto contains = []( const Strings & strings, const std::string & string ) { return std::find( strings.begin(), strings.end(), string ) != strings.end(); };
+
+    {
+      affirm.is_equal( "ISBN resolver - normalized",                   std::string( "080442957X" ), IsbnResolver::normalize( "0-8044 2957-x" ) );
+      affirm.is_true ( "ISBN resolver - valid ISBN-10",                IsbnResolver::isValid( "0306406152" ) && IsbnResolver::isValid( "080442957X" ) );
+      affirm.is_true ( "ISBN resolver - valid ISBN-13",                IsbnResolver::isValid( "9780306406157" ) );
+      affirm.is_true ( "ISBN resolver - invalid check digits",         !IsbnResolver::isValid( "0306406153" ) && !IsbnResolver::isValid( "9780306406158" ) && !IsbnResolver::isValid( "03064061" ) );
+      affirm.is_true ( "ISBN resolver - ISBN-10 to ISBN-13",           IsbnResolver::convert( "0306406152"    ) == std::optional<std::string>( "9780306406157" ) );
+      affirm.is_true ( "ISBN resolver - ISBN-13 to ISBN-10",           IsbnResolver::convert( "9780306406157" ) == std::optional<std::string>( "0306406152"    ) );
+      affirm.is_true ( "ISBN resolver - no ISBN-10 outside 978",       !IsbnResolver::convert( "9790306406156" ) && !IsbnResolver::convert( "0306406153" ) );
+
+      const auto substituted = IsbnResolver::corrections( "0306486152" );
+      const auto swapped     = IsbnResolver::corrections( "0306401652" );
+      affirm.is_true ( "ISBN resolver - substitution corrected",       contains( substituted, "0306406152" ) );
+      affirm.is_true ( "ISBN resolver - transposition corrected",      contains( swapped,     "0306406152" ) );
+      affirm.is_true ( "ISBN resolver - corrections all valid",        std::all_of( substituted.begin(), substituted.end(), IsbnResolver::isValid ) );
+      affirm.is_true ( "ISBN resolver - ISBN-13 substitution",         contains( IsbnResolver::corrections( "9780306409157" ), "9780306406157" ) );
+
+      affirm.is_equal( "ISBN resolver - edit distance",                3U, IsbnResolver::distance( "kitten", "sitting" ) );
+      affirm.is_equal( "ISBN resolver - edit distance to nothing",     4U, IsbnResolver::distance( "", "1234" ) );
+    }
+
+    {
+      // Enough ISBNs for a deep tree, searched for near misses and compared against measuring the distance to every ISBN
+      constexpr std::size_t ISBN_COUNT = 5'000;
+
+      Strings isbns;
+      for( std::size_t id = 0; id < ISBN_COUNT; ++id ) isbns.push_back( std::to_string( 1'000'000'007ULL + id * 7'919ULL * 104'729ULL % 8'999'999'999ULL ) );
+      isbns[17].clear();                                                        // no book with this id
+
+      const IsbnResolver resolver( isbns );
+
+      for( const std::string & query : { isbns[42].substr( 1 ), isbns[4'242] + '7', "0" + isbns[99].substr( 1 ), isbns[18], std::string( "123" ) } )
+      {
+        unsigned best = 2;
+        Ids      expected;
+        for( IsbnResolver::Id id = 0; id < ISBN_COUNT; ++id )
+        {
+          if( isbns[id].empty() ) continue;
+
+          const auto distance = IsbnResolver::distance( query, isbns[id] );
+          if( distance < best ) { best = distance; expected.clear(); }
+          if( distance == best ) expected.push_back( id );
+        }
+
+        auto nearest = resolver.nearest( query, 1, ISBN_COUNT );
+        std::sort( nearest.ids.begin(), nearest.ids.end() );
+        affirm.is_true( "ISBN resolver - nearest to \"" + query + "\" matches brute force", nearest.complete && nearest.ids == expected
+                                                                                            && ( expected.empty() || nearest.distance == best ) );
+      }
+
+      affirm.is_true( "ISBN resolver - budget respected", !resolver.nearest( isbns[0].substr( 1 ), 1, 3 ).complete );
+      affirm.is_true( "ISBN resolver - size reported",    resolver.sizeInBytes() > 0 );
+    }
+  }
+
+
+
+  IsbnResolverRegressionTest::IsbnResolverRegressionTest()
+  {
+    std::clog << std::boolalpha << std::showpoint << std::fixed << std::setprecision( 2 );
+
+
+    try
+    {
+      std::clog << "\nISBN Resolver Regression Test:\n";
+      tests();
+
+      std::clog << affirm << '\n';
+    }
+    catch( const std::exception & ex )
+    {
+      std::clog << "FAILURE:  Regression test for \"class IsbnResolver\" failed with an unhandled exception. \n\n\n"
+                << ex.what() << std::endl;
+    }
+  }
+} // namespace
@@ -0,0 +1,96 @@
+#include <algorithm>     // max(), min()
+#include <atomic>
+#include <cstddef>       // size_t
+#include <cstdint>       // uint32_t, uint64_t
+#include <exception>     // exception_ptr, current_exception(), rethrow_exception()
+#include <functional>    // function
+#include <future>        // future
+#include <limits>        // numeric_limits
+#include <stdexcept>     // length_error
+#include <thread>        // hardware_concurrency()
+#include <vector>
+
+#include "ParallelFor.hpp"
+#include "ThreadPool.hpp"
+
+
+
+namespace  // anonymous
+{
+  // A worker's share of the indexes, [begin, end), packed in one word so the owner taking from the front and a thief taking from the
+  // back can each claim indexes with a single compare and swap
+  struct alignas( 64 ) Share
+  {
+    std::atomic<std::uint64_t> range{ 0 };
+  };
+
+  constexpr std::uint64_t pack ( std::uint64_t begin, std::uint64_t end ) { return begin << 32 | end; }
+  constexpr std::uint64_t begin( std::uint64_t range )                    { return range >> 32;       }
+  constexpr std::uint64_t end  ( std::uint64_t range )                    { return range & 0xFFFF'FFFF; }
+}
+
+
+
+void parallelFor( std::size_t count, std::size_t workers, const std::function<void( std::size_t worker, std::size_t index )> & work )
+{
+  if( count > std::numeric_limits<std::uint32_t>::max() ) throw std::length_error( "parallelFor:  too many indexes" );
+
+  if( workers == 0 ) workers = std::max( 1U, std::thread::hardware_concurrency() );
+  workers = std::max<std::size_t>( std::min( workers, count ), 1 );
+
+  std::vector<Share> shares( workers );
+  for( std::size_t worker = 0; worker < workers; ++worker )
+  {
+    shares[worker].range = pack( count * worker / workers, count * ( worker + 1 ) / workers );
+  }
+
+  auto run = [&]( std::size_t worker )
+  {
+    auto & own = shares[worker].range;
+
+    for( ;; )
+    {
+      // Take the next index from the front of this worker's share
+      if( auto range = own.load(); begin( range ) < end( range ) )
+      {
+        if( own.compare_exchange_weak( range, pack( begin( range ) + 1, end( range ) ) ) ) work( worker, begin( range ) );
+        continue;
+      }
+
+      // Out of work, so steal the back half of the largest share left.  Shares only ever shrink except by stealing, so once every
+      // share is empty, every index has been taken.
+      Share *       victim = nullptr;
+      std::uint64_t range  = 0;
+      for( auto & share : shares )
+      {
+        const auto candidate = share.range.load();
+        if( end( candidate ) > begin( candidate ) && ( victim == nullptr || end( candidate ) - begin( candidate ) > end( range ) - begin( range ) ) )
+        {
+          victim = &share;
+          range  = candidate;
+        }
+      }
+      if( victim == nullptr ) return;
+
+      const auto middle = begin( range ) + ( end( range ) - begin( range ) ) / 2;
+      if( victim->range.compare_exchange_strong( range, pack( begin( range ), middle ) ) ) own = pack( middle, end( range ) );
+    }
+  };
+
+  // The helpers use the shares on this stack frame, so every helper must have finished before this returns, even by throwing
+  std::vector<std::future<void>> helpers;
+  std::exception_ptr             failure;
+  try
+  {
+    for( std::size_t worker = 1; worker < workers; ++worker ) helpers.push_back( ThreadPool::shared().submit( [&run, worker] { run( worker ); } ) );
+    run( 0 );
+  }
+  catch( ... ) { failure = std::current_exception(); }
+
+  for( auto & helper : helpers )
+  {
+    try          { helper.get();                                            }  // rethrows anything a helper threw
+    catch( ... ) { if( !failure ) failure = std::current_exception(); }
+  }
+  if( failure ) std::rethrow_exception( failure );
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <cstddef>    // size_t
+#include <functional> // function
+
+
+
+// Calls work( worker, index ) once for every index in [0, count), spread over up to workers threads, the calling thread among them.
+// Returns once every call has returned, rethrowing anything a call threw.  If workers is 0, one thread per core is used.  The other
+// threads are the shared ThreadPool's (see ThreadPool.hpp), so calling over and over starts no new threads.
+//
+// worker identifies the thread making the call, in [0, workers), so results can be gathered per worker without synchronizing.
+//
+// The indexes are balanced by work stealing:  each worker starts with an equal, contiguous share and takes indexes from its front.
+// A worker whose share runs out steals the back half of whichever share has the most left, so workers finishing early help those
+// with slower indexes, while neighbouring indexes mostly stay with one worker.
+void parallelFor( std::size_t count, std::size_t workers, const std::function<void( std::size_t worker, std::size_t index )> & work );
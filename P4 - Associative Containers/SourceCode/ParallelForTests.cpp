@@ -0,0 +1,106 @@
+#include <atomic>
+#include <chrono>     // microseconds
+#include <cstddef>    // size_t
+#include <exception>
+#include <iomanip>    // setprecision()
+#include <iostream>   // boolalpha(), showpoint(), fixed()
+#include <set>
+#include <stdexcept>  // runtime_error
+#include <thread>     // sleep_for()
+#include <vector>
+
+#include "CheckResults.hpp"
+#include "ParallelFor.hpp"
+
+
+
+
+
+namespace  // anonymous
+{
+  class ParallelForRegressionTest
+  {
+    public:
+      ParallelForRegressionTest();
+
+    private:
+      void tests();
+
+      Regression::CheckResults affirm;
+  } run_parallelFor_tests;
+
+
+
+
+  void ParallelForRegressionTest::tests()
+  {
+    {
+      constexpr std::size_t COUNT = 10'000;
+
+      std::vector<std::atomic<unsigned>> calls( COUNT );
+      std::atomic<bool>                  workerInRange{ true };
+      parallelFor( COUNT, 4, [&]( std::size_t worker, std::size_t index ) noexcept
+      {
+        ++calls[index];
+        if( worker >= 4 ) workerInRange = false;
+      } );
+
+      bool onceEach = true;
+      for( auto & count : calls ) onceEach = onceEach && count == 1;
+      affirm.is_true( "Parallel for - every index once",            onceEach );
+      affirm.is_true( "Parallel for - workers numbered in range",   workerInRange.load() );
+    }
+
+    {
+      // The first worker's share is slow, so the others finish theirs early and steal from it
+      constexpr std::size_t COUNT = 400;
+
+      std::vector<std::size_t> ranBy( COUNT );
+      parallelFor( COUNT, 4, [&]( std::size_t worker, std::size_t index )
+      {
+        if( index < COUNT / 4 ) std::this_thread::sleep_for( std::chrono::microseconds( 500 ) );
+        ranBy[index] = worker;
+      } );
+
+      std::set<std::size_t> slowShareWorkers( ranBy.begin(), ranBy.begin() + COUNT / 4 );
+      affirm.is_true( "Parallel for - slow share stolen from",      slowShareWorkers.size() > 1 );
+    }
+
+    {
+      std::size_t calls = 0;
+      parallelFor( 0, 4, [&]( std::size_t, std::size_t ) noexcept { ++calls; } );
+      parallelFor( 3, 0, [&]( std::size_t, std::size_t ) noexcept { } );
+      affirm.is_equal( "Parallel for - nothing to do",               0ULL, calls );
+
+      std::vector<std::size_t> order;
+      parallelFor( 5, 1, [&]( std::size_t, std::size_t index ) { order.push_back( index ); } );
+      affirm.is_true ( "Parallel for - one worker goes in order",    order == std::vector<std::size_t>{ 0, 1, 2, 3, 4 } );
+
+      bool rethrown = false;
+      try { parallelFor( 100, 4, []( std::size_t, std::size_t index ) { if( index == 77 ) throw std::runtime_error( "77" ); } ); }
+      catch( const std::runtime_error & ) { rethrown = true; }
+      affirm.is_true ( "Parallel for - exceptions rethrown",         rethrown );
+    }
+  }
+
+
+
+  ParallelForRegressionTest::ParallelForRegressionTest()
+  {
+    std::clog << std::boolalpha << std::showpoint << std::fixed << std::setprecision( 2 );
+
+
+    try
+    {
+      std::clog << "\nParallel For Regression Test:\n";
+      tests();
+
+      std::clog << affirm << '\n';
+    }
+    catch( const std::exception & ex )
+    {
+      std::clog << "FAILURE:  Regression test for \"parallelFor\" failed with an unhandled exception. \n\n\n"
+                << ex.what() << std::endl;
+    }
+  }
+} // namespace
@@ -0,0 +1,263 @@
+#include <algorithm>     // find(), max(), min(), sort(), stable_sort()
+#include <atomic>
+#include <cmath>         // ceil(), log2()
+#include <cstddef>       // size_t
+#include <cstdint>       // uint16_t, uint32_t, uint64_t
+#include <future>        // async(), future
+#include <limits>        // numeric_limits
+#include <thread>        // hardware_concurrency()
+#include <utility>       // move()
+#include <vector>
+
+#include "PerfectHashIndex.hpp"
+
+
+
+namespace  // anonymous
+{
+  constexpr std::size_t   KEYS_PER_PARTITION = 4'096;                         // small enough that a partition's slots stay cached
+  constexpr double        LOAD_FACTOR        = 0.98;                          // keys per slot probed
+  constexpr double        BUCKET_RATIO       = 5.0;                           // buckets are BUCKET_RATIO * n / log2(n)
+  constexpr std::uint64_t DENSE_THRESHOLD    = 11'068'046'444'225'730'969ULL; // 60% of 2^64.  That fraction of keys are hashed into
+  constexpr std::uint32_t DENSE_PERCENT      = 30;                            // this percentage of buckets, so there are more large
+                                                                              // buckets to place while slots are plentiful
+  // SplitMix64's finalizer, a bijection that scatters every input bit across the output
+  inline std::uint64_t mix( std::uint64_t x )
+  {
+    x ^= x >> 30;  x *= 0xBF58'476D'1CE4'E5B9ULL;
+    x ^= x >> 27;  x *= 0x94D0'49BB'1331'11EBULL;
+    x ^= x >> 31;
+    return x;
+  }
+
+  // Maps x onto [0, range) with a multiply rather than a (much slower) division
+  inline std::uint32_t reduce( std::uint32_t x, std::uint32_t range )
+  {
+    return static_cast<std::uint32_t>( ( std::uint64_t{ x } * range ) >> 32 );
+  }
+
+  inline std::uint32_t bucketOf( std::uint64_t key, std::uint32_t bucketCount )
+  {
+    const std::uint32_t dense = bucketCount * DENSE_PERCENT / 100;
+    const auto          low   = static_cast<std::uint32_t>( key );
+
+    return key < DENSE_THRESHOLD && dense > 0 ? reduce( low, dense ) : dense + reduce( low, bucketCount - dense );
+  }
+
+  inline std::uint32_t positionOf( std::uint64_t key, std::uint16_t pilot, std::uint32_t tableSize )
+  {
+    return reduce( static_cast<std::uint32_t>( mix( key ^ ( ( pilot + 1ULL ) * 0x9E37'79B9'7F4A'7C15ULL ) ) >> 32 ), tableSize );
+  }
+}
+
+
+
+struct PerfectHashIndex::Built
+{
+  std::uint64_t              seed        = 0;
+  std::uint32_t              keyCount    = 0;
+  std::uint32_t              tableSize   = 0;
+  std::uint32_t              bucketCount = 0;
+  std::vector<std::uint16_t> pilots;
+  std::vector<std::uint32_t> remap;
+};
+
+
+
+PerfectHashIndex::PerfectHashIndex( const std::vector<std::size_t> & hashes, unsigned threads )
+  : _size( hashes.size() )
+{
+  if( hashes.empty() ) return;
+
+  // Split the keys into partitions by the high half of their mixed hash
+  const auto partitionCount = static_cast<std::uint32_t>( std::max<std::size_t>( 1, hashes.size() / KEYS_PER_PARTITION ) );
+
+  std::vector<std::vector<std::uint64_t>> keys( partitionCount );
+  for( const auto hash : hashes )
+  {
+    const auto x = mix( hash );
+    keys[reduce( static_cast<std::uint32_t>( x >> 32 ), partitionCount )].push_back( x );
+  }
+
+  // Build the partitions, each worker taking the next partition not yet started until none are left.  Which worker builds which
+  // partition doesn't affect the result.
+  std::vector<Built>         built( partitionCount );
+  std::atomic<std::uint32_t> next{ 0 };
+
+  auto worker = [&]
+  {
+    for( auto partition = next++; partition < partitionCount; partition = next++ )
+    {
+      built[partition] = build( std::move( keys[partition] ), partition );
+    }
+  };
+
+  if( threads == 0 ) threads = std::max( 1U, std::thread::hardware_concurrency() );
+  threads = std::min( threads, partitionCount );
+
+  std::vector<std::future<void>> helpers;
+  for( unsigned i = 1; i < threads; ++i ) helpers.push_back( std::async( std::launch::async, worker ) );
+  worker();
+  for( auto & helper : helpers ) helper.get();                                // rethrows anything a helper threw
+
+  // Lay the partitions out one after the other
+  std::size_t pilotCount = 0, remapCount = 0;
+  for( const auto & partition : built ) { pilotCount += partition.pilots.size();  remapCount += partition.remap.size(); }
+
+  _partitions.reserve( partitionCount );
+  _pilots    .reserve( pilotCount     );
+  _remap     .reserve( remapCount     );
+
+  std::uint32_t firstSlot = 0;
+  for( auto & partition : built )
+  {
+    _partitions.push_back( { partition.seed, firstSlot, partition.keyCount, partition.tableSize,
+                             static_cast<std::uint32_t>( _pilots.size() ), partition.bucketCount,
+                             static_cast<std::uint32_t>( _remap .size() ) } );
+
+    // A partition no key fell into still has to send keys that aren't in the set somewhere.  It claims a single slot, remapped to
+    // slot 0.
+    if( partition.keyCount == 0 ) _partitions.back().firstSlot = 0;
+
+    firstSlot += partition.keyCount;
+    _pilots.insert( _pilots.end(), partition.pilots.begin(), partition.pilots.end() );
+    _remap .insert( _remap .end(), partition.remap .begin(), partition.remap .end() );
+  }
+}
+
+
+
+PerfectHashIndex::Built PerfectHashIndex::build( std::vector<std::uint64_t> keys, std::uint64_t seed )
+{
+  if( keys.empty() ) return { seed, 0, 1, 1, { 0 }, { 0 } };
+
+  const auto keyCount    = static_cast<std::uint32_t>( keys.size() );
+  const auto tableSize   = std::max( keyCount, static_cast<std::uint32_t>( std::ceil( keyCount / LOAD_FACTOR ) ) );
+  const auto bucketCount = keyCount < 2 ? 1U : static_cast<std::uint32_t>( std::ceil( BUCKET_RATIO * keyCount / std::log2( keyCount ) ) );
+
+  // Nearly always the first seed works.  If some bucket can't be placed with any pilot, start over with the keys hashed afresh.
+  for( ;; seed += 0x9E37'79B9'7F4A'7C15ULL )
+  {
+    struct Key
+    {
+      std::uint64_t value;
+      std::uint32_t bucket;
+    };
+
+    std::vector<Key> hashed;
+    hashed.reserve( keys.size() );
+    for( const auto key : keys )
+    {
+      const auto value = mix( key ^ seed );
+      hashed.push_back( { value, bucketOf( value, bucketCount ) } );
+    }
+
+    // Group the keys by bucket, then order the buckets largest first
+    std::sort( hashed.begin(), hashed.end(), []( const Key & lhs, const Key & rhs )
+               { return lhs.bucket != rhs.bucket ? lhs.bucket < rhs.bucket : lhs.value < rhs.value; } );
+
+    struct Bucket
+    {
+      std::uint32_t id, begin, end;
+    };
+
+    std::vector<Bucket> buckets;
+    for( std::uint32_t begin = 0, end; begin < keyCount; begin = end )
+    {
+      for( end = begin + 1; end < keyCount && hashed[end].bucket == hashed[begin].bucket; ++end )
+      {
+        if( hashed[end].value == hashed[end - 1].value ) throw DuplicateKey_Ex( "Perfect hash index:  two keys have the same hash value" );
+      }
+      buckets.push_back( { hashed[begin].bucket, begin, end } );
+    }
+
+    std::stable_sort( buckets.begin(), buckets.end(), []( const Bucket & lhs, const Bucket & rhs ) { return lhs.end - lhs.begin > rhs.end - rhs.begin; } );
+
+    // Give each bucket the first pilot that places all its keys in free slots
+    Built                      result{ seed, keyCount, tableSize, bucketCount, std::vector<std::uint16_t>( bucketCount, 0 ), {} };
+    std::vector<bool>          taken( tableSize, false );
+    std::vector<std::uint32_t> positions;
+    bool                       placed = true;
+
+    for( const auto & bucket : buckets )
+    {
+      std::uint32_t pilot = 0;
+      for( ; pilot <= std::numeric_limits<std::uint16_t>::max(); ++pilot )
+      {
+        positions.clear();
+        for( auto i = bucket.begin; i < bucket.end; ++i )
+        {
+          const auto position = positionOf( hashed[i].value, static_cast<std::uint16_t>( pilot ), tableSize );
+          if( taken[position] || std::find( positions.begin(), positions.end(), position ) != positions.end() ) break;
+          positions.push_back( position );
+        }
+
+        if( positions.size() == bucket.end - bucket.begin ) break;
+      }
+
+      if( pilot > std::numeric_limits<std::uint16_t>::max() )
+      {
+        placed = false;
+        break;
+      }
+
+      result.pilots[bucket.id] = static_cast<std::uint16_t>( pilot );
+      for( const auto position : positions ) taken[position] = true;
+    }
+
+    if( !placed ) continue;
+
+    // Exactly as many slots at or beyond keyCount are taken as are free below it.  Pair them up.  Untaken slots beyond keyCount are
+    // reached only by keys not in the set, and may be remapped anywhere.
+    std::uint32_t free = 0;
+    for( auto position = keyCount; position < tableSize; ++position )
+    {
+      if( !taken[position] ) { result.remap.push_back( 0 ); continue; }
+
+      while( taken[free] ) ++free;
+      result.remap.push_back( free++ );
+    }
+
+    return result;
+  }
+}
+
+
+
+std::size_t PerfectHashIndex::slot( std::size_t hash ) const
+{
+  if( _partitions.empty() ) return 0;
+
+  const auto     x         = mix( hash );
+  const auto &   partition = _partitions[reduce( static_cast<std::uint32_t>( x >> 32 ), static_cast<std::uint32_t>( _partitions.size() ) )];
+  const auto     key       = mix( x ^ partition.seed );
+  const auto     pilot     = _pilots[partition.firstBucket + bucketOf( key, partition.bucketCount )];
+  auto           position  = positionOf( key, pilot, partition.tableSize );
+
+  if( position >= partition.keyCount ) position = _remap[partition.firstRemap + position - partition.keyCount];
+
+  return partition.firstSlot + position;
+}
+
+
+
+std::size_t PerfectHashIndex::size() const
+{
+  return _size;
+}
+
+
+
+bool PerfectHashIndex::empty() const
+{
+  return _size == 0;
+}
+
+
+
+std::size_t PerfectHashIndex::sizeInBytes() const
+{
+  return _partitions.capacity() * sizeof( Partition     )
+       + _pilots    .capacity() * sizeof( std::uint16_t )
+       + _remap     .capacity() * sizeof( std::uint32_t );
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstddef>    // size_t
+#include <cstdint>    // uint16_t, uint32_t, uint64_t
+#include <stdexcept>
+#include <vector>
+
+
+
+// A minimal perfect hash function over a fixed set of keys:  each of the n keys it was built from maps to its own slot in [0, n),
+// with no two keys sharing a slot and no slot left over.  A table laid out by it is found with exactly one probe and no empty slots,
+// and the function itself takes about 8 bits per key.  Keys not in the set also map to some slot, so a table must hold something
+// (a fingerprint, the key itself) to tell whether the key found there is the one looked for.
+//
+// Construction follows PTHash.  Keys are split into partitions of a few thousand, each built independently (and in parallel).
+// Within a partition, keys are hashed into buckets and each bucket is given a 16 bit pilot, the first that, mixed with the bucket's
+// keys, sends every one of them to a slot no other key has taken.  Large buckets are placed first while slots are plentiful.  Slots
+// are 2% more than keys so late buckets still find room, and the few keys that land beyond n are remapped to the slots left free.
+//
+// Keys are identified by their hash value, so callers hash a key once and pass the same value to both construction and lookup.
+class PerfectHashIndex
+{
+  public:
+    struct DuplicateKey_Ex : std::invalid_argument { using invalid_argument::invalid_argument; };  // Thrown if two keys hash alike
+
+    // Constructors
+    PerfectHashIndex() = default;                                               // maps nothing, size() is zero
+    PerfectHashIndex( const std::vector<std::size_t> & hashes, unsigned threads = 0 );  // hashes must be distinct.  Partitions are
+                                                                                        // built on this many threads, or on one per
+                                                                                        // processor if zero
+    // Queries
+    std::size_t slot       ( std::size_t hash ) const;                          // in [0, size()), distinct for every hash built from
+    std::size_t size       ()                   const;                          // number of keys (and so slots)
+    bool        empty      ()                   const;
+    std::size_t sizeInBytes()                   const;
+
+  private:
+    struct Partition
+    {
+      std::uint64_t seed;                                                       // changed only if no pilots could be found
+      std::uint32_t firstSlot;                                                  // the partition's slots are [firstSlot, +keyCount)
+      std::uint32_t keyCount;
+      std::uint32_t tableSize;                                                  // slots probed before remapping, a little over keyCount
+      std::uint32_t firstBucket;                                                // pilots are _pilots[firstBucket, +bucketCount)
+      std::uint32_t bucketCount;
+      std::uint32_t firstRemap;                                                 // slot keyCount + i is remapped to _remap[firstRemap + i]
+    };
+
+    struct Built;                                                               // a partition's pilots and remapping, as it's built
+
+    static Built build( std::vector<std::uint64_t> keys, std::uint64_t seed );
+
+    std::vector<Partition>     _partitions;
+    std::vector<std::uint16_t> _pilots;
+    std::vector<std::uint32_t> _remap;
+    std::size_t                _size = 0;
+};
@@ -0,0 +1,111 @@
+#include <cstddef>    // size_t
+#include <exception>
+#include <functional> // hash
+#include <iomanip>    // setprecision()
+#include <iostream>   // boolalpha(), showpoint(), fixed()
+#include <string>     // to_string()
+#include <vector>
+
+#include "CheckResults.hpp"
+#include "PerfectHashIndex.hpp"
+
+
+
+
+
+namespace  // anonymous
+{
+  class PerfectHashIndexRegressionTest
+  {
+    public:
+      PerfectHashIndexRegressionTest();
+
+    private:
+      void tests();
+
+      Regression::CheckResults affirm;
+  } run_perfectHashIndex_tests;
+
+
+
+
+  void PerfectHashIndexRegressionTest::tests()
+  {
+    // True if every hash maps to its own slot in [0, hashes.size())
+    const auto isBijection = []( const PerfectHashIndex & index, const std::vector<std::size_t> & hashes )
+    {
+      std::vector<bool> taken( hashes.size(), false );
+      for( const auto hash : hashes )
+      {
+        const auto slot = index.slot( hash );
+        if( slot >= hashes.size() || taken[slot] ) return false;
+        taken[slot] = true;
+      }
+      return true;
+    };
+
+    {
+      const PerfectHashIndex nothing;
+      affirm.is_true ( "Perfect hash index - default is empty",     nothing.empty() && nothing.size() == 0 );
+
+      const PerfectHashIndex one( { 42 } );
+      affirm.is_equal( "Perfect hash index - single key",           0ULL, one.slot( 42 ) );
+      affirm.is_equal( "Perfect hash index - unknown key in range", 0ULL, one.slot( 43 ) );
+
+      bool threw = false;
+      try                                                  { PerfectHashIndex( { 1, 2, 1 } ); }
+      catch( const PerfectHashIndex::DuplicateKey_Ex & ) { threw = true;                  }
+      affirm.is_true ( "Perfect hash index - duplicates rejected",  threw );
+    }
+
+    {
+      // Enough keys for many partitions, from the same hash function the database uses
+      std::vector<std::size_t> hashes;
+      for( std::size_t i = 0; i < 50'000; ++i ) hashes.push_back( std::hash<std::string>{}( std::to_string( 1'000'000'007ULL + i * 7'919ULL ) ) );
+
+      const PerfectHashIndex serial  ( hashes, 1 );
+      const PerfectHashIndex parallel( hashes, 4 );
+
+      affirm.is_equal( "Perfect hash index - size",                 hashes.size(), serial.size() );
+      affirm.is_true ( "Perfect hash index - minimal and perfect",  isBijection( serial, hashes ) );
+
+      bool agree = true;
+      for( const auto hash : hashes ) agree = agree && serial.slot( hash ) == parallel.slot( hash );
+      affirm.is_true ( "Perfect hash index - threads agree",        agree );
+
+      bool inRange = true;
+      for( std::size_t i = 0; i < 1'000; ++i ) inRange = inRange && serial.slot( std::hash<std::string>{}( "unknown " + std::to_string( i ) ) ) < hashes.size();
+      affirm.is_true ( "Perfect hash index - unknown keys in range", inRange );
+      affirm.is_true ( "Perfect hash index - under 10 bits per key", serial.sizeInBytes() * 8 < 10 * hashes.size() );
+    }
+
+    for( std::size_t count : { 2, 3, 100, 4'095, 4'097 } )
+    {
+      std::vector<std::size_t> hashes;
+      for( std::size_t i = 0; i < count; ++i ) hashes.push_back( i * 0x9E37'79B9'7F4A'7C15ULL );   // deliberately regular
+
+      affirm.is_true( "Perfect hash index - " + std::to_string( count ) + " keys", isBijection( PerfectHashIndex( hashes ), hashes ) );
+    }
+  }
+
+
+
+  PerfectHashIndexRegressionTest::PerfectHashIndexRegressionTest()
+  {
+    std::clog << std::boolalpha << std::showpoint << std::fixed << std::setprecision( 2 );
+
+
+    try
+    {
+      std::clog << "\nPerfect Hash Index Regression Test:\n";
+      tests();
+
+      std::clog << affirm << '\n';
+    }
+    catch( const std::exception & ex )
+    {
+      std::clog << "FAILURE:  Regression test for \"class PerfectHashIndex\" failed with an unhandled exception. \n\n\n"
+                << ex.what() << std::endl;
+    }
+  }
+} // namespace
@@ -0,0 +1,332 @@
+#include <charconv>      // to_chars(), chars_format
+#include <cstddef>       // size_t
+#include <cstdint>       // uint32_t, uint64_t
+#include <cstring>       // memcpy()
+#include <iomanip>       // setprecision()
+#include <iostream>
+#include <iterator>      // begin(), end()
+#include <locale>
+#include <mutex>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <system_error>  // errc
+#include <utility>       // move()
+
+#include "Book.hpp"
+#include "Receipt.hpp"
+
+
+
+namespace  // anonymous
+{
+  // How a stream inserts a double, when std::to_chars can format it exactly the same.  Anything to_chars can't match, like a
+  // locale's decimal point or a plus sign, is left to the stream.
+  struct NumberFormat
+  {
+    bool              exact     = false;
+    std::chars_format format    = std::chars_format::general;
+    int               precision = 6;
+  };
+
+  NumberFormat numberFormatOf( const std::ostream & stream )
+  {
+    const auto flags      = stream.flags();
+    const auto floatfield = flags & std::ios_base::floatfield;
+    const auto precision  = stream.precision();
+
+    NumberFormat format;
+    format.exact = ( flags & ( std::ios_base::showpos | std::ios_base::uppercase ) ) == 0
+                && precision >= 0 && precision <= 100
+                && stream.getloc() == std::locale::classic();
+
+    if( floatfield == std::ios_base::fixed )
+    {
+      // showpoint only matters with no decimals, when the stream prints a trailing point
+      format.format = std::chars_format::fixed;
+      format.exact  = format.exact && ( precision > 0 || ( flags & std::ios_base::showpoint ) == 0 );
+    }
+    else
+    {
+      // Like printf's %g, which a stream uses, a precision of 0 means 1.  showpoint keeps trailing zeros, which to_chars doesn't.
+      format.exact  = format.exact && floatfield == std::ios_base::fmtflags{} && ( flags & std::ios_base::showpoint ) == 0;
+    }
+    format.precision = static_cast<int>( precision );
+
+    return format;
+  }
+
+
+
+  void appendNumber( std::string & buffer, double value, const NumberFormat & format, const std::ostream & stream )
+  {
+    if( format.exact )
+    {
+      char digits[64];
+      if( auto [end, error] = std::to_chars( std::begin( digits ), std::end( digits ), value, format.format, format.precision ); error == std::errc{} )
+      {
+        buffer.append( digits, end );
+        return;
+      }
+    }
+
+    // Too long for the digits above, or formatted in some way only the stream knows
+    std::ostringstream formatted;
+    formatted.flags    ( stream.flags() );
+    formatted.precision( stream.precision() );
+    formatted.imbue    ( stream.getloc() );
+    formatted << value;
+    buffer += formatted.str();
+  }
+
+
+
+  // As std::quoted() inserts it
+  void appendQuoted( std::string & buffer, std::string_view text )
+  {
+    buffer += '"';
+    for( auto c : text )
+    {
+      if( c == '"' || c == '\\' ) buffer += '\\';
+      buffer += c;
+    }
+    buffer += '"';
+  }
+
+
+
+  void appendUnsigned( std::string & buffer, std::uint64_t value, std::size_t bytes )
+  {
+    for( std::size_t i = 0; i < bytes; ++i, value >>= 8 ) buffer += static_cast<char>( value & 0xFF );
+  }
+
+  void appendString( std::string & buffer, std::string_view text )
+  {
+    appendUnsigned( buffer, text.size(), 4 );
+    buffer += text;
+  }
+
+  void appendDouble( std::string & buffer, double value )
+  {
+    std::uint64_t bits;
+    std::memcpy( &bits, &value, sizeof( bits ) );
+    appendUnsigned( buffer, bits, 8 );
+  }
+
+
+
+  bool readUnsigned( std::istream & stream, std::uint64_t & value, std::size_t bytes )
+  {
+    unsigned char raw[8];
+    if( !stream.read( reinterpret_cast<char *>( raw ), static_cast<std::streamsize>( bytes ) ) ) return false;
+
+    value = 0;
+    for( std::size_t i = bytes; i-- > 0; ) value = value << 8 | raw[i];
+    return true;
+  }
+
+  bool readString( std::istream & stream, std::string & text )
+  {
+    std::uint64_t length;
+    if( !readUnsigned( stream, length, 4 ) ) return false;
+
+    // Read a piece at a time so a corrupt length runs into the end of the stream rather than allocating gigabytes
+    text.clear();
+    char piece[4096];
+    while( length > 0 )
+    {
+      const auto size = length < sizeof( piece ) ? length : sizeof( piece );
+      if( !stream.read( piece, static_cast<std::streamsize>( size ) ) ) return false;
+      text.append( piece, size );
+      length -= size;
+    }
+    return true;
+  }
+
+  bool readDouble( std::istream & stream, double & value )
+  {
+    std::uint64_t bits;
+    if( !readUnsigned( stream, bits, 8 ) ) return false;
+    std::memcpy( &value, &bits, sizeof( value ) );
+    return true;
+  }
+}
+
+
+
+Receipt::Line::Line( Status status, std::string_view scanned, const Book & book )
+  : status( status ), scanned( scanned )
+{
+  if( status == Status::NOT_FOUND )
+  {
+    isbn  = scanned;
+    title = book.title();
+  }
+  else
+  {
+    isbn   = book.isbn();
+    title  = book.title();
+    author = book.author();
+    price  = book.price();
+  }
+}
+
+
+
+bool operator==( const Receipt::Line & lhs, const Receipt::Line & rhs )
+{
+  return lhs.status == rhs.status   &&  lhs.scanned == rhs.scanned  &&  lhs.isbn  == rhs.isbn  &&  lhs.title == rhs.title
+      && lhs.author == rhs.author   &&  !( lhs.price < rhs.price )  &&  !( rhs.price < lhs.price );
+}
+
+bool operator==( const Receipt & lhs, const Receipt & rhs )
+{
+  return lhs.customer == rhs.customer  &&  lhs.lines == rhs.lines  &&  !( lhs.total < rhs.total )  &&  !( rhs.total < lhs.total );
+}
+
+bool operator!=( const Receipt & lhs, const Receipt & rhs ) { return !( lhs == rhs ); }
+
+
+
+
+
+
+
+ReceiptWriter::ReceiptWriter( std::ostream & stream, Format format, std::size_t bufferSize, std::mutex * streamMutex )
+  : _stream( stream ), _streamMutex( streamMutex ), _format( format ), _bufferSize( bufferSize )
+{
+  _buffer.reserve( bufferSize + bufferSize / 4 );
+}
+
+
+
+ReceiptWriter::~ReceiptWriter()
+{
+  try { flush(); }
+  catch( ... ) {}                                                             // destructors mustn't throw, and there's no one to tell
+}
+
+
+
+void ReceiptWriter::write( const Receipt & receipt )
+{
+  // Text receipts read the stream's settings, and change them, as they're printed
+  auto lock = lockStream();
+
+  if( _format == Format::TEXT ) text  ( receipt );
+  else                          binary( receipt );
+
+  if( _buffer.size() >= _bufferSize )
+  {
+    _stream.write( _buffer.data(), static_cast<std::streamsize>( _buffer.size() ) );
+    _buffer.clear();
+  }
+}
+
+
+
+void ReceiptWriter::flush()
+{
+  auto lock = lockStream();
+  _stream.write( _buffer.data(), static_cast<std::streamsize>( _buffer.size() ) );
+  _buffer.clear();
+  _stream.flush();
+}
+
+
+
+std::unique_lock<std::mutex> ReceiptWriter::lockStream()
+{
+  return _streamMutex == nullptr ? std::unique_lock<std::mutex>() : std::unique_lock<std::mutex>( *_streamMutex );
+}
+
+
+
+void ReceiptWriter::text( const Receipt & receipt )
+{
+  auto format = numberFormatOf( _stream );
+
+  _buffer += receipt.customer;
+  _buffer += "'s shopping cart contains:\n";
+
+  for( const auto & line : receipt.lines )
+  {
+    _buffer += '\t';
+    if( line.status == Receipt::Status::NOT_FOUND )
+    {
+      _buffer += line.isbn;
+      _buffer += "\", (";
+      _buffer += line.title;
+      _buffer += ") not found, book is free! \n";
+      continue;
+    }
+
+    appendQuoted( _buffer, line.isbn   );  _buffer += ", ";
+    appendQuoted( _buffer, line.title  );  _buffer += ", ";
+    appendQuoted( _buffer, line.author );  _buffer += ", ";
+    appendNumber( _buffer, line.price, format, _stream );
+
+    if( line.status == Receipt::Status::RESOLVED )
+    {
+      _buffer += "  (scanned as ";
+      _buffer += line.scanned;
+      _buffer += ')';
+    }
+    _buffer += '\n';
+  }
+
+  _stream << std::fixed << std::setprecision( 2 ) << std::showpoint;
+  format = numberFormatOf( _stream );
+
+  _buffer += '\t';
+  _buffer.append( 25, '-' );
+  _buffer += "\n\t Total  $";
+  appendNumber( _buffer, receipt.total, format, _stream );
+  _buffer += "\n\n\n";
+}
+
+
+
+void ReceiptWriter::binary( const Receipt & receipt )
+{
+  appendString  ( _buffer, receipt.customer );
+  appendUnsigned( _buffer, receipt.lines.size(), 4 );
+  for( const auto & line : receipt.lines )
+  {
+    _buffer += static_cast<char>( line.status );
+    appendString( _buffer, line.scanned );
+    appendString( _buffer, line.isbn    );
+    appendString( _buffer, line.title   );
+    appendString( _buffer, line.author  );
+    appendDouble( _buffer, line.price   );
+  }
+  appendDouble( _buffer, receipt.total );
+}
+
+
+
+std::optional<Receipt> ReceiptWriter::read( std::istream & stream )
+{
+  Receipt       receipt;
+  std::uint64_t lines;
+  if( !readString( stream, receipt.customer ) || !readUnsigned( stream, lines, 4 ) ) return std::nullopt;
+
+  for( ; lines > 0; --lines )
+  {
+    Receipt::Line line;
+    char          status;
+    if( !stream.get( status ) ) return std::nullopt;
+
+    line.status = static_cast<Receipt::Status>( status );
+    if( line.status != Receipt::Status::FOUND && line.status != Receipt::Status::RESOLVED && line.status != Receipt::Status::NOT_FOUND ) return std::nullopt;
+
+    if( !readString( stream, line.scanned ) || !readString( stream, line.isbn   ) || !readString( stream, line.title ) ||
+        !readString( stream, line.author  ) || !readDouble( stream, line.price  ) )   return std::nullopt;
+
+    receipt.lines.push_back( std::move( line ) );
+  }
+
+  if( !readDouble( stream, receipt.total ) ) return std::nullopt;
+  return receipt;
+}
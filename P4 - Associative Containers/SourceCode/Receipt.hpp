@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstddef>    // size_t
+#include <iostream>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Book.hpp"
+
+
+
+// What a customer bought, as figured at checkout, kept apart from how it's printed so receipts can be computed by many registers at
+// once and printed later, in bulk, by a ReceiptWriter.  A receipt owns everything it says, so it stays valid however long it waits
+// to be printed.
+struct Receipt
+{
+  enum class Status : char { FOUND = 'F', RESOLVED = 'R', NOT_FOUND = 'N' };
+
+  struct Line
+  {
+    Status      status = Status::FOUND;
+    std::string scanned;                                              // the ISBN as scanned
+    std::string isbn;                                                 // the book charged, which differs from the ISBN scanned only
+    std::string title;                                                // if RESOLVED.  If NOT_FOUND, the ISBN and title on the cart,
+    std::string author;                                               // with no author and no charge
+    double      price  = 0.0;
+
+    Line() = default;
+    Line( Status status, std::string_view scanned, const Book & book );
+  };
+
+  std::string       customer;
+  std::vector<Line> lines;                                            // in the order scanned
+  double            total = 0.0;
+};
+
+// Relational Operators
+bool operator==( const Receipt::Line & lhs, const Receipt::Line & rhs );
+bool operator==( const Receipt       & lhs, const Receipt       & rhs );
+bool operator!=( const Receipt       & lhs, const Receipt       & rhs );
+
+
+
+// Prints receipts into a buffer and writes the buffer to a stream only once it's grown large, so printing many receipts costs a few
+// large writes rather than a stream insertion per field.  Numbers are formatted with std::to_chars instead of through the stream.
+//
+// TEXT receipts read exactly as a receipt inserted field by field into the stream would, prices included:  each book's price is
+// formatted as the stream's settings say when the receipt is written, and the total always in fixed point with two decimals.  Like
+// a receipt inserted field by field, each leaves the stream set to fixed point with two decimals.
+//
+// BINARY receipts are compact and read back exactly by read().  Strings are a 4 byte length and the characters, counts are 4 bytes,
+// and prices the 8 bytes of the double, all little endian.  Open the stream in binary mode.
+//
+// Writers on many threads may share a stream if given a mutex to hold whenever they touch it.  Each writes whole receipts at a time.
+class ReceiptWriter
+{
+  public:
+    enum class Format { TEXT, BINARY };
+
+    static constexpr std::size_t DEFAULT_BUFFER_SIZE = 64 * 1024;
+
+    // Constructors, assignments, destructor
+    explicit ReceiptWriter( std::ostream & stream, Format format = Format::TEXT, std::size_t bufferSize = DEFAULT_BUFFER_SIZE, std::mutex * streamMutex = nullptr );
+
+    ReceiptWriter            ( const ReceiptWriter & ) = delete;
+    ReceiptWriter & operator=( const ReceiptWriter & ) = delete;
+   ~ReceiptWriter();                                                                 // flushes
+
+    // Operations
+    void write( const Receipt & receipt );                                           // Writes the buffer to the stream once it holds
+                                                                                     // at least bufferSize bytes
+    void flush();                                                                    // Writes what's buffered, then flushes the stream
+
+    static std::optional<Receipt> read( std::istream & stream );                     // The next BINARY receipt, std::nullopt at the
+                                                                                     // end of the stream or if it's malformed
+  private:
+    void text  ( const Receipt & receipt );
+    void binary( const Receipt & receipt );
+
+    std::unique_lock<std::mutex> lockStream();                                       // Holds the stream's mutex, if it has one
+
+    std::ostream & _stream;
+    std::mutex *   _streamMutex;
+    Format         _format;
+    std::size_t    _bufferSize;
+    std::string    _buffer;
+};
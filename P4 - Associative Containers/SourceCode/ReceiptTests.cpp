@@ -0,0 +1,146 @@
+#include <exception>
+#include <iomanip>    // setprecision(), quoted()
+#include <ios>        // ios_base
+#include <iostream>   // boolalpha(), showpoint(), fixed()
+#include <optional>
+#include <sstream>
+#include <string>
+
+#include "Book.hpp"
+#include "CheckResults.hpp"
+#include "Receipt.hpp"
+
+
+
+
+
+namespace  // anonymous
+{
+  class ReceiptRegressionTest
+  {
+    public:
+      ReceiptRegressionTest();
+
+    private:
+      void tests();
+
+      Regression::CheckResults affirm;
+  } run_receipt_tests;
+
+
+
+
+  // The receipt as it would read inserted into the stream field by field
+  void insert( std::ostream & stream, const Receipt & receipt )
+  {
+    stream << receipt.customer << "'s shopping cart contains:\n";
+    for( const auto & line : receipt.lines )
+    {
+      if( line.status == Receipt::Status::NOT_FOUND )
+      {
+        stream << '\t' << line.isbn << "\", (" << line.title << ") not found, book is free! \n";
+        continue;
+      }
+      stream << '\t' << Book( line.title, line.author, line.isbn, line.price );
+      if( line.status == Receipt::Status::RESOLVED ) stream << "  (scanned as " << line.scanned << ')';
+      stream << '\n';
+    }
+    stream << std::fixed << std::setprecision( 2 ) << std::showpoint
+           << '\t' << std::string( 25, '-' ) << '\n'
+           << "\t Total  $" << receipt.total << "\n\n\n";
+  }
+
+
+
+  void ReceiptRegressionTest::tests()
+  {
+    Receipt first;
+    first.customer = "Red Baron";
+    first.lines.emplace_back( Receipt::Status::FOUND,     "9991137319",    Book( "Grasses of \"U\" of L", "Back\\slash", "9991137319", 48.61 ) );
+    first.lines.emplace_back( Receipt::Status::NOT_FOUND, "54782169785",   Book( "131 Answer Key" ) );
+    first.lines.emplace_back( Receipt::Status::RESOLVED,  "9792430019",    Book( "Fiqh & manajemen", "Rofiq", "9792430091", 7.0 ) );
+    first.lines.emplace_back( Receipt::Status::FOUND,     "9991130306",    Book( "Birds Atlas", "Anon", "9991130306", 1234567.891 ) );
+    first.total = 48.61 + 7.0 + 1234567.891;
+
+    Receipt second;
+    second.customer = "Charlie Brown";
+    second.lines.emplace_back( Receipt::Status::FOUND,    "9789998852051", Book( "From the Coal Mines", "Someone", "9789998852051", 0.5 ) );
+    second.total = 0.5;
+
+    affirm.is_true ( "Receipt - not found line",                  first.lines[1].isbn == "54782169785" && first.lines[1].title == "131 Answer Key" && first.lines[1].author.empty() );
+
+    {
+      // Text reads exactly as inserted, whether the stream starts in its default format or some other
+      for( auto showpos : { false, true } )
+      {
+        std::ostringstream written, inserted;
+        if( showpos ) { written << std::showpos;  inserted << std::showpos; }
+        {
+          ReceiptWriter writer( written );
+          writer.write( first );
+          writer.write( second );
+        }
+        insert( inserted, first );
+        insert( inserted, second );
+
+        affirm.is_true ( showpos ? "Receipt - text as inserted, showpos" : "Receipt - text as inserted",  inserted.str() == written.str() );
+        affirm.is_true ( "Receipt - stream left as inserted",       written.flags() == inserted.flags() && written.precision() == inserted.precision() );
+      }
+    }
+
+    {
+      // Nothing reaches the stream until the buffer fills or is flushed
+      std::ostringstream stream;
+      ReceiptWriter      writer( stream );
+      writer.write( first );
+      affirm.is_true ( "Receipt - buffered",                      stream.str().empty() );
+      writer.flush();
+      affirm.is_true ( "Receipt - flushed",                       !stream.str().empty() );
+
+      std::ostringstream unbuffered;
+      ReceiptWriter      eager( unbuffered, ReceiptWriter::Format::TEXT, 0 );
+      eager.write( second );
+      affirm.is_true ( "Receipt - written once buffer full",      !unbuffered.str().empty() );
+    }
+
+    {
+      // Binary receipts read back as written, and the end of the stream or a cut off receipt reads as none
+      std::stringstream stream( std::ios_base::in | std::ios_base::out | std::ios_base::binary );
+      {
+        ReceiptWriter writer( stream, ReceiptWriter::Format::BINARY );
+        writer.write( first );
+        writer.write( second );
+      }
+      const auto bytes = stream.str();
+
+      const auto readFirst  = ReceiptWriter::read( stream );
+      const auto readSecond = ReceiptWriter::read( stream );
+      affirm.is_true ( "Receipt - binary round trip",             readFirst == first && readSecond == second );
+      affirm.is_true ( "Receipt - binary end of stream",          !ReceiptWriter::read( stream ) );
+
+      std::istringstream cut( bytes.substr( 0, bytes.size() - 3 ), std::ios_base::binary );
+      affirm.is_true ( "Receipt - binary receipt cut off",        ReceiptWriter::read( cut ) == first && !ReceiptWriter::read( cut ) );
+    }
+  }
+
+
+
+  ReceiptRegressionTest::ReceiptRegressionTest()
+  {
+    std::clog << std::boolalpha << std::showpoint << std::fixed << std::setprecision( 2 );
+
+
+    try
+    {
+      std::clog << "\nReceipt Regression Test:\n";
+      tests();
+
+      std::clog << affirm << '\n';
+    }
+    catch( const std::exception & ex )
+    {
+      std::clog << "FAILURE:  Regression test for \"class ReceiptWriter\" failed with an unhandled exception. \n\n\n"
+                << ex.what() << std::endl;
+    }
+  }
+} // namespace
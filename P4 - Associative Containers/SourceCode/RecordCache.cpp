@@ -0,0 +1,170 @@
+#include <algorithm>     // max(), remove_if()
+#include <cstddef>       // size_t
+#include <cstdint>       // uint64_t
+#include <memory>        // make_unique()
+#include <mutex>
+#include <utility>       // move()
+
+#include "Book.hpp"
+#include "EpochManager.hpp"
+#include "RecordCache.hpp"
+
+
+
+namespace  // anonymous
+{
+  constexpr std::size_t ENTRY_OVERHEAD = 64;                                  // roughly the map node, the entry and the allocation
+                                                                              // header each cached book costs beyond the book itself
+}
+
+
+
+RecordCache::RecordCache( Loader load, std::size_t byteBudget, EpochManager & epochs )
+  : _load       ( std::move( load ) ),
+    _shardBudget( std::max<std::size_t>( byteBudget / SHARDS, 1 ) ),
+    _epochs     ( epochs )
+{}
+
+
+
+RecordCache::~RecordCache()
+{
+  // By now no reader can hold any of the books
+  for( auto & shard : _shards )
+  {
+    for( auto & entry           : shard.entries ) delete entry.book;
+    for( auto & [epoch, book]   : shard.retired ) delete book;
+  }
+}
+
+
+
+RecordCache::Shard & RecordCache::shardOf( std::size_t id )
+{
+  // Consecutive ids are often looked up together, so scatter them over the shards rather than taking the low bits
+  return _shards[static_cast<std::size_t>( ( id * 0x9E37'79B9'7F4A'7C15ULL ) >> 60 ) % SHARDS];
+}
+
+
+
+Book * RecordCache::find( std::size_t id )
+{
+  auto & shard = shardOf( id );
+
+  {
+    std::lock_guard<std::mutex> lock( shard.mutex );
+    if( auto slot = shard.slots.find( id ); slot != shard.slots.end() )
+    {
+      ++shard.statistics.hits;
+      auto & entry = shard.entries[slot->second];
+      entry.referenced = true;
+      return entry.book;
+    }
+    ++shard.statistics.misses;
+  }
+
+  // Load without holding the lock, so a slow read doesn't hold up lookups of other books in the shard
+  auto loaded = _load( id );
+  if( !loaded ) return nullptr;
+
+  auto       book  = std::make_unique<Book>( std::move( *loaded ) );
+  const auto bytes = charge( *book );
+
+  std::lock_guard<std::mutex> lock( shard.mutex );
+
+  // Another thread may have loaded the same book meanwhile, in which case use theirs
+  if( auto slot = shard.slots.find( id ); slot != shard.slots.end() ) return shard.entries[slot->second].book;
+
+  while( !shard.entries.empty() && shard.bytes + bytes > _shardBudget ) evict( shard );
+  reclaim( shard );
+
+  shard.slots[id] = shard.entries.size();
+  // A book isn't marked until looked up again, so books looked up only once, as by a scan, are the first evicted
+  shard.entries.push_back( { id, book.get(), bytes, false } );
+  shard.bytes += bytes;
+
+  return book.release();
+}
+
+
+
+void RecordCache::evict( Shard & shard )
+{
+  // Sweep the hand past entries looked up since it last came by, clearing their mark, and evict the first unmarked
+  while( shard.entries[shard.hand].referenced )
+  {
+    shard.entries[shard.hand].referenced = false;
+    shard.hand = ( shard.hand + 1 ) % shard.entries.size();
+  }
+
+  const auto victim = shard.entries[shard.hand];
+  shard.slots.erase( victim.id );
+  shard.bytes -= victim.bytes;
+  ++shard.statistics.evictions;
+
+  // Readers may still hold the book, so retire it now it can't be found, and free it later
+  shard.retired.emplace_back( _epochs.advance(), victim.book );
+
+  if( shard.hand != shard.entries.size() - 1 )
+  {
+    shard.entries[shard.hand]                 = shard.entries.back();
+    shard.slots[shard.entries[shard.hand].id] = shard.hand;
+  }
+  shard.entries.pop_back();
+  if( shard.hand >= shard.entries.size() ) shard.hand = 0;
+}
+
+
+
+void RecordCache::reclaim( Shard & shard )
+{
+  if( shard.retired.empty() ) return;
+
+  const auto oldest = _epochs.oldestReader();
+  const auto freed  = std::remove_if( shard.retired.begin(), shard.retired.end(), [&]( const auto & retired )
+                                      {
+                                        if( retired.first > oldest ) return false;
+                                        delete retired.second;
+                                        return true;
+                                      } );
+  shard.retired.erase( freed, shard.retired.end() );
+}
+
+
+
+RecordCache::Statistics RecordCache::statistics() const
+{
+  Statistics total;
+  for( auto & shard : _shards )
+  {
+    std::lock_guard<std::mutex> lock( shard.mutex );
+    total.hits      += shard.statistics.hits;
+    total.misses    += shard.statistics.misses;
+    total.evictions += shard.statistics.evictions;
+    total.bytes     += shard.bytes;
+  }
+
+  return total;
+}
+
+
+
+std::size_t RecordCache::byteBudget() const
+{
+  return _shardBudget * SHARDS;
+}
+
+
+
+std::size_t RecordCache::charge( const Book & book )
+{
+  return sizeof( Book ) + ENTRY_OVERHEAD + book.isbn().size() + book.title().size() + book.author().size();
+}
+
+
+
+double RecordCache::Statistics::hitRate() const
+{
+  const auto lookups = hits + misses;
+  return lookups == 0 ? 0.0 : static_cast<double>( hits ) / static_cast<double>( lookups );
+}
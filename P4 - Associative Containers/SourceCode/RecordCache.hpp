@@ -0,0 +1,88 @@
+#pragma once
+
+#include <array>
+#include <cstddef>    // size_t
+#include <cstdint>    // uint64_t
+#include <functional> // function
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <utility>    // pair
+#include <vector>
+
+#include "Book.hpp"
+#include "EpochManager.hpp"
+
+
+
+// A bounded cache of books read from somewhere slow, such as a database file parsed on demand or a B+tree on disk, keyed by id.  The
+// books held are limited to a budget of bytes, and once it is spent, the books not looked up for longest are evicted by the CLOCK
+// algorithm to make room.
+//
+// Books are spread over shards by id, each with its own lock, so threads looking up different books seldom contend.
+//
+// A pointer returned by find() remains valid for as long as the read-side critical section (see EpochManager.hpp) it was found in.
+// Evicted books are retired rather than freed, and freed only once every critical section that might still hold them has ended.
+class RecordCache
+{
+  public:
+    // Types
+    using Loader = std::function<std::optional<Book>( std::size_t id )>;       // Reads a book, std::nullopt if there's none
+
+    struct Statistics
+    {
+      std::size_t hits      = 0;                                                // lookups that found the book cached
+      std::size_t misses    = 0;                                                // lookups that loaded the book
+      std::size_t evictions = 0;
+      std::size_t bytes     = 0;                                                // currently held
+
+      double hitRate() const;                                                   // 0 if nothing has been looked up
+    };
+
+    static constexpr std::size_t SHARDS = 16;
+
+    // Constructors, destructor
+    RecordCache( Loader load, std::size_t byteBudget, EpochManager & epochs );
+
+    RecordCache            ( const RecordCache & ) = delete;
+    RecordCache & operator=( const RecordCache & ) = delete;
+   ~RecordCache();
+
+    // Operations
+    Book *     find( std::size_t id );                                          // Loads the book if not cached.  Must be called from
+                                                                                // within a critical section of the epoch manager given.
+    // Queries
+    Statistics  statistics() const;
+    std::size_t byteBudget() const;
+
+    static std::size_t charge( const Book & book );                             // Bytes a book counts against the budget
+
+  private:
+    struct Entry
+    {
+      std::size_t id         = 0;
+      Book *      book       = nullptr;
+      std::size_t bytes      = 0;
+      bool        referenced = false;                                           // looked up again since loaded or the hand last passed
+    };
+
+    struct alignas( 64 ) Shard
+    {
+      std::mutex                                       mutex;
+      std::unordered_map<std::size_t, std::size_t>     slots;                   // id to its entry
+      std::vector<Entry>                               entries;
+      std::size_t                                      hand  = 0;
+      std::size_t                                      bytes = 0;
+      std::vector<std::pair<std::uint64_t, Book *>>    retired;                 // evicted books and the epoch they were evicted in
+      Statistics                                       statistics;
+    };
+
+    Shard & shardOf( std::size_t id );
+    void    evict  ( Shard & shard );                                           // shard.mutex must be held
+    void    reclaim( Shard & shard );                                           // Frees retired books no reader can still hold.
+                                                                                // shard.mutex must be held.
+    Loader                             _load;
+    std::size_t                        _shardBudget;
+    EpochManager &                     _epochs;
+    mutable std::array<Shard, SHARDS>  _shards;
+};
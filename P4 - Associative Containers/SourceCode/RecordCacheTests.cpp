@@ -0,0 +1,142 @@
+#include <atomic>
+#include <cstddef>    // size_t
+#include <exception>
+#include <iomanip>    // setprecision()
+#include <iostream>   // boolalpha(), showpoint(), fixed()
+#include <optional>
+#include <string>     // to_string()
+#include <thread>
+#include <vector>
+
+#include "Book.hpp"
+#include "CheckResults.hpp"
+#include "EpochManager.hpp"
+#include "RecordCache.hpp"
+
+
+
+
+
+namespace  // anonymous
+{
+  class RecordCacheRegressionTest
+  {
+    public:
+      RecordCacheRegressionTest();
+
+    private:
+      void tests();
+
+      Regression::CheckResults affirm;
+  } run_recordCache_tests;
+
+
+
+
+  void RecordCacheRegressionTest::tests()
+  {
+    const auto bookOf = []( std::size_t id ) { return Book( "Title " + std::to_string( id ), "Author", std::to_string( id ), static_cast<double>( id ) ); };
+
+    constexpr std::size_t BOOKS = 1'000;
+
+    EpochManager             epochs;
+    std::atomic<std::size_t> loads{ 0 };
+    const auto               load = [&]( std::size_t id ) -> std::optional<Book>
+    {
+      ++loads;
+      if( id >= BOOKS ) return std::nullopt;
+      return bookOf( id );
+    };
+
+    {
+      // Room for every book, so each is loaded once
+      RecordCache cache( load, BOOKS * 1'000, epochs );
+      auto        guard = epochs.enter();
+
+      const auto first = cache.find( 42 );
+      affirm.is_true ( "Record cache - book loaded",                first != nullptr && *first == bookOf( 42 ) );
+      affirm.is_true ( "Record cache - book loaded only once",      cache.find( 42 ) == first && loads == 1 );
+      affirm.is_equal( "Record cache - missing book not found",     nullptr, cache.find( BOOKS ) );
+
+      const auto statistics = cache.statistics();
+      affirm.is_equal( "Record cache - hits counted",               1ULL, statistics.hits );
+      affirm.is_equal( "Record cache - misses counted",             2ULL, statistics.misses );
+      affirm.is_true ( "Record cache - hit rate",                   statistics.hitRate() > 0.33 && statistics.hitRate() < 0.34 );
+      affirm.is_equal( "Record cache - bytes counted",              RecordCache::charge( bookOf( 42 ) ), statistics.bytes );
+    }
+
+    {
+      // Room for about a tenth of the books.  Books held stay valid until the critical section they were found in ends, however many
+      // are evicted meanwhile.
+      RecordCache cache( load, BOOKS / 10 * RecordCache::charge( bookOf( BOOKS ) ), epochs );
+
+      bool heldIntact = true;
+      {
+        auto       guard = epochs.enter();
+        const auto held  = cache.find( 7 );
+        for( std::size_t id = 0; id < BOOKS; ++id ) cache.find( id );
+        heldIntact = held != nullptr && *held == bookOf( 7 );
+      }
+      affirm.is_true ( "Record cache - held book survives eviction", heldIntact );
+
+      const auto statistics = cache.statistics();
+      affirm.is_true ( "Record cache - books evicted",              statistics.evictions > 0 );
+      affirm.is_true ( "Record cache - budget respected",           statistics.bytes <= cache.byteBudget() );
+
+      // A hot book looked up between every other lookup stays cached
+      loads = 0;
+      bool hotIntact = true;
+      for( std::size_t id = 0; id < BOOKS; ++id )
+      {
+        auto guard = epochs.enter();
+        auto hot   = cache.find( 3 );
+        cache.find( id );
+        hotIntact = hotIntact && hot != nullptr && *hot == bookOf( 3 );
+      }
+      affirm.is_true ( "Record cache - hot book kept",              hotIntact && loads < BOOKS + 2 );
+    }
+
+    {
+      // Many threads looking up overlapping books always see the right ones
+      RecordCache              cache( load, BOOKS / 4 * RecordCache::charge( bookOf( BOOKS ) ), epochs );
+      std::atomic<std::size_t> wrong{ 0 };
+      std::vector<std::thread> threads;
+
+      for( std::size_t t = 0; t < 4; ++t ) threads.emplace_back( [&, t]
+      {
+        for( std::size_t i = 0; i < 20'000; ++i )
+        {
+          auto       guard = epochs.enter();
+          const auto id    = ( i * 7 + t * 13 ) % BOOKS;
+          const auto book  = cache.find( id );
+          if( book == nullptr || !( *book == bookOf( id ) ) ) ++wrong;
+        }
+      } );
+      for( auto & thread : threads ) thread.join();
+
+      affirm.is_equal( "Record cache - concurrent lookups",          0ULL, wrong.load() );
+      affirm.is_equal( "Record cache - every lookup counted",        80'000ULL, cache.statistics().hits + cache.statistics().misses );
+    }
+  }
+
+
+
+  RecordCacheRegressionTest::RecordCacheRegressionTest()
+  {
+    std::clog << std::boolalpha << std::showpoint << std::fixed << std::setprecision( 2 );
+
+
+    try
+    {
+      std::clog << "\nRecord Cache Regression Test:\n";
+      tests();
+
+      std::clog << affirm << '\n';
+    }
+    catch( const std::exception & ex )
+    {
+      std::clog << "FAILURE:  Regression test for \"class RecordCache\" failed with an unhandled exception. \n\n\n"
+                << ex.what() << std::endl;
+    }
+  }
+} // namespace
@@ -0,0 +1,99 @@
+#include <algorithm>     // lower_bound(), upper_bound(), min(), sort()
+#include <cstddef>       // size_t, ptrdiff_t
+#include <cstdint>       // uint32_t
+#include <string>
+#include <string_view>
+#include <utility>       // pair
+#include <vector>
+
+#include "Book.hpp"
+#include "SecondaryIndexes.hpp"
+
+
+
+// Constructors
+SecondaryIndexes::SecondaryIndexes( const std::vector<const Book *> & books )
+{
+  // Author index.  Count each author's books first so every posting list can be laid out in place within one array, then fill the
+  // lists in id order.
+  for( const auto * book : books )
+  {
+    if( book != nullptr ) ++_authors[book->author()].count;
+  }
+
+  std::uint32_t offset = 0;
+  for( auto & [author, posting] : _authors )
+  {
+    posting.offset  = offset;
+    offset         += posting.count;
+    posting.count   = 0;                                      // reused below as the fill position
+  }
+
+  _authorPostings.resize( offset );
+  for( std::size_t id = 0; id < books.size(); ++id )
+  {
+    if( books[id] == nullptr ) continue;
+
+    auto & posting = _authors.find( books[id]->author() )->second;
+    _authorPostings[posting.offset + posting.count++] = static_cast<Id>( id );
+  }
+
+
+  // Price index
+  std::vector<std::pair<double, Id>> byPrice;
+  byPrice.reserve( books.size() );
+  for( std::size_t id = 0; id < books.size(); ++id )
+  {
+    if( books[id] != nullptr ) byPrice.emplace_back( books[id]->price(), static_cast<Id>( id ) );
+  }
+  std::sort( byPrice.begin(), byPrice.end() );
+
+  _prices .reserve( byPrice.size() );
+  _byPrice.reserve( byPrice.size() );
+  for( const auto & [price, id] : byPrice )
+  {
+    _prices .push_back( price );
+    _byPrice.push_back( id    );
+  }
+}
+
+
+
+// Queries
+std::vector<SecondaryIndexes::Id> SecondaryIndexes::byAuthor( std::string_view author ) const
+{
+  auto it = _authors.find( std::string( author ) );
+  if( it == _authors.end() ) return {};
+
+  auto first = _authorPostings.cbegin() + it->second.offset;
+  return { first, first + it->second.count };
+}
+
+
+
+std::vector<SecondaryIndexes::Id> SecondaryIndexes::byPriceRange( double low, double high ) const
+{
+  if( high < low ) return {};
+
+  auto first = std::lower_bound( _prices.cbegin(), _prices.cend(), low  ) - _prices.cbegin();
+  auto last  = std::upper_bound( _prices.cbegin(), _prices.cend(), high ) - _prices.cbegin();
+
+  return { _byPrice.cbegin() + first, _byPrice.cbegin() + last };
+}
+
+
+
+std::vector<SecondaryIndexes::Id> SecondaryIndexes::cheapest( std::size_t count ) const
+{
+  count = std::min( count, _byPrice.size() );
+  return { _byPrice.cbegin(), _byPrice.cbegin() + static_cast<std::ptrdiff_t>( count ) };
+}
+
+
+
+std::vector<SecondaryIndexes::Id> SecondaryIndexes::mostExpensive( std::size_t count ) const
+{
+  count = std::min( count, _byPrice.size() );
+  return { _byPrice.crbegin(), _byPrice.crbegin() + static_cast<std::ptrdiff_t>( count ) };
+}
+
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstddef>    // size_t
+#include <cstdint>    // uint32_t
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "Book.hpp"
+
+
+
+// Author and price indexes over a set of books identified by dense ids 0, 1, 2, ...  The indexes hold ids rather than copies of
+// the books, so a book costs 4 bytes in the author index and 12 bytes in the price index.  All the ids for one author are stored
+// contiguously in one shared posting array.
+class SecondaryIndexes
+{
+  public:
+    using Id = std::uint32_t;
+
+    // Constructors
+    SecondaryIndexes( const std::vector<const Book *> & books );                // books[id] is the book with that id, nullptr if none
+
+    // Queries
+    std::vector<Id> byAuthor     ( std::string_view author ) const;             // in ascending id order
+    std::vector<Id> byPriceRange ( double low, double high ) const;             // low <= price <= high, in ascending price order
+    std::vector<Id> cheapest     ( std::size_t count       ) const;             // in ascending price order
+    std::vector<Id> mostExpensive( std::size_t count       ) const;             // in descending price order
+
+  private:
+    struct Posting                                                              // a slice of _authorPostings
+    {
+      std::uint32_t offset;
+      std::uint32_t count;
+    };
+
+    std::unordered_map<std::string, Posting> _authors;
+    std::vector<Id>                          _authorPostings;                   // grouped by author, ascending ids within a group
+    std::vector<double>                      _prices;                           // ascending, parallels _byPrice
+    std::vector<Id>                          _byPrice;                          // ids ordered by price, then id
+};
@@ -0,0 +1,71 @@
+#include <exception>
+#include <iomanip>    // setprecision()
+#include <iostream>   // boolalpha(), showpoint(), fixed()
+#include <vector>
+
+#include "Book.hpp"
+#include "CheckResults.hpp"
+#include "SecondaryIndexes.hpp"
+
+
+
+
+
+namespace  // anonymous
+{
+  class SecondaryIndexesRegressionTest
+  {
+    public:
+      SecondaryIndexesRegressionTest();
+
+    private:
+      void tests();
+
+      Regression::CheckResults affirm;
+  } run_secondaryIndexes_tests;
+
+
+
+
+  void SecondaryIndexesRegressionTest::tests()
+  {
+    using Ids = std::vector<SecondaryIndexes::Id>;
+
+    const Book annFirst ( "First",  "Ann", "0000000001", 5.00 );
+    const Book bobFirst ( "Second", "Bob", "0000000002", 3.00 );
+    const Book annSecond( "Third",  "Ann", "0000000003", 7.00 );
+    const Book bobSecond( "Fourth", "Bob", "0000000004", 3.00 );
+
+    //                                      id:    0          1         2          3           4
+    const SecondaryIndexes indexes( std::vector<const Book *>{ &annFirst, nullptr, &bobFirst, &annSecond, &bobSecond } );
+
+    affirm.is_true( "Secondary indexes - author's books in id order",               indexes.byAuthor( "Ann" ) == Ids{ 0, 3 } );
+    affirm.is_true( "Secondary indexes - unknown author has no books",              indexes.byAuthor( "Nobody" ).empty() );
+    affirm.is_true( "Secondary indexes - price range inclusive, cheapest first",    indexes.byPriceRange( 3.00, 5.00 ) == Ids{ 2, 4, 0 } );
+    affirm.is_true( "Secondary indexes - empty price range",                        indexes.byPriceRange( 6.00, 4.00 ).empty() );
+    affirm.is_true( "Secondary indexes - cheapest",                                 indexes.cheapest( 2 ) == Ids{ 2, 4 } );
+    affirm.is_true( "Secondary indexes - most expensive",                           indexes.mostExpensive( 2 ) == Ids{ 3, 0 } );
+    affirm.is_true( "Secondary indexes - no more books than indexed",               indexes.mostExpensive( 10 ).size() == 4 );
+  }
+
+
+
+  SecondaryIndexesRegressionTest::SecondaryIndexesRegressionTest()
+  {
+    std::clog << std::boolalpha << std::showpoint << std::fixed << std::setprecision( 2 );
+
+
+    try
+    {
+      std::clog << "\nSecondary Indexes Regression Test:\n";
+      tests();
+
+      std::clog << affirm << '\n';
+    }
+    catch( const std::exception & ex )
+    {
+      std::clog << "FAILURE:  Regression test for \"class SecondaryIndexes\" failed with an unhandled exception. \n\n\n"
+                << ex.what() << std::endl;
+    }
+  }
+} // namespace
@@ -0,0 +1,164 @@
+#pragma once
+
+#include <algorithm>  // max()
+#include <atomic>
+#include <cstddef>    // size_t
+#include <cstdint>    // uint64_t
+#include <thread>     // yield()
+#include <utility>    // move()
+#include <vector>
+
+
+
+// How full a ring was kept, gathered as it's used.  Read once both its producer and consumer are done.
+struct SpscRingStatistics
+{
+  std::size_t   capacity     = 0;
+  std::uint64_t pushes       = 0;
+  std::uint64_t occupancy    = 0;                                       // items already waiting, summed over every push
+  std::size_t   maxOccupancy = 0;
+  std::uint64_t fullWaits    = 0;                                       // pushes that waited for room:  the consumer held things up
+  std::uint64_t emptyWaits   = 0;                                       // pops that waited for an item:  the producer held things up
+
+  double meanOccupancy() const { return pushes == 0 ? 0.0 : static_cast<double>( occupancy ) / static_cast<double>( pushes ); }
+};
+
+
+
+// A bounded queue between exactly two threads, one pushing and one popping, without locks.  Each side owns one index and only reads
+// the other's, so neither ever waits on the other except when the ring is full or empty.  A push into a full ring waits until the
+// consumer makes room, so a fast producer is held back to the pace of a slow consumer (back-pressure), and a pop from an empty ring
+// waits until there's an item.  Waiting spins briefly, then yields the processor.
+//
+// Either side may close the ring:  the producer when it has nothing more to push, the consumer when it will pop no more, as when it
+// failed, so a producer waiting for room isn't left waiting forever.
+template<typename T>
+class SpscRing
+{
+  public:
+    // Constructors, assignments, destructor
+    explicit SpscRing( std::size_t capacity );                          // Rounded up to a power of two
+
+    SpscRing            ( const SpscRing & ) = delete;
+    SpscRing & operator=( const SpscRing & ) = delete;
+
+    // Operations
+    bool push   ( T item );                                             // Producer only.  False if the ring was closed.
+    bool pop    ( T & item );                                           // Consumer only.  False once the ring is closed and empty.
+    bool tryPop ( T & item );                                           // Consumer only.  False at once if the ring is empty.
+    void close  ();
+
+    // Queries
+    SpscRingStatistics statistics() const;
+
+  private:
+    static constexpr std::size_t CACHE_LINE = 64;                       // so each side's index is on a cache line of its own
+    static constexpr unsigned    SPINS      = 64;                       // before yielding
+
+    std::vector<T>     _slots;
+    std::size_t        _mask;
+
+    alignas( CACHE_LINE ) std::atomic<std::size_t> _head{ 0 };         // next to pop, written only by the consumer
+    alignas( CACHE_LINE ) std::atomic<std::size_t> _tail{ 0 };         // next to push, written only by the producer
+    alignas( CACHE_LINE ) std::atomic<bool>        _closed{ false };
+
+    SpscRingStatistics _pushed;                                         // kept by the producer
+    std::uint64_t      _emptyWaits = 0;                                 // kept by the consumer
+};
+
+
+
+
+
+
+
+
+
+template<typename T>
+SpscRing<T>::SpscRing( std::size_t capacity )
+{
+  std::size_t size = 1;
+  while( size < std::max<std::size_t>( capacity, 1 ) ) size <<= 1;
+
+  _slots.resize( size );
+  _mask            = size - 1;
+  _pushed.capacity = size;
+}
+
+
+
+template<typename T>
+bool SpscRing<T>::push( T item )
+{
+  const auto tail = _tail.load( std::memory_order_relaxed );
+  auto       head = _head.load( std::memory_order_acquire );
+
+  if( tail - head == _slots.size() )
+  {
+    ++_pushed.fullWaits;
+    for( unsigned spin = 0; tail - head == _slots.size(); head = _head.load( std::memory_order_acquire ) )
+    {
+      if( _closed.load( std::memory_order_acquire ) ) return false;
+      if( ++spin > SPINS ) std::this_thread::yield();
+    }
+  }
+  if( _closed.load( std::memory_order_relaxed ) ) return false;
+
+  const auto waiting = tail - head;
+  ++_pushed.pushes;
+  _pushed.occupancy   += waiting;
+  _pushed.maxOccupancy = std::max( _pushed.maxOccupancy, waiting );
+
+  _slots[tail & _mask] = std::move( item );
+  _tail.store( tail + 1, std::memory_order_release );
+  return true;
+}
+
+
+
+template<typename T>
+bool SpscRing<T>::pop( T & item )
+{
+  if( tryPop( item ) ) return true;
+
+  ++_emptyWaits;
+  for( unsigned spin = 0; ; )
+  {
+    // Closing comes after the last push, so once closed, one more look finds anything pushed before
+    const bool closed = _closed.load( std::memory_order_acquire );
+    if( tryPop( item ) ) return true;
+    if( closed )         return false;
+    if( ++spin > SPINS ) std::this_thread::yield();
+  }
+}
+
+
+
+template<typename T>
+bool SpscRing<T>::tryPop( T & item )
+{
+  const auto head = _head.load( std::memory_order_relaxed );
+  if( head == _tail.load( std::memory_order_acquire ) ) return false;
+
+  item = std::move( _slots[head & _mask] );
+  _head.store( head + 1, std::memory_order_release );
+  return true;
+}
+
+
+
+template<typename T>
+void SpscRing<T>::close()
+{
+  _closed.store( true, std::memory_order_release );
+}
+
+
+
+template<typename T>
+SpscRingStatistics SpscRing<T>::statistics() const
+{
+  auto statistics       = _pushed;
+  statistics.emptyWaits = _emptyWaits;
+  return statistics;
+}
@@ -0,0 +1,116 @@
+#include <atomic>
+#include <chrono>     // milliseconds
+#include <cstddef>    // size_t
+#include <exception>
+#include <iomanip>    // setprecision()
+#include <iostream>   // boolalpha(), showpoint(), fixed()
+#include <string>     // to_string()
+#include <thread>     // sleep_for()
+#include <vector>
+
+#include "CheckResults.hpp"
+#include "SpscRing.hpp"
+
+
+
+
+
+namespace  // anonymous
+{
+  class SpscRingRegressionTest
+  {
+    public:
+      SpscRingRegressionTest();
+
+    private:
+      void tests();
+
+      Regression::CheckResults affirm;
+  } run_spscRing_tests;
+
+
+
+
+  void SpscRingRegressionTest::tests()
+  {
+    {
+      // Everything pushed is popped, in order, however far the producer gets ahead, and never more than fit are waiting
+      constexpr std::size_t ITEMS = 100'000;
+
+      SpscRing<std::string> ring( 6 );
+      std::thread producer( [&]
+      {
+        for( std::size_t i = 0; i < ITEMS; ++i ) ring.push( std::to_string( i ) );
+        ring.close();
+      } );
+
+      std::size_t popped  = 0;
+      bool        inOrder = true;
+      for( std::string item; ring.pop( item ); ++popped ) inOrder = inOrder && item == std::to_string( popped );
+      producer.join();
+
+      const auto statistics = ring.statistics();
+      affirm.is_equal( "SPSC ring - capacity rounded up",              8ULL,  statistics.capacity );
+      affirm.is_true ( "SPSC ring - everything popped, in order",      inOrder && popped == ITEMS && statistics.pushes == ITEMS );
+      affirm.is_true ( "SPSC ring - occupancy bounded",                statistics.maxOccupancy <= 8 && statistics.meanOccupancy() <= 8.0 );
+    }
+
+    {
+      // A producer pushing into a full ring is held back until the consumer pops
+      SpscRing<int> ring( 2 );
+      ring.push( 1 );
+      ring.push( 2 );
+
+      std::atomic<bool> popping{ false };
+      bool              heldBack = false;
+      std::thread producer( [&] { ring.push( 3 );  heldBack = popping.load();  ring.close(); } );
+
+      std::this_thread::sleep_for( std::chrono::milliseconds( 20 ) );
+      popping = true;
+      std::vector<int> popped;
+      for( int item; ring.pop( item ); ) popped.push_back( item );
+      producer.join();
+
+      affirm.is_true ( "SPSC ring - back-pressure",                    heldBack && popped == std::vector<int>{ 1, 2, 3 } );
+    }
+
+    {
+      // Closed by the consumer, a push fails rather than waiting for room that never comes, and closed by the producer, what was
+      // pushed before is still popped
+      SpscRing<int> full( 1 );
+      full.push( 1 );
+      full.close();
+
+      SpscRing<int> closed( 4 );
+      closed.push( 1 );
+      closed.close();
+      int  item      = 0;
+      bool drained   = closed.pop( item ) && item == 1 && !closed.pop( item );
+
+      affirm.is_true ( "SPSC ring - push fails once closed",           !full.push( 2 ) && full.statistics().pushes == 1 && full.statistics().fullWaits == 1 );
+      affirm.is_true ( "SPSC ring - drained once closed",              drained );
+      affirm.is_true ( "SPSC ring - try pop doesn't wait",             !closed.tryPop( item ) );
+    }
+  }
+
+
+
+  SpscRingRegressionTest::SpscRingRegressionTest()
+  {
+    std::clog << std::boolalpha << std::showpoint << std::fixed << std::setprecision( 2 );
+
+
+    try
+    {
+      std::clog << "\nSPSC Ring Regression Test:\n";
+      tests();
+
+      std::clog << affirm << '\n';
+    }
+    catch( const std::exception & ex )
+    {
+      std::clog << "FAILURE:  Regression test for \"class SpscRing\" failed with an unhandled exception. \n\n\n"
+                << ex.what() << std::endl;
+    }
+  }
+} // namespace
@@ -0,0 +1,204 @@
+#include <algorithm>      // max(), sort()
+#include <cstddef>        // size_t
+#include <cstdint>        // uint8_t, uint32_t
+#include <cstring>        // memcpy()
+#include <random>         // mt19937, uniform_int_distribution
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>        // make_pair(), pair
+#include <vector>
+
+#include "StringStore.hpp"
+
+
+
+namespace  // anonymous
+{
+  constexpr std::size_t SAMPLE_BYTES    = 64 * 1024;                          // enough text to find the common symbols, small enough
+                                                                              // to train on quickly
+  constexpr unsigned    TRAINING_ROUNDS = 5;                                  // each round can double the longest symbol's length
+  constexpr std::size_t MAX_SYMBOLS     = 255;                                // one code is left over for ESCAPE
+  constexpr std::size_t MAX_LENGTH      = 8;
+}
+
+
+
+StringStore::StringStore( const std::vector<std::string_view> & strings )
+{
+  train( strings );
+
+  _offsets.reserve( strings.size() + 1 );
+  for( const auto string : strings )
+  {
+    _codes += encode( string );
+    _offsets.push_back( static_cast<std::uint32_t>( _codes.size() ) );
+    _longest = std::max( _longest, string.size() );
+  }
+  _codes.shrink_to_fit();
+}
+
+
+
+// Each round compresses a sample with the symbols found so far, then keeps the symbols and pairs of adjacent symbols that would have
+// saved the most bytes.  Longer symbols are built up from shorter ones round by round.
+void StringStore::train( const std::vector<std::string_view> & strings )
+{
+  std::size_t totalBytes = 0;
+  for( const auto string : strings ) totalBytes += string.size();
+
+  // Sample strings at random rather than at regular intervals, which could fall in step with some pattern in the strings' order
+  std::vector<std::string_view> sample;
+  if( totalBytes <= SAMPLE_BYTES ) sample = strings;
+  else
+  {
+    std::mt19937 random( 131 );
+    for( std::size_t sampleBytes = 0; sampleBytes < SAMPLE_BYTES; sampleBytes += sample.back().size() + 1 )
+    {
+      sample.push_back( strings[std::uniform_int_distribution<std::size_t>( 0, strings.size() - 1 )( random )] );
+    }
+  }
+
+  for( unsigned round = 0; round < TRAINING_ROUNDS; ++round )
+  {
+    std::unordered_map<std::string, std::size_t> gains;                       // bytes covered by each candidate symbol
+
+    for( const auto text : sample )
+    {
+      std::string_view previous;
+      for( std::size_t position = 0; position < text.size(); )
+      {
+        const auto code    = match( text, position );
+        const auto current = text.substr( position, code == ESCAPE ? 1 : _symbols[code].length );
+
+        gains[std::string( current )] += current.size();
+        if( !previous.empty() )
+        {
+          const auto joined = text.substr( position - previous.size(), std::min( MAX_LENGTH, previous.size() + current.size() ) );
+          gains[std::string( joined )] += joined.size();
+        }
+
+        previous  = current;
+        position += current.size();
+      }
+    }
+
+    std::vector<std::pair<std::size_t, std::string>> ranked;
+    for( const auto & [symbol, gain] : gains ) ranked.emplace_back( gain, symbol );
+
+    std::sort( ranked.begin(), ranked.end(), []( const auto & lhs, const auto & rhs )
+               { return std::make_pair( rhs.first, lhs.second ) < std::make_pair( lhs.first, rhs.second ); } );
+    if( ranked.size() > MAX_SYMBOLS ) ranked.resize( MAX_SYMBOLS );
+
+    // Codes are ordered by first byte, longest symbol first, so matching can stop at the first symbol that fits
+    std::sort( ranked.begin(), ranked.end(), []( const auto & lhs, const auto & rhs )
+               {
+                 const auto lhsFirst = static_cast<std::uint8_t>( lhs.second.front() ), rhsFirst = static_cast<std::uint8_t>( rhs.second.front() );
+                 return lhsFirst != rhsFirst ? lhsFirst < rhsFirst : lhs.second.size() > rhs.second.size();
+               } );
+
+    _symbols.assign( ranked.size(), Symbol{} );
+    for( std::size_t code = 0; code < ranked.size(); ++code )
+    {
+      ranked[code].second.copy( _symbols[code].bytes.data(), MAX_LENGTH );
+      _symbols[code].length = static_cast<std::uint8_t>( ranked[code].second.size() );
+    }
+
+    std::size_t code = 0;
+    for( std::size_t byte = 0; byte <= 256; ++byte )
+    {
+      while( code < _symbols.size() && static_cast<std::uint8_t>( _symbols[code].bytes[0] ) < byte ) ++code;
+      _firstCode[byte] = static_cast<std::uint8_t>( code );
+    }
+  }
+}
+
+
+
+std::size_t StringStore::match( std::string_view text, std::size_t position ) const
+{
+  const auto first = static_cast<std::uint8_t>( text[position] );
+  for( std::size_t code = _firstCode[first]; code < _firstCode[first + 1U]; ++code )
+  {
+    const auto & symbol = _symbols[code];
+    if( text.compare( position, symbol.length, symbol.bytes.data(), symbol.length ) == 0 ) return code;
+  }
+
+  return ESCAPE;
+}
+
+
+
+std::string StringStore::encode( std::string_view text ) const
+{
+  std::string codes;
+  for( std::size_t position = 0; position < text.size(); )
+  {
+    const auto code = match( text, position );
+    if( code == ESCAPE )
+    {
+      codes += static_cast<char>( ESCAPE );
+      codes += text[position++];
+    }
+    else
+    {
+      codes    += static_cast<char>( code );
+      position += _symbols[code].length;
+    }
+  }
+
+  return codes;
+}
+
+
+
+std::string_view StringStore::decode( std::size_t id, std::string & buffer ) const
+{
+  // Every symbol is copied whole, 8 bytes, and the excess overwritten by what follows.  Leave room for the last symbol's excess.
+  if( buffer.size() < _longest + MAX_LENGTH ) buffer.resize( _longest + MAX_LENGTH );
+
+  auto       codes = _codes.data() + _offsets[id];
+  const auto end   = _codes.data() + _offsets[id + 1];
+  auto       out   = buffer.data();
+
+  while( codes != end )
+  {
+    const auto code = static_cast<std::uint8_t>( *codes++ );
+    if( code == ESCAPE )
+    {
+      *out++ = *codes++;
+    }
+    else
+    {
+      std::memcpy( out, _symbols[code].bytes.data(), MAX_LENGTH );
+      out += _symbols[code].length;
+    }
+  }
+
+  return { buffer.data(), static_cast<std::size_t>( out - buffer.data() ) };
+}
+
+
+
+std::string StringStore::decode( std::size_t id ) const
+{
+  std::string buffer;
+  return std::string( decode( id, buffer ) );
+}
+
+
+
+std::size_t StringStore::size() const
+{
+  return _offsets.size() - 1;
+}
+
+
+
+std::size_t StringStore::sizeInBytes() const
+{
+  return _symbols.capacity() * sizeof( Symbol        )
+       + sizeof( _firstCode )
+       + _codes  .capacity()
+       + _offsets.capacity() * sizeof( std::uint32_t );
+}
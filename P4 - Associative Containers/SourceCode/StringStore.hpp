@@ -0,0 +1,53 @@
+#pragma once
+
+#include <array>
+#include <cstddef>    // size_t
+#include <cstdint>    // uint8_t, uint32_t
+#include <string>
+#include <string_view>
+#include <vector>
+
+
+
+// A fixed collection of strings held compressed, any one of which can be decompressed on its own.  Compression replaces the byte
+// sequences most common across the whole collection, such as frequent words and names, with one byte codes, following FSST (Fast
+// Static Symbol Table).  A table of up to 255 symbols of 1 to 8 bytes is trained on a sample of the strings, then each string is
+// encoded by greedily replacing its longest matching symbols.  Bytes no symbol covers are escaped.  Decompressing a string is a
+// table lookup and an 8 byte copy per code, with no dependence on any other string.
+//
+// Strings are identified by their position in the collection given at construction.
+class StringStore
+{
+  public:
+    // Constructors
+    StringStore() = default;                                                    // holds no strings
+    StringStore( const std::vector<std::string_view> & strings );
+
+    // Queries
+    std::string_view decode     ( std::size_t id, std::string & buffer ) const; // decompresses into buffer and returns a view of the
+                                                                                // result.  The buffer is grown only if too small, so
+                                                                                // decoding into the same buffer again doesn't allocate.
+    std::string      decode     ( std::size_t id                       ) const;
+    std::size_t      size       ()                                       const; // number of strings
+    std::size_t      sizeInBytes()                                       const;
+
+  private:
+    static constexpr std::uint8_t ESCAPE = 255;                                 // the code preceding a byte no symbol covers
+
+    struct Symbol
+    {
+      std::array<char, 8> bytes  = {};                                          // zero padded, so always safe to copy whole
+      std::uint8_t        length = 0;
+    };
+
+    std::string encode( std::string_view text ) const;
+    void        train ( const std::vector<std::string_view> & strings );
+    std::size_t match ( std::string_view text, std::size_t position ) const;   // the code of the longest symbol found at position, or
+                                                                                // ESCAPE if none
+    std::vector<Symbol>        _symbols;                                        // indexed by code
+    std::array<std::uint8_t, 257> _firstCode = {};                              // codes of symbols starting with byte b are
+                                                                                // [_firstCode[b], _firstCode[b + 1]), longest first
+    std::string                _codes;                                          // every string's codes back to back
+    std::vector<std::uint32_t> _offsets = { 0 };                                // string i's codes are _codes[_offsets[i], _offsets[i + 1])
+    std::size_t                _longest = 0;                                    // longest string decoded
+};
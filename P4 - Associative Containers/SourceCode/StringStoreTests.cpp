@@ -0,0 +1,101 @@
+#include <cstddef>    // size_t
+#include <exception>
+#include <iomanip>    // setprecision()
+#include <iostream>   // boolalpha(), showpoint(), fixed()
+#include <string>     // to_string()
+#include <string_view>
+#include <vector>
+
+#include "CheckResults.hpp"
+#include "StringStore.hpp"
+
+
+
+
+
+namespace  // anonymous
+{
+  class StringStoreRegressionTest
+  {
+    public:
+      StringStoreRegressionTest();
+
+    private:
+      void tests();
+
+      Regression::CheckResults affirm;
+  } run_stringStore_tests;
+
+
+
+
+  void StringStoreRegressionTest::tests()
+  {
+    // True if every string decodes to what was stored
+    const auto roundTrips = []( const StringStore & store, const std::vector<std::string> & strings )
+    {
+      std::string buffer;
+      for( std::size_t id = 0; id < strings.size(); ++id ) if( store.decode( id, buffer ) != strings[id] ) return false;
+      return store.size() == strings.size();
+    };
+
+    {
+      const StringStore nothing;
+      affirm.is_equal( "String store - default is empty",           0ULL, nothing.size() );
+
+      // Empty strings, bytes outside ASCII, and the byte that doubles as the escape code all survive
+      const std::vector<std::string> odd{ "", "x", "caf\xC3\xA9", std::string( "nul\0inside", 10 ), "\xFF\xFF\xFF", "" };
+      affirm.is_true ( "String store - unusual strings round trip", roundTrips( StringStore( { odd.begin(), odd.end() } ), odd ) );
+    }
+
+    {
+      // Titles and authors drawn from small vocabularies, as real ones largely are
+      const std::vector<std::string> words  { "The", "History", "of", "Modern", "Art", "and", "Science", "Volume", "Collected", "Works" };
+      const std::vector<std::string> authors{ "Rosemary Sullivan", "Charles Schulz", "J. R. R. Tolkien", "Stephen Hawking" };
+
+      std::vector<std::string> titles, names;
+      std::size_t              rawBytes = 0;
+      for( std::size_t i = 0; i < 20'000; ++i )
+      {
+        titles.push_back( words[i % 7] + ' ' + words[i / 7 % 10] + ' ' + words[i / 70 % 10] + ' ' + std::to_string( i % 13 ) );
+        names .push_back( authors[i * 7 % authors.size()] );
+        rawBytes += titles.back().size() + names.back().size();
+      }
+
+      const StringStore titleStore ( { titles.begin(), titles.end() } );
+      const StringStore authorStore( { names .begin(), names .end() } );
+
+      affirm.is_true ( "String store - titles round trip",          roundTrips( titleStore,  titles ) );
+      affirm.is_true ( "String store - authors round trip",         roundTrips( authorStore, names  ) );
+      affirm.is_true ( "String store - at least half the size",     2 * ( titleStore.sizeInBytes() + authorStore.sizeInBytes() ) < rawBytes );
+      affirm.is_equal( "String store - decoded without a buffer",   titles[4'242], titleStore.decode( 4'242 ) );
+
+      std::string buffer;
+      titleStore.decode( 0, buffer );
+      const auto data = buffer.data();
+      for( std::size_t id = 0; id < titles.size(); ++id ) titleStore.decode( id, buffer );
+      affirm.is_true ( "String store - buffer reused",              buffer.data() == data );
+    }
+  }
+
+
+
+  StringStoreRegressionTest::StringStoreRegressionTest()
+  {
+    std::clog << std::boolalpha << std::showpoint << std::fixed << std::setprecision( 2 );
+
+
+    try
+    {
+      std::clog << "\nString Store Regression Test:\n";
+      tests();
+
+      std::clog << affirm << '\n';
+    }
+    catch( const std::exception & ex )
+    {
+      std::clog << "FAILURE:  Regression test for \"class StringStore\" failed with an unhandled exception. \n\n\n"
+                << ex.what() << std::endl;
+    }
+  }
+} // namespace
@@ -0,0 +1,94 @@
+#include <cstddef>       // size_t
+#include <exception>     // exception_ptr, current_exception()
+#include <functional>    // function
+#include <future>        // future
+#include <mutex>         // lock_guard, unique_lock
+#include <utility>       // move()
+
+#include "ThreadPool.hpp"
+
+
+
+ThreadPool & ThreadPool::shared()
+{
+  static ThreadPool thePool;
+  return thePool;
+}
+
+
+
+ThreadPool::~ThreadPool()
+{
+  {
+    std::lock_guard lock( _mutex );
+    _stopping = true;
+  }
+  _ready.notify_all();
+
+  for( auto & worker : _workers ) worker.join();
+}
+
+
+
+std::future<void> ThreadPool::submit( std::function<void()> task )
+{
+  std::lock_guard lock( _mutex );
+  _tasks.push_back( { std::move( task ), {} } );
+  auto done = _tasks.back().done.get_future();
+
+  // Every task waiting has an idle worker of its own to take it, so none waits behind another.  A worker started here counts as idle
+  // until it takes a task, as one woken does.
+  if( _tasks.size() > _idle )
+  {
+    try
+    {
+      _workers.emplace_back( &ThreadPool::work, this );
+    }
+    catch( ... )
+    {
+      _tasks.pop_back();                                                        // so it can't run after the caller has given up on it
+      throw;
+    }
+    ++_idle;
+  }
+  else _ready.notify_one();
+
+  return done;
+}
+
+
+
+std::size_t ThreadPool::threads() const
+{
+  std::lock_guard lock( _mutex );
+  return _workers.size();
+}
+
+
+
+void ThreadPool::work()
+{
+  std::unique_lock lock( _mutex );
+
+  for( ;; )
+  {
+    // Tasks still waiting when the pool stops are run before the workers leave
+    _ready.wait( lock, [this] { return _stopping || !_tasks.empty(); } );
+    if( _tasks.empty() ) return;
+
+    auto task = std::move( _tasks.front() );
+    _tasks.pop_front();
+    --_idle;
+
+    lock.unlock();
+    std::exception_ptr failure;
+    try          { task.run();                         }
+    catch( ... ) { failure = std::current_exception(); }
+    lock.lock();
+
+    // The task is reported done only once its worker is free again, so tasks submitted as soon as it's done find the worker idle
+    ++_idle;
+    if( failure ) task.done.set_exception( failure );
+    else          task.done.set_value();
+  }
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>    // size_t
+#include <deque>
+#include <functional> // function
+#include <future>     // future, promise
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+
+// Threads kept for running tasks, so code that runs work on other threads over and over, such as checking out batch after batch of
+// carts, starts its threads once rather than each time.
+//
+// A task submitted runs at once on a worker that's idle, and only if none is does the pool start another worker, which it then keeps.
+// So tasks submitted together always run at the same time, however many there are, and may safely wait on one another, as the stages
+// of a pipeline do.  The pool grows to the most tasks ever running at once and no further.
+class ThreadPool
+{
+  public:
+    // Constructors, assignments, destructor
+    ThreadPool() = default;
+
+    ThreadPool            ( const ThreadPool & ) = delete;
+    ThreadPool & operator=( const ThreadPool & ) = delete;
+   ~ThreadPool();                                                               // Waits for the tasks submitted to finish
+
+    static ThreadPool & shared();                                               // The pool used throughout the program
+
+    // Operations
+    std::future<void> submit( std::function<void()> task );                    // The future becomes ready once the task has run
+                                                                                // and its worker is free for another, and rethrows
+                                                                                // anything the task threw
+    // Queries
+    std::size_t threads() const;                                                // Returns the number of workers started so far
+
+  private:
+    struct Task
+    {
+      std::function<void()> run;
+      std::promise<void>    done;
+    };
+
+    void work();                                                                // A worker's loop
+
+    mutable std::mutex       _mutex;
+    std::condition_variable  _ready;                                            // signalled as tasks are submitted, or the pool is
+    std::deque<Task>         _tasks;                                            // stopping
+    std::size_t              _idle     = 0;                                     // workers free to take a task
+    bool                     _stopping = false;
+    std::vector<std::thread> _workers;
+};
@@ -0,0 +1,108 @@
+#include <atomic>
+#include <chrono>     // seconds, steady_clock
+#include <cstddef>    // size_t
+#include <exception>
+#include <future>     // future
+#include <iomanip>    // setprecision()
+#include <iostream>   // boolalpha(), showpoint(), fixed()
+#include <stdexcept>  // runtime_error
+#include <thread>     // yield()
+#include <vector>
+
+#include "CheckResults.hpp"
+#include "ParallelFor.hpp"
+#include "ThreadPool.hpp"
+
+
+
+
+
+namespace  // anonymous
+{
+  class ThreadPoolRegressionTest
+  {
+    public:
+      ThreadPoolRegressionTest();
+
+    private:
+      void tests();
+
+      Regression::CheckResults affirm;
+  } run_threadPool_tests;
+
+
+
+
+  void ThreadPoolRegressionTest::tests()
+  {
+    {
+      // Tasks submitted together run at the same time, so each sees the others arrive, however few workers the pool had
+      constexpr std::size_t TASKS = 6;
+
+      ThreadPool                     pool;
+      std::atomic<std::size_t>       arrived{ 0 };
+      std::atomic<std::size_t>       sawAll { 0 };
+      std::vector<std::future<void>> done;
+      for( std::size_t task = 0; task < TASKS; ++task ) done.push_back( pool.submit( [&]() noexcept
+      {
+        ++arrived;
+        const auto giveUp = std::chrono::steady_clock::now() + std::chrono::seconds( 10 );
+        while( arrived < TASKS && std::chrono::steady_clock::now() < giveUp ) std::this_thread::yield();
+        if( arrived == TASKS ) ++sawAll;
+      } ) );
+      for( auto & task : done ) task.get();
+
+      affirm.is_equal( "Thread pool - tasks submitted together run together",  TASKS, sawAll.load() );
+
+      // and once they're done, their workers take the next tasks rather than new ones being started
+      done.clear();
+      for( std::size_t task = 0; task < TASKS; ++task ) done.push_back( pool.submit( []() noexcept {} ) );
+      for( auto & task : done ) task.get();
+      affirm.is_equal( "Thread pool - workers kept",                           TASKS, pool.threads() );
+
+      bool rethrown = false;
+      try                                 { pool.submit( [] { throw std::runtime_error( "task" ); } ).get(); }
+      catch( const std::runtime_error & ) { rethrown = true;                                                  }
+      affirm.is_true ( "Thread pool - exceptions rethrown",                    rethrown );
+    }
+
+    {
+      // Tasks still waiting when the pool is destroyed are run first
+      std::atomic<std::size_t> ran{ 0 };
+      {
+        ThreadPool pool;
+        for( int task = 0; task < 3; ++task ) pool.submit( [&]() noexcept { ++ran; } );
+      }
+      affirm.is_equal( "Thread pool - tasks finished before destruction",      3ULL, ran.load() );
+    }
+
+    {
+      // Parallel loops run one after another share the same threads
+      parallelFor( 100, 4, []( std::size_t, std::size_t ) noexcept {} );
+      const auto threads = ThreadPool::shared().threads();
+      for( int loop = 0; loop < 10; ++loop ) parallelFor( 100, 4, []( std::size_t, std::size_t ) noexcept {} );
+      affirm.is_true ( "Thread pool - shared across parallel loops",           threads > 0 && ThreadPool::shared().threads() == threads );
+    }
+  }
+
+
+
+  ThreadPoolRegressionTest::ThreadPoolRegressionTest()
+  {
+    std::clog << std::boolalpha << std::showpoint << std::fixed << std::setprecision( 2 );
+
+
+    try
+    {
+      std::clog << "\nThread Pool Regression Test:\n";
+      tests();
+
+      std::clog << affirm << '\n';
+    }
+    catch( const std::exception & ex )
+    {
+      std::clog << "FAILURE:  Regression test for \"class ThreadPool\" failed with an unhandled exception. \n\n\n"
+                << ex.what() << std::endl;
+    }
+  }
+} // namespace
@@ -0,0 +1,314 @@
+#include <algorithm>     // find(), max(), min(), partial_sort(), sort()
+#include <cctype>        // isalnum(), tolower()
+#include <cstddef>       // size_t, ptrdiff_t
+#include <cstdint>       // uint8_t, uint32_t
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <utility>       // move(), pair
+#include <vector>
+
+#include "Book.hpp"
+#include "TitleIndex.hpp"
+
+
+
+// Walks one posting list in ascending id order
+class TitleIndex::Cursor
+{
+  public:
+    Cursor( const TitleIndex & index, const PostingList & list )
+      : _index( &index ), _list( &list ), _blocks( ( list.count + BLOCK_SIZE - 1 ) / BLOCK_SIZE )
+    {
+      enterBlock( 0 );
+    }
+
+    bool          atEnd() const { return _position == _list->count; }
+    Id            id   () const { return _id;                         }
+    std::uint32_t count() const { return _list->count;                }
+
+    // Advance to the next id
+    void next()
+    {
+      if( ++_position == _list->count ) return;
+
+      if( _position % BLOCK_SIZE == 0 ) enterBlock( _block + 1 );
+      else                              _id += decode();
+    }
+
+    // Advance to the first id not less than target.  Gallop ahead through the skip table, doubling the stride until a block that
+    // starts beyond the target is found, binary search back to the block that may hold the target, then decode within that block.
+    void seek( Id target )
+    {
+      if( atEnd() || _id >= target ) return;
+
+      std::size_t low = _block, high = _block + 1, stride = 1;
+      while( high < _blocks && firstId( high ) <= target )
+      {
+        low     = high;
+        stride *= 2;
+        high    = low + stride;
+      }
+      high = std::min( high, _blocks );
+
+      while( high - low > 1 )
+      {
+        auto middle = low + ( high - low ) / 2;
+        if( firstId( middle ) <= target ) low  = middle;
+        else                              high = middle;
+      }
+
+      if( low != _block ) enterBlock( low );
+      while( !atEnd() && _id < target ) next();
+    }
+
+  private:
+    Id firstId( std::size_t block ) const { return _index->_skips[_list->firstSkip + block].firstId; }
+
+    void enterBlock( std::size_t block )
+    {
+      const auto & skip = _index->_skips[_list->firstSkip + block];
+      _block    = block;
+      _position = block * BLOCK_SIZE;
+      _id       = skip.firstId;
+      _byte     = skip.byteOffset;
+    }
+
+    Id decode()
+    {
+      Id           delta = 0;
+      unsigned     shift = 0;
+      std::uint8_t byte  = 0;
+      do
+      {
+        byte   = _index->_postings[_byte++];
+        delta |= static_cast<Id>( byte & 0x7F ) << shift;
+        shift += 7;
+      } while( byte & 0x80 );
+
+      return delta;
+    }
+
+    const TitleIndex *  _index;
+    const PostingList * _list;
+    std::size_t         _blocks;
+    std::size_t         _block    = 0;
+    std::size_t         _position = 0;                        // of the current id within the whole list
+    std::size_t         _byte     = 0;                        // next byte of _postings to decode
+    Id                  _id       = 0;
+};
+
+
+
+// Constructors
+TitleIndex::TitleIndex( const std::vector<const Book *> & books, unsigned threads )
+{
+  using Postings = std::unordered_map<std::string, std::vector<Id>>;
+
+  // Tokenize in parallel.  Each thread takes a contiguous range of ids, so appending the threads' lists in thread order keeps every
+  // list in ascending order.  Small sets aren't worth splitting.
+  threads = static_cast<unsigned>( std::max<std::size_t>( 1, std::min<std::size_t>( threads, books.size() / 4096 ) ) );
+
+  std::vector<Postings> partial( threads );
+  auto tokenizeRange = [&]( unsigned thread )
+  {
+    const auto first = books.size() *   thread       / threads;
+    const auto last  = books.size() * ( thread + 1 ) / threads;
+
+    for( auto id = first; id < last; ++id )
+    {
+      if( books[id] == nullptr ) continue;
+      for( auto & token : tokenize( books[id]->title() ) ) partial[thread][std::move( token )].push_back( static_cast<Id>( id ) );
+    }
+  };
+
+  std::vector<std::thread> workers;
+  for( unsigned thread = 1; thread < threads; ++thread ) workers.emplace_back( tokenizeRange, thread );
+  tokenizeRange( 0 );
+  for( auto & worker : workers ) worker.join();
+
+  auto & merged = partial.front();
+  for( unsigned thread = 1; thread < threads; ++thread )
+  {
+    for( auto & [token, ids] : partial[thread] )
+    {
+      auto & list = merged[token];
+      list.insert( list.end(), ids.begin(), ids.end() );
+    }
+    Postings().swap( partial[thread] );                       // release memory as soon as possible
+  }
+
+
+  // Compress
+  _dictionary.reserve( merged.size() );
+  for( auto & [token, ids] : merged )
+  {
+    _dictionary.emplace( token, PostingList{ static_cast<std::uint32_t>( _skips.size() ), static_cast<std::uint32_t>( ids.size() ) } );
+
+    for( std::size_t i = 0; i < ids.size(); ++i )
+    {
+      if( i % BLOCK_SIZE == 0 )
+      {
+        _skips.push_back( { ids[i], static_cast<std::uint32_t>( _postings.size() ) } );
+        continue;
+      }
+
+      for( auto delta = ids[i] - ids[i - 1]; ; delta >>= 7 )
+      {
+        if( delta < 0x80 )
+        {
+          _postings.push_back( static_cast<std::uint8_t>( delta ) );
+          break;
+        }
+        _postings.push_back( static_cast<std::uint8_t>( ( delta & 0x7F ) | 0x80 ) );
+      }
+    }
+  }
+
+  _skips   .shrink_to_fit();
+  _postings.shrink_to_fit();
+}
+
+
+
+// Queries
+std::vector<std::string> TitleIndex::tokenize( std::string_view text )
+{
+  std::vector<std::string> tokens;
+  std::string              token;
+
+  auto endToken = [&]
+  {
+    if( !token.empty() && std::find( tokens.begin(), tokens.end(), token ) == tokens.end() ) tokens.push_back( token );
+    token.clear();
+  };
+
+  // Letters and digits make up tokens, everything else separates them.  Bytes outside ASCII are kept as is, so words in other
+  // alphabets stay whole.
+  for( unsigned char c : text )
+  {
+    if     ( c >= 0x80          ) token += static_cast<char>( c );
+    else if( std::isalnum( c )  ) token += static_cast<char>( std::tolower( c ) );
+    else                          endToken();
+  }
+  endToken();
+
+  return tokens;
+}
+
+
+
+std::vector<TitleIndex::Hit> TitleIndex::search( std::string_view query, Match match, std::size_t limit ) const
+{
+  std::vector<Cursor> cursors;
+  for( const auto & term : tokenize( query ) )
+  {
+    if( auto it = _dictionary.find( term ); it != _dictionary.end() ) cursors.emplace_back( *this, it->second );
+    else if( match == Match::ALL_TERMS )                              return {};        // nothing contains this term
+  }
+
+  if( cursors.empty() || limit == 0 ) return {};
+
+  return match == Match::ALL_TERMS ? intersect( cursors, limit ) : unite( cursors, limit );
+}
+
+
+
+std::vector<TitleIndex::Hit> TitleIndex::intersect( std::vector<Cursor> & cursors, std::size_t limit ) const
+{
+  // Lead with the shortest list, so the fewest candidates are proposed and the longer lists are mostly skipped over
+  std::sort( cursors.begin(), cursors.end(), []( const Cursor & lhs, const Cursor & rhs ) { return lhs.count() < rhs.count(); } );
+
+  std::vector<Hit> hits;
+  auto &           lead  = cursors.front();
+  const auto       score = static_cast<std::uint32_t>( cursors.size() );
+
+  while( !lead.atEnd() && hits.size() < limit )
+  {
+    const Id candidate = lead.id();
+    bool     matched   = true;
+
+    for( std::size_t i = 1; i < cursors.size(); ++i )
+    {
+      cursors[i].seek( candidate );
+      if( cursors[i].atEnd() ) return hits;
+
+      if( cursors[i].id() != candidate )
+      {
+        lead.seek( cursors[i].id() );                         // no id before this one can be in every list
+        matched = false;
+        break;
+      }
+    }
+
+    if( matched )
+    {
+      hits.push_back( { candidate, score } );
+      lead.next();
+    }
+  }
+
+  return hits;
+}
+
+
+
+std::vector<TitleIndex::Hit> TitleIndex::unite( std::vector<Cursor> & cursors, std::size_t limit ) const
+{
+  std::vector<Hit> hits;
+
+  for( ;; )
+  {
+    bool any      = false;
+    Id   smallest = 0;
+    for( const auto & cursor : cursors )
+    {
+      if( cursor.atEnd() || ( any && cursor.id() >= smallest ) ) continue;
+      smallest = cursor.id();
+      any      = true;
+    }
+    if( !any ) break;
+
+    std::uint32_t score = 0;
+    for( auto & cursor : cursors )
+    {
+      if( cursor.atEnd() || cursor.id() != smallest ) continue;
+      ++score;
+      cursor.next();
+    }
+
+    hits.push_back( { smallest, score } );
+  }
+
+  // Best matches first, ties in ascending id order.  Only the first limit need be put in order.
+  limit = std::min( limit, hits.size() );
+  std::partial_sort( hits.begin(), hits.begin() + static_cast<std::ptrdiff_t>( limit ), hits.end(),
+                     []( const Hit & lhs, const Hit & rhs ) { return lhs.score != rhs.score ? lhs.score > rhs.score : lhs.id < rhs.id; } );
+  hits.resize( limit );
+
+  return hits;
+}
+
+
+
+TitleIndex::Footprint TitleIndex::footprint() const
+{
+  Footprint footprint;
+  footprint.tokens       = _dictionary.size();
+  footprint.skipTables   = _skips   .capacity() * sizeof( Skip );
+  footprint.postingLists = _postings.capacity() * sizeof( std::uint8_t );
+
+  // Each hash table entry is a node holding the token and its list's location, plus a link to the next node in the bucket.  Tokens
+  // too long to be held within the string object itself take a separate allocation.
+  footprint.dictionary = _dictionary.bucket_count() * sizeof( void * );
+  for( const auto & [token, list] : _dictionary )
+  {
+    footprint.postings   += list.count;
+    footprint.dictionary += sizeof( std::pair<const std::string, PostingList> ) + sizeof( void * );
+    const auto * object = reinterpret_cast<const char *>( &token );
+    if( token.data() < object || token.data() >= object + sizeof( token ) ) footprint.dictionary += token.capacity() + 1;
+  }
+
+  return footprint;
+}
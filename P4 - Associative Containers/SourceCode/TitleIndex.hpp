@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstddef>    // size_t
+#include <cstdint>    // uint8_t, uint32_t
+#include <string>
+#include <string_view>
+#include <thread>     // hardware_concurrency()
+#include <unordered_map>
+#include <vector>
+
+#include "Book.hpp"
+
+
+
+// An inverted index over book titles for keyword search.  Titles are split into tokens of letters and digits, folded to lower case,
+// and each token maps to the ascending ids of the books whose titles contain it.  Ids are the same dense ids SecondaryIndexes uses.
+//
+// Posting lists are compressed:  ids are grouped in blocks of BLOCK_SIZE, each block's first id is kept in a skip table and the rest
+// are stored as variable length (7 bits per byte) differences from the id before.  Intersections gallop through the skip tables, so
+// intersecting a short list with a long one decodes only the few blocks of the long list that could hold a match.
+class TitleIndex
+{
+  public:
+    using Id = std::uint32_t;
+
+    enum class Match { ALL_TERMS, ANY_TERM };
+
+    struct Hit
+    {
+      Id            id;
+      std::uint32_t score;                                                      // number of distinct query terms the title contains
+    };
+
+    struct Footprint                                                            // approximate memory used, in bytes
+    {
+      std::size_t tokens       = 0;                                             // distinct tokens indexed
+      std::size_t postings     = 0;                                             // (token, book) pairs indexed
+      std::size_t dictionary   = 0;                                             // token hash table
+      std::size_t skipTables   = 0;
+      std::size_t postingLists = 0;                                             // compressed ids
+
+      std::size_t total() const { return dictionary + skipTables + postingLists; }
+    };
+
+    static constexpr std::size_t BLOCK_SIZE = 64;
+
+    // Constructors
+    TitleIndex( const std::vector<const Book *> & books,                        // books[id] is the book with that id, nullptr if none
+                unsigned                          threads = std::thread::hardware_concurrency() );
+
+    // Queries
+    //
+    // ALL_TERMS returns books whose titles contain every term, in ascending id order.  ANY_TERM returns books whose titles contain
+    // at least one term, those matching the most terms first and ascending id order among equals.  At most limit hits are returned.
+    std::vector<Hit> search( std::string_view query, Match match, std::size_t limit ) const;
+    Footprint        footprint()                                                 const;
+
+    static std::vector<std::string> tokenize( std::string_view text );         // distinct normalized tokens, in order of appearance
+
+  private:
+    struct Skip                                                                 // one block of a posting list
+    {
+      Id            firstId;
+      std::uint32_t byteOffset;                                                 // where the block's remaining ids begin in _postings
+    };
+
+    struct PostingList
+    {
+      std::uint32_t firstSkip;                                                  // where the list's blocks begin in _skips
+      std::uint32_t count;                                                      // number of ids
+    };
+
+    class Cursor;
+
+    std::vector<Hit> intersect( std::vector<Cursor> & cursors, std::size_t limit ) const;
+    std::vector<Hit> unite    ( std::vector<Cursor> & cursors, std::size_t limit ) const;
+
+    std::unordered_map<std::string, PostingList> _dictionary;
+    std::vector<Skip>                            _skips;
+    std::vector<std::uint8_t>                    _postings;
+};
@@ -0,0 +1,111 @@
+#include <cstddef>    // size_t
+#include <exception>
+#include <iomanip>    // setprecision()
+#include <iostream>   // boolalpha(), showpoint(), fixed()
+#include <string>
+#include <vector>
+
+#include "Book.hpp"
+#include "CheckResults.hpp"
+#include "TitleIndex.hpp"
+
+
+
+
+
+namespace  // anonymous
+{
+  class TitleIndexRegressionTest
+  {
+    public:
+      TitleIndexRegressionTest();
+
+    private:
+      void tests();
+
+      Regression::CheckResults affirm;
+  } run_titleIndex_tests;
+
+
+
+
+  void TitleIndexRegressionTest::tests()
+  {
+    using Ids = std::vector<TitleIndex::Id>;
+
+    const auto ids = []( const std::vector<TitleIndex::Hit> & hits )
+    {
+      Ids result;
+      for( const auto & hit : hits ) result.push_back( hit.id );
+      return result;
+    };
+
+    {
+      const Book fuzzyLogic     ( "Fuzzy logic"                  );
+      const Book crossroadsLogic( "Crossroads logic"             );
+      const Book fuzzySets      ( "Fuzzy Sets and FUZZY systems" );
+      const Book logic          ( "Logic, logic, logic!"         );
+
+      //                                         id:    0             1                 2         3           4
+      const TitleIndex index( std::vector<const Book *>{ &fuzzyLogic, &crossroadsLogic, nullptr, &fuzzySets, &logic } );
+
+      affirm.is_true( "Title index - tokens normalized and distinct",  TitleIndex::tokenize( "Logic, LOGIC and logic-gates" ) == std::vector<std::string>{ "logic", "and", "gates" } );
+      affirm.is_true( "Title index - all terms",                       ids( index.search( "fuzzy LOGIC", TitleIndex::Match::ALL_TERMS, 10 ) ) == Ids{ 0 } );
+      affirm.is_true( "Title index - any term, best matches first",   ids( index.search( "fuzzy logic", TitleIndex::Match::ANY_TERM,  10 ) ) == Ids{ 0, 1, 3, 4 } );
+      affirm.is_true( "Title index - any term, limited",              ids( index.search( "fuzzy logic", TitleIndex::Match::ANY_TERM,   2 ) ) == Ids{ 0, 1 } );
+      affirm.is_true( "Title index - unknown term matches nothing",    index.search( "fuzzy zebra", TitleIndex::Match::ALL_TERMS, 10 ).empty() );
+      affirm.is_true( "Title index - unknown term ignored by any",     ids( index.search( "zebra crossroads", TitleIndex::Match::ANY_TERM, 10 ) ) == Ids{ 1 } );
+      affirm.is_true( "Title index - footprint reported",              index.footprint().tokens == 6 && index.footprint().postings == 9 && index.footprint().total() > 0 );
+    }
+
+    {
+      // Enough books for long, multi-block posting lists, built by several threads, compared against the obvious answers
+      constexpr std::size_t BOOK_COUNT = 20'000;
+
+      std::vector<Book>         books;
+      std::vector<const Book *> pointers;
+      books.reserve( BOOK_COUNT );
+      for( std::size_t id = 0; id < BOOK_COUNT; ++id )
+      {
+        books.emplace_back( std::string( "common" ) + ( id % 3 == 0 ? " three" : "" ) + ( id % 7 == 0 ? " seven" : "" ) + ( id == 12'345 ? " rare" : "" ) );
+        pointers.push_back( &books.back() );
+      }
+
+      const TitleIndex singleThreaded( pointers, 1 );
+      const TitleIndex multiThreaded ( pointers, 4 );
+
+      Ids expected;
+      for( TitleIndex::Id id = 0; id < BOOK_COUNT; id += 21 ) expected.push_back( id );
+
+      for( const auto * index : { &singleThreaded, &multiThreaded } )
+      {
+        affirm.is_true( "Title index - intersection across blocks",       ids( index->search( "three seven",  TitleIndex::Match::ALL_TERMS, BOOK_COUNT ) ) == expected );
+        affirm.is_true( "Title index - galloping to a rare term",          ids( index->search( "common rare",  TitleIndex::Match::ALL_TERMS, BOOK_COUNT ) ) == Ids{ 12'345 } );
+        affirm.is_true( "Title index - top N of a union",                  ids( index->search( "three seven",  TitleIndex::Match::ANY_TERM,  3          ) ) == Ids{ 0, 21, 42 } );
+        affirm.is_equal( "Title index - union size",                       std::size_t{ BOOK_COUNT / 3 + 1 + BOOK_COUNT / 7 + 1 - ( BOOK_COUNT / 21 + 1 ) },
+                                                                           index->search( "three seven", TitleIndex::Match::ANY_TERM, BOOK_COUNT ).size() );
+      }
+    }
+  }
+
+
+
+  TitleIndexRegressionTest::TitleIndexRegressionTest()
+  {
+    std::clog << std::boolalpha << std::showpoint << std::fixed << std::setprecision( 2 );
+
+
+    try
+    {
+      std::clog << "\nTitle Index Regression Test:\n";
+      tests();
+
+      std::clog << affirm << '\n';
+    }
+    catch( const std::exception & ex )
+    {
+      std::clog << "FAILURE:  Regression test for \"class TitleIndex\" failed with an unhandled exception. \n\n\n"
+                << ex.what() << std::endl;
+    }
+  }
+} // namespace
@@ -0,0 +1,94 @@
+#include <cstddef>          // size_t
+#include <fstream>          // ifstream
+#include <iostream>         // standard i/o streams cout, clog
+#include <map>              // Binary search tree associative container with no duplicates
+#include <string>           // Unbounded strings
+
+#include "../Book.hpp"
+#include "../BookChange.hpp"
+
+
+
+
+
+
+
+/*********************************************************************************************************************************
+**  Private type declarations, function declarations, and object definitions
+*********************************************************************************************************************************/
+namespace    // unnamed, anonymous namespace
+{
+  using Catalog = std::map<std::string /*ISBN*/, Book>;
+
+  // Read every book in a database file, the same way BookDatabase does
+  Catalog load( const std::string & filename )
+  {
+    std::ifstream fin( filename, std::ios::binary );
+    if( !fin ) std::clog << "Warning:  unable to open \"" << filename << "\", treating it as empty\n";
+
+    Catalog catalog;
+    Book    book;
+    while( fin >> book ) catalog[book.isbn()] = book;
+
+    return catalog;
+  }
+}    // unnamed, anonymous namespace
+
+
+
+
+
+
+
+/*********************************************************************************************************************************
+**  Main
+**
+**  Writes to standard output the delta that, applied with BookDatabase::applyDelta() to a database loaded from the old file, gives
+**  the same books as loading the new file.  Both catalogs are walked once in ISBN order, so the delta is also in ISBN order.
+**
+**  Usage:  catalogdiff <old .dat file> <new .dat file> > <delta file>
+*********************************************************************************************************************************/
+int main( int argc, char * argv[] )
+{
+  if( argc != 3 )
+  {
+    std::clog << "Usage:  " << ( argc > 0 ? argv[0] : "catalogdiff" ) << " <old .dat file> <new .dat file> > <delta file>\n";
+    return 1;
+  }
+
+  const Catalog oldCatalog = load( argv[1] );
+  const Catalog newCatalog = load( argv[2] );
+
+  std::size_t added = 0, updated = 0, removed = 0;
+
+  auto oldIt = oldCatalog.cbegin();
+  auto newIt = newCatalog.cbegin();
+  while( oldIt != oldCatalog.cend() || newIt != newCatalog.cend() )
+  {
+    if( newIt == newCatalog.cend() || ( oldIt != oldCatalog.cend() && oldIt->first < newIt->first ) )
+    {
+      std::cout << BookChange{ BookChange::Operation::REMOVE, oldIt->second } << '\n';
+      ++removed;
+      ++oldIt;
+    }
+    else if( oldIt == oldCatalog.cend() || newIt->first < oldIt->first )
+    {
+      std::cout << BookChange{ BookChange::Operation::ADD, newIt->second } << '\n';
+      ++added;
+      ++newIt;
+    }
+    else
+    {
+      if( oldIt->second != newIt->second )
+      {
+        std::cout << BookChange{ BookChange::Operation::UPDATE, newIt->second } << '\n';
+        ++updated;
+      }
+      ++oldIt;
+      ++newIt;
+    }
+  }
+
+  std::clog << oldCatalog.size() << " books before, " << newCatalog.size() << " books after:  "
+            << added << " added, " << updated << " updated, " << removed << " removed\n";
+}
@@ -0,0 +1,104 @@
+#include <chrono>           // duration
+#include <cstddef>          // size_t
+#include <exception>
+#include <iostream>         // standard i/o streams cout, clog
+#include <streambuf>        // streambuf
+#include <string>           // Unbounded strings, stoul()
+
+#include "../Bookstore.hpp"
+#include "../CheckoutCapture.hpp"
+
+
+
+
+
+
+
+/*********************************************************************************************************************************
+**  Private type declarations, function declarations, and object definitions
+*********************************************************************************************************************************/
+namespace    // unnamed, anonymous namespace
+{
+  // Receipts are written to std::cout, and a long capture has far too many to keep, so they're written here instead
+  class NullBuffer : public std::streambuf
+  {
+    protected:
+      int_type        overflow( int_type ch )                         override { return ch;    }
+      std::streamsize xsputn  ( const char *, std::streamsize count ) override { return count; }
+  };
+
+  // Points std::cout at another buffer until destroyed, so it's put back however the scope is left, even by an exception
+  class Redirect
+  {
+    public:
+      explicit Redirect( std::streambuf * buffer ) : _original( std::cout.rdbuf( buffer ) ) {}
+     ~Redirect()                                     { std::cout.rdbuf( _original ); }
+
+      Redirect            ( const Redirect & ) = delete;
+      Redirect & operator=( const Redirect & ) = delete;
+
+    private:
+      std::streambuf * _original;
+  };
+}    // unnamed, anonymous namespace
+
+
+
+
+
+
+
+/*********************************************************************************************************************************
+**  Main
+**
+**  Replays a checkout capture (see CheckoutCapture.hpp), recorded with Bookstore::recordCheckouts(), against a store opened from the
+**  inventory file, whose inventory the capture replaces.  Each batch is checked out as soon as the last is done, or with --recorded,
+**  no sooner after the start than it was recorded.  Receipts are discarded.  Writes to standard output how many batches and carts
+**  were checked out, how long checking them out took, and how many batches sold other books or left another inventory than recorded.
+**  Exits with 0 only if none did.
+**
+**  Usage:  checkoutreplay <capture file> [--recorded] [checkout threads]
+*********************************************************************************************************************************/
+int main( int argc, char * argv[] )
+{
+  if( argc < 2 || argc > 4 )
+  {
+    std::clog << "Usage:  " << ( argc > 0 ? argv[0] : "checkoutreplay" ) << " <capture file> [--recorded] [checkout threads]\n";
+    return 2;
+  }
+
+  try
+  {
+    auto        speed   = CheckoutReplayer::Speed::MAXIMUM;
+    std::size_t threads = 1;
+    for( int arg = 2; arg < argc; ++arg )
+    {
+      if( std::string( argv[arg] ) == "--recorded" ) speed   = CheckoutReplayer::Speed::RECORDED;
+      else                                           threads = std::stoul( argv[arg] );
+    }
+
+    CheckoutReplayer replayer( argv[1] );
+    Bookstore        store;
+    store.checkoutThreads( threads );
+
+    CheckoutReplayer::Results results;
+    {
+      NullBuffer receipts;
+      Redirect   toReceipts( &receipts );
+      results = replayer.replay( store, speed );
+    }
+
+    const std::chrono::duration<double> seconds = results.checkoutTime;
+    std::cout << results.batches << " batches, " << results.carts << " carts checked out in " << seconds.count() << " seconds, "
+              << results.mismatches << " mismatched";
+    if( results.mismatches > 0 ) std::cout << " (first in batch " << results.firstMismatch << ')';
+    std::cout << '\n';
+
+    return results.mismatches == 0 ? 0 : 1;
+  }
+  catch( const std::exception & ex )
+  {
+    std::clog << ex.what() << '\n';
+    return 2;
+  }
+}
@@ -2,6 +2,7 @@
 #include <iomanip>      // setprecision()
 #include <iostream>     // cout, fixed(), showpoint()
 
+#include "BookDatabase.hpp"
 #include "Bookstore.hpp"
 
 
@@ -16,6 +17,10 @@ int main()
   {
     std::cout << std::fixed << std::setprecision( 2 ) << std::showpoint;
 
+    // Loading the database of all books in the world takes a while, and it isn't needed until the first customer checks out.  Load
+    // it in the background while the store opens and the shoppers fill their carts.
+    auto databaseLoaded = BookDatabase::loadInBackground();
+
 
     ///////////////////////// TO-DO (1) //////////////////////////////
       /// Create your bookstore
@@ -31,6 +36,8 @@ int main()
     Bookstore::ShoppingCarts carts = bookstore.makeShoppingCarts();
     /////////////////////// END-TO-DO (2) ////////////////////////////
 
+    databaseLoaded.get();                                         // rethrows if the database couldn't be loaded
+
 
     ///////////////////////// TO-DO (3) //////////////////////////////
       /// There are several shoppers standing in line waiting to pay for the books in their shopping cart.  Process them all by